@@ -0,0 +1,4 @@
+// Adafruit_I2CDevice.h（主机模拟）：Adafruit_GFX.h会包含它，模拟环境不编译用到它的Adafruit_SPITFT，留空即可
+#ifndef SIM_ADAFRUIT_I2CDEVICE_H
+#define SIM_ADAFRUIT_I2CDEVICE_H
+#endif
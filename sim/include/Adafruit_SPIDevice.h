@@ -0,0 +1,4 @@
+// Adafruit_SPIDevice.h（主机模拟）：见Adafruit_I2CDevice.h
+#ifndef SIM_ADAFRUIT_SPIDEVICE_H
+#define SIM_ADAFRUIT_SPIDEVICE_H
+#endif
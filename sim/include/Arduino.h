@@ -0,0 +1,103 @@
+// Arduino.h（主机模拟）
+// native环境下代替Arduino-ESP32核心：时间、GPIO、中断和串口都接到模拟器（sim/src），
+// 时间为模拟时间：主机CPU耗时乘以EPD_SIM_CPU_SCALE，再加上SPI传输、delay()等I/O耗时
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define INPUT_PULLUP  0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+// ESP32 DevKit默认SPI引脚
+static const uint8_t SS   = 5;
+static const uint8_t MOSI = 23;
+static const uint8_t MISO = 19;
+static const uint8_t SCK  = 18;
+#define NOT_A_PIN -1
+#define digitalPinToInterrupt(p) (p)
+
+#define IRAM_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_pointer(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*)(s))
+
+// 固件入口，由模拟器的main()调用（sim/src/sim_main.cpp）
+void setup(void);
+void loop(void);
+
+unsigned long micros();
+unsigned long millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+// esp32-hal-matrix.h：GPIO矩阵不建模（片选电平由SPI模拟按设备的CS引脚处理）
+inline void pinMatrixOutAttach(uint8_t pin, uint8_t function, bool invertOut, bool invertEnable)
+{
+  (void)pin; (void)function; (void)invertOut; (void)invertEnable;
+}
+
+// Esp.h中的EspClass只提供用到的部分：CPU周期计数器按模拟时间与240MHz换算
+class EspClass
+{
+  public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+extern EspClass ESP;
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+using std::min;
+using std::max;
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
+
+#endif
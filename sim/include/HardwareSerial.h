@@ -0,0 +1,26 @@
+// HardwareSerial.h（主机模拟）：Serial输出到标准输出，输入来自EPD_SIM_SERIAL指定的文件/设备（默认无输入）
+#ifndef SIM_HARDWARESERIAL_H
+#define SIM_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    size_t setRxBufferSize(size_t size) { return size; }
+    int available();
+    int read();
+    int peek();
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    void flush();
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,41 @@
+// Preferences.h（主机模拟）：NVS键值存储，每个命名空间存为输出目录中的一个文件（nvs_<命名空间>.bin），
+// 模拟重新上电（再次运行模拟器而不删除输出目录）时内容仍在
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences
+{
+  public:
+    Preferences() : _open(false), _read_only(false) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* partition_label = 0);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value) { return putBytes(key, &value, sizeof(value)) ? 1 : 0; }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)) ? 4 : 0; }
+    size_t putBytes(const char* key, const void* value, size_t len);
+    bool getBool(const char* key, bool defaultValue = false) { bool v = defaultValue; return _get(key, &v, sizeof(v)) ? v : defaultValue; }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { uint32_t v = 0; return _get(key, &v, sizeof(v)) ? v : defaultValue; }
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+  private:
+    bool _get(const char* key, void* buf, size_t len);
+    bool _flush();
+
+    bool _open, _read_only;
+    std::string _path;
+    std::map<std::string, std::vector<uint8_t> > _items;
+};
+
+#endif
@@ -0,0 +1,48 @@
+// SPI.h（主机模拟）：SPIClass的字节送入面板模型（DC/CS取自模拟GPIO），按SPISettings的时钟计时
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+#define FSPI 1
+#define HSPI 2
+#define VSPI 3
+
+class SPISettings
+{
+  public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) :
+      _clock(clock), _bitOrder(bitOrder), _dataMode(dataMode) {}
+    uint32_t _clock;
+    uint8_t _bitOrder;
+    uint8_t _dataMode;
+};
+
+class SPIClass
+{
+  public:
+    SPIClass(uint8_t spi_bus = HSPI) : _bus(spi_bus), _clock(1000000), _begun(false) {}
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) { (void)sck; (void)miso; (void)mosi; (void)ss; _begun = true; }
+    void end() { _begun = false; }
+    void beginTransaction(SPISettings settings) { _clock = settings._clock; }
+    void endTransaction() {}
+    void setFrequency(uint32_t freq) { _clock = freq; }
+    uint8_t transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data);
+    void transfer(void* data, uint32_t size);
+    void writeBytes(const uint8_t* data, uint32_t size);
+    void write(uint8_t data) { transfer(data); }
+
+  private:
+    uint8_t _bus;
+    uint32_t _clock;
+    bool _begun;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,15 @@
+// Stream.h（主机模拟）：与Arduino的Stream接口一致（只保留用到的部分）
+#ifndef SIM_STREAM_H
+#define SIM_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+#endif
@@ -0,0 +1,24 @@
+// WString.h（主机模拟）：Adafruit_GFX的接口里用到String，这里只提供最小实现
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+#include <string>
+
+class String
+{
+  public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(int v) : _s(std::to_string(v)) {}
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    char operator[](unsigned int i) const { return _s[i]; }
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    String& operator+=(const char* o) { _s += o; return *this; }
+    bool operator==(const char* o) const { return _s == o; }
+
+  private:
+    std::string _s;
+};
+
+#endif
@@ -0,0 +1,13 @@
+// esp_attr.h（主机模拟）
+#ifndef SIM_ESP_ATTR_H
+#define SIM_ESP_ATTR_H
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+// RTC内存放在单独的段里：模拟深睡眠时保存，定时唤醒重新启动进程后恢复（见EPD_SIM_WAKEUPS）
+#define RTC_DATA_ATTR __attribute__((section("rtc_slow"), used))
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_slow"), used))
+#define DRAM_ATTR
+
+#endif
@@ -0,0 +1,31 @@
+// FreeRTOS.h（主机模拟）：任务、队列、信号量用std::thread实现（见sim/src/freertos_sim.cpp），1个tick为1ms
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configTICK_RATE_HZ 1000
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+// 临界区：全局递归锁
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+void simEnterCritical();
+void simExitCritical();
+#define portENTER_CRITICAL(mux) simEnterCritical()
+#define portEXIT_CRITICAL(mux) simExitCritical()
+#define portENTER_CRITICAL_ISR(mux) simEnterCritical()
+#define portEXIT_CRITICAL_ISR(mux) simExitCritical()
+
+#endif
@@ -0,0 +1,2 @@
+// pgmspace.h（主机模拟）：程序存储器就是普通内存，宏定义见Arduino.h
+#include <Arduino.h>
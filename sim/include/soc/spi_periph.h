@@ -0,0 +1,15 @@
+// soc/spi_periph.h（主机模拟）：只提供片选输出信号号，GPIO矩阵不建模
+#ifndef SIM_SOC_SPI_PERIPH_H
+#define SIM_SOC_SPI_PERIPH_H
+
+#include <stdint.h>
+
+typedef struct
+{
+  uint8_t spics_out[3];
+} spi_signal_conn_t;
+
+// 与ESP32的gpio_sig_map.h一致：SPI1、HSPI、VSPI的CS0输出信号
+static const spi_signal_conn_t spi_periph_signal[3] = { { { 5, 0, 0 } }, { { 15, 61, 62 } }, { { 68, 69, 70 } } };
+
+#endif
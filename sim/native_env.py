@@ -0,0 +1,45 @@
+# native_env.py
+# native环境的构建脚本：把src/原样与sim/中的模拟层（Arduino/SPI/FreeRTOS/IDF头文件与实现、SSD1608模型）
+# 以及真实的GxEPD2、Adafruit GFX、U8g2_for_Adafruit_GFX源码一起编译成主机程序
+#
+# 这几个库由platformio.ini的lib_deps安装并按正常的依赖查找编译（lib_compat_mode = off让声明了
+# Arduino平台的库也能用于native），模拟层的头文件目录加在全局，库源码编译时同样能找到<Arduino.h>等。
+# 模拟层只提供面板驱动用到的底层接口，库中其余源文件用构建中间件跳过：
+# GxEPD2只编译GxEPD2_EPD.cpp与epd/GxEPD2_290.cpp，Adafruit GFX只编译Adafruit_GFX.cpp
+# （Adafruit_SPITFT、Adafruit_GrayOLED需要真实的SPI/I2C驱动）
+#
+# pio test -e native：用例（test/test_*/）提供setup()/loop()，由模拟器的main()调用，
+# 这时src/main.cpp不参与编译，sim/src加入头文件搜索路径，用例可以直接检查面板模型（ssd1608_model.h）
+import os
+
+Import('env')   # noqa: F821  PlatformIO/SCons环境
+
+project_dir = env.subst('$PROJECT_DIR')
+sim_dir = os.path.join(project_dir, 'sim')
+
+LIBRARY_SOURCES = [
+    # (库目录名, 需要编译的源文件（相对库目录）)
+    ('GxEPD2', ('src/GxEPD2_EPD.cpp', 'src/epd/GxEPD2_290.cpp')),
+    ('Adafruit GFX Library', ('Adafruit_GFX.cpp',)),
+]
+
+
+def skip_unsupported(env, node):
+    path = node.srcnode().get_abspath().replace(os.sep, '/')
+    for name, keep in LIBRARY_SOURCES:
+        marker = '/' + name + '/'
+        if marker in path:
+            return node if path.split(marker, 1)[1] in keep else None
+    return node
+
+
+env.Prepend(CPPPATH=[os.path.join(sim_dir, 'include')])
+env.Append(CXXFLAGS=['-std=gnu++17'], CPPDEFINES=['ESP32', ('ARDUINO', 10819)], LIBS=['pthread'])
+env.AddBuildMiddleware(skip_unsupported)
+
+if 'test' in env.GetBuildType():
+    main_cpp = os.path.join(env.subst('$PROJECT_SRC_DIR'), 'main.cpp')
+    env.AddBuildMiddleware(lambda env, node: None if node.srcnode().get_abspath() == main_cpp else node)
+    env.Append(CPPPATH=[os.path.join(sim_dir, 'src')])
+
+env.BuildSources(os.path.join('$BUILD_DIR', 'sim'), os.path.join(sim_dir, 'src'))
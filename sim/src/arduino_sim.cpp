@@ -0,0 +1,462 @@
+// arduino_sim.cpp
+// Arduino核心的主机模拟：模拟时钟、定时事件、GPIO/中断、串口
+#include <Arduino.h>
+#include "sim.h"
+#include "ssd1608_model.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+// ---------------- 模拟时钟 ----------------
+
+static std::recursive_mutex simMutex;
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> ioNs(0);      // 模拟器推进的I/O时间
+static std::atomic<uint64_t> pausedNs(0);  // 模拟器自身开销（不计入CPU时间）
+static std::atomic<uint64_t> lastNs(0);    // 保证多线程下时钟单调
+static thread_local int pauseDepth = 0;
+static thread_local uint64_t pauseStart = 0;
+
+static uint64_t hostNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+static double cpuScale()
+{
+  static const double scale = simEnvDouble("EPD_SIM_CPU_SCALE", 1.0);
+  return scale;
+}
+
+// 未经单调修正的时钟：暂停计时（pausedNs增加）后可能落后于已经返回过的时刻
+static uint64_t simRawNs()
+{
+  uint64_t host = hostNs();
+  uint64_t paused = pausedNs.load();
+  return uint64_t((host > paused ? host - paused : 0) * cpuScale()) + ioNs.load();
+}
+
+static uint64_t simNowNs()
+{
+  uint64_t t = simRawNs();
+  uint64_t last = lastNs.load();
+  while ((t > last) && !lastNs.compare_exchange_weak(last, t)) {}
+  return t > last ? t : last;
+}
+
+uint64_t simNow()
+{
+  return simNowNs() / 1000;
+}
+
+void simAdvanceNs(uint64_t ns)
+{
+  ioNs += ns;
+}
+
+void simAdvance(uint64_t us)
+{
+  ioNs += us * 1000;
+}
+
+void simAdvanceTo(uint64_t t)
+{
+  // 按原始时钟补差：按单调修正后的时刻补差时，原始时钟落后多少就少推进多少，可能永远到不了t
+  uint64_t raw = simRawNs();
+  if (t * 1000 > raw) ioNs += t * 1000 - raw;
+}
+
+SimPause::SimPause()
+{
+  if (!pauseDepth++) pauseStart = hostNs();
+}
+
+SimPause::~SimPause()
+{
+  if (!--pauseDepth) pausedNs += hostNs() - pauseStart;
+}
+
+void simLock()
+{
+  simMutex.lock();
+}
+
+void simUnlock()
+{
+  simMutex.unlock();
+}
+
+// ---------------- 定时事件 ----------------
+
+struct SimEvent
+{
+  SimEventFn fn;
+  void* arg;
+  uint32_t tag;
+};
+static std::multimap<uint64_t, SimEvent> events;
+
+void simSchedule(uint64_t at, SimEventFn fn, void* arg, uint32_t tag)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  SimEvent e = { fn, arg, tag };
+  events.insert(std::make_pair(at, e));
+}
+
+void simRunDue()
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  uint64_t now = simNow();
+  while (!events.empty() && (events.begin()->first <= now))
+  {
+    SimEvent e = events.begin()->second;
+    events.erase(events.begin());
+    e.fn(e.arg, e.tag);
+  }
+}
+
+uint64_t simNextEvent()
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  return events.empty() ? UINT64_MAX : events.begin()->first;
+}
+
+bool simIdleUntil(uint64_t limit)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  uint64_t next = simNextEvent();
+  uint64_t target = next < limit ? next : limit;
+  bool advanced = (target != UINT64_MAX) && (target > simNow());
+  if (advanced) simAdvanceTo(target);
+  simRunDue();
+  return advanced;
+}
+
+// ---------------- 环境变量与输出目录 ----------------
+
+const char* simEnvString(const char* name, const char* def)
+{
+  const char* v = getenv(name);
+  return v && *v ? v : def;
+}
+
+long simEnvLong(const char* name, long def)
+{
+  const char* v = getenv(name);
+  return v && *v ? strtol(v, 0, 0) : def;
+}
+
+double simEnvDouble(const char* name, double def)
+{
+  const char* v = getenv(name);
+  return v && *v ? strtod(v, 0) : def;
+}
+
+const char* simOutPath(char* path, size_t size, const char* name)
+{
+  static bool created = false;
+  const char* dir = simEnvString("EPD_SIM_OUT", "sim_out");
+  if (!created)
+  {
+    mkdir(dir, 0755);
+    created = true;
+  }
+  snprintf(path, size, "%s/%s", dir, name);
+  return path;
+}
+
+// ---------------- 时间 ----------------
+
+unsigned long micros()
+{
+  return (unsigned long)(uint32_t)simNow();
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(uint32_t)(simNow() / 1000);
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount()
+{
+  return uint32_t(simNowNs() * getCpuFreqMHz() / 1000);
+}
+
+void delay(uint32_t ms)
+{
+  simAdvance(uint64_t(ms) * 1000);
+  simRunDue();
+  std::this_thread::yield();
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  simAdvance(us);
+  simRunDue();
+}
+
+void yield()
+{
+  simRunDue();
+  std::this_thread::yield();
+}
+
+// ---------------- GPIO与中断 ----------------
+
+#define SIM_GPIO_COUNT 64
+
+struct SimIsr
+{
+  void (*fn)(void);
+  void (*fn_arg)(void*);
+  void* arg;
+  int mode;
+};
+static uint8_t gpioLevel[SIM_GPIO_COUNT];
+static SimIsr gpioIsr[SIM_GPIO_COUNT];
+
+static void setLevel(uint8_t pin, uint8_t level)
+{
+  if (pin >= SIM_GPIO_COUNT) return;
+  uint8_t old = gpioLevel[pin];
+  gpioLevel[pin] = level ? 1 : 0;
+  const SimIsr& isr = gpioIsr[pin];
+  if ((old == gpioLevel[pin]) || !(isr.fn || isr.fn_arg)) return;
+  bool rising = gpioLevel[pin];
+  if ((isr.mode == CHANGE) || ((isr.mode == RISING) && rising) || ((isr.mode == FALLING) && !rising))
+  {
+    if (isr.fn_arg) isr.fn_arg(isr.arg);
+    else isr.fn();
+  }
+}
+
+void simSetInput(uint8_t pin, uint8_t level)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  setLevel(pin, level);
+}
+
+int simGpioLevel(uint8_t pin)
+{
+  return pin < SIM_GPIO_COUNT ? gpioLevel[pin] : 0;
+}
+
+// 引脚方向不建模：输出引脚的电平由digitalWrite()决定，BUSY由面板模型驱动
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  setLevel(pin, val);
+  SimPanel::gpioWritten(pin, val ? 1 : 0);
+}
+
+int digitalRead(uint8_t pin)
+{
+  simRunDue();
+  return simGpioLevel(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  if (pin >= SIM_GPIO_COUNT) return;
+  SimIsr s = { isr, 0, 0, mode };
+  gpioIsr[pin] = s;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  if (pin >= SIM_GPIO_COUNT) return;
+  SimIsr s = { 0, isr, arg, mode };
+  gpioIsr[pin] = s;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  if (pin >= SIM_GPIO_COUNT) return;
+  SimIsr s = { 0, 0, 0, 0 };
+  gpioIsr[pin] = s;
+}
+
+// ---------------- 随机数 ----------------
+
+long random(long max)
+{
+  return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max)
+{
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed)
+{
+  srand(seed);
+}
+
+// ---------------- Print ----------------
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char* format, ...)
+{
+  char small[128];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if (size_t(len) < sizeof(small)) return write((const uint8_t*)small, len);
+  std::string big(len + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&big[0], big.size(), format, args);
+  va_end(args);
+  return write((const uint8_t*)big.data(), len);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char* p = buf + sizeof(buf) - 1;
+  *p = 0;
+  if (base < 2) base = 10;
+  do
+  {
+    unsigned long d = n % base;
+    *--p = d < 10 ? '0' + d : 'A' + d - 10;
+    n /= base;
+  }
+  while (n);
+  return write(p);
+}
+
+size_t Print::print(long n, int base)
+{
+  if ((base == 10) && (n < 0)) return print('-') + print((unsigned long)-n, 10);
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+// ---------------- Serial ----------------
+// 默认输出到标准输出、没有输入；设置EPD_SIM_SERIAL（如伪终端/dev/pts/N）时收发都走该设备
+
+HardwareSerial Serial;
+
+static int serialFd()
+{
+  static int fd = -2;
+  if (fd == -2)
+  {
+    const char* path = simEnvString("EPD_SIM_SERIAL", 0);
+    fd = path ? open(path, O_RDWR | O_NOCTTY | O_NONBLOCK) : -1;
+    if (path && (fd < 0)) fprintf(stderr, "sim: 无法打开串口%s\n", path);
+    if ((fd >= 0) && isatty(fd))
+    {
+      struct termios tio;
+      tcgetattr(fd, &tio);
+      cfmakeraw(&tio);
+      tcsetattr(fd, TCSANOW, &tio);
+    }
+  }
+  return fd;
+}
+
+static int serialPeek = -1;
+
+int HardwareSerial::available()
+{
+  if (serialPeek >= 0) return 1;
+  int fd = serialFd();
+  if (fd < 0) return 0;
+  uint8_t c;
+  if (::read(fd, &c, 1) == 1)
+  {
+    serialPeek = c;
+    return 1;
+  }
+  return 0;
+}
+
+int HardwareSerial::peek()
+{
+  return available() ? serialPeek : -1;
+}
+
+int HardwareSerial::read()
+{
+  if (!available()) return -1;
+  int c = serialPeek;
+  serialPeek = -1;
+  return c;
+}
+
+size_t HardwareSerial::readBytes(uint8_t* buffer, size_t length)
+{
+  // 与Stream::readBytes()一样带超时（默认1s，按模拟时间）
+  size_t n = 0;
+  uint64_t deadline = simNow() + 1000000;
+  while ((n < length) && (simNow() < deadline))
+  {
+    int c = read();
+    if (c >= 0) buffer[n++] = c;
+    else delay(1);
+  }
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+  int fd = serialFd();
+  if (fd < 0) return fwrite(buffer, 1, size, stdout);
+  size_t n = 0;
+  while (n < size)
+  {
+    ssize_t k = ::write(fd, buffer + n, size - n);
+    if (k > 0) n += k;
+    else
+    {
+      struct pollfd p = { fd, POLLOUT, 0 };
+      if (poll(&p, 1, 1000) <= 0) break;
+    }
+  }
+  return n;
+}
+
+void HardwareSerial::flush()
+{
+  if (serialFd() < 0) fflush(stdout);
+}
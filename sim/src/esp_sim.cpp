@@ -0,0 +1,169 @@
+// esp_sim.cpp
+// ESP-IDF接口的主机模拟：GPIO驱动、浅睡眠/深睡眠
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include "sim.h"
+#include "ssd1608_model.h"
+#include <unistd.h>
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level)
+{
+  digitalWrite(gpio, level ? HIGH : LOW);
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio)
+{
+  return digitalRead(gpio);
+}
+
+// ---------------- 睡眠 ----------------
+
+static int wakeupPin = -1;
+static int wakeupLevel = 0;
+static bool gpioWakeup = false;
+static uint64_t timerWakeupUs = 0;
+static bool timerWakeup = false;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type)
+{
+  if ((type != GPIO_INTR_LOW_LEVEL) && (type != GPIO_INTR_HIGH_LEVEL)) return ESP_ERR_INVALID_ARG;
+  wakeupPin = gpio;
+  wakeupLevel = type == GPIO_INTR_HIGH_LEVEL;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio)
+{
+  if (wakeupPin == gpio) wakeupPin = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+  timerWakeupUs = time_in_us;
+  timerWakeup = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+  gpioWakeup = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(int gpio_num, int level)
+{
+  wakeupPin = gpio_num;
+  wakeupLevel = level;
+  gpioWakeup = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+  if ((source == ESP_SLEEP_WAKEUP_ALL) || (source == ESP_SLEEP_WAKEUP_TIMER)) timerWakeup = false;
+  if ((source == ESP_SLEEP_WAKEUP_ALL) || (source == ESP_SLEEP_WAKEUP_GPIO) || (source == ESP_SLEEP_WAKEUP_EXT0)) gpioWakeup = false;
+  return ESP_OK;
+}
+
+// 浅睡眠：两个核都停下，时钟直接跳到唤醒条件成立的时刻
+esp_err_t esp_light_sleep_start()
+{
+  uint64_t deadline = timerWakeup ? simNow() + timerWakeupUs : UINT64_MAX;
+  for (;;)
+  {
+    if (gpioWakeup && (wakeupPin >= 0) && (simGpioLevel(wakeupPin) == wakeupLevel))
+    {
+      wakeupCause = ESP_SLEEP_WAKEUP_GPIO;
+      return ESP_OK;
+    }
+    if (simNow() >= deadline)
+    {
+      wakeupCause = ESP_SLEEP_WAKEUP_TIMER;
+      return ESP_OK;
+    }
+    if ((deadline == UINT64_MAX) && (simNextEvent() == UINT64_MAX)) return ESP_FAIL; // 没有唤醒源
+    simIdleUntil(deadline);
+  }
+}
+
+// RTC_DATA_ATTR变量所在的段（见esp_attr.h），固件没有定义时两个符号都为0
+extern "C" char __start_rtc_slow[] __attribute__((weak));
+extern "C" char __stop_rtc_slow[] __attribute__((weak));
+
+static const uint32_t DEEP_SLEEP_MAGIC = 0x44534C50; // "DSLP"
+
+struct DeepSleepHeader
+{
+  uint32_t magic;
+  uint32_t rtc_size;
+  uint64_t wake_at;    // 唤醒时刻（模拟时间，μs）
+};
+
+static size_t rtcSize()
+{
+  return (__start_rtc_slow && __stop_rtc_slow) ? size_t(__stop_rtc_slow - __start_rtc_slow) : 0;
+}
+
+// 深睡眠：EPD_SIM_WAKEUPS次数用完或没有定时唤醒时结束模拟；
+// 否则保存RTC内存、面板状态与唤醒时刻，重新启动本进程（全局对象与堆都重新开始，和真实的唤醒一样）
+void esp_deep_sleep_start()
+{
+  Serial.flush();
+  long wakeups = simEnvLong("EPD_SIM_WAKEUPS", 0);
+  if (!timerWakeup || (wakeups <= 0))
+  {
+    fprintf(stderr, "sim: 进入深睡眠，模拟结束\n");
+    simFinish(0);
+  }
+  simLock();
+  char path[512];
+  simOutPath(path, sizeof(path), "deep_sleep.bin");
+  DeepSleepHeader h = { DEEP_SLEEP_MAGIC, uint32_t(rtcSize()), simNow() + timerWakeupUs };
+  FILE* f = fopen(path, "wb");
+  bool ok = f && (fwrite(&h, sizeof(h), 1, f) == 1) && (!h.rtc_size || (fwrite(__start_rtc_slow, h.rtc_size, 1, f) == 1)) &&
+            SimPanel::saveAll(f);
+  if (f) fclose(f);
+  if (!ok)
+  {
+    fprintf(stderr, "sim: 无法保存深睡眠状态%s\n", path);
+    simFinish(1);
+  }
+  fprintf(stderr, "sim: 深睡眠%.3fs后唤醒（还剩%ld次）\n", timerWakeupUs / 1e6, wakeups - 1);
+  char n[24];
+  snprintf(n, sizeof(n), "%ld", wakeups - 1);
+  setenv("EPD_SIM_WAKEUPS", n, 1);
+  setenv("EPD_SIM_RESUME", path, 1);
+  fflush(stdout);
+  fflush(stderr);
+  execl("/proc/self/exe", "sim", (char*)0);
+  perror("sim: execl");
+  simFinish(1);
+}
+
+void simResumeDeepSleep()
+{
+  const char* path = getenv("EPD_SIM_RESUME");
+  if (!path) return;
+  DeepSleepHeader h;
+  FILE* f = fopen(path, "rb");
+  bool ok = f && (fread(&h, sizeof(h), 1, f) == 1) && (h.magic == DEEP_SLEEP_MAGIC) && (h.rtc_size == rtcSize()) &&
+            (!h.rtc_size || (fread(__start_rtc_slow, h.rtc_size, 1, f) == 1)) && SimPanel::loadAll(f);
+  if (f) fclose(f);
+  unsetenv("EPD_SIM_RESUME");
+  if (!ok)
+  {
+    fprintf(stderr, "sim: 深睡眠状态%s无效（固件重新编译过？），按冷启动运行\n", path);
+    return;
+  }
+  simAdvanceTo(h.wake_at);
+  wakeupCause = ESP_SLEEP_WAKEUP_TIMER;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+  return wakeupCause;
+}
@@ -0,0 +1,276 @@
+// freertos_sim.cpp
+// FreeRTOS的主机模拟：任务为std::thread，队列/信号量/任务通知为互斥锁加条件变量
+//
+// 等待按模拟时间计时：所有模拟线程都在等待时，没有谁还能推进CPU时间，
+// 这时把时钟直接拨到下一个定时事件（BUSY释放、DMA完成）或等待超时，与离散事件仿真相同；
+// 还有线程在运行时只做短暂的真实等待，让它的CPU时间照常计入。
+#include <Arduino.h>
+#include "sim.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::atomic<int> simThreads(1); // 主线程（setup()/loop()）
+static std::atomic<int> simBlocked(0);
+static std::recursive_mutex criticalMutex;
+
+void simEnterCritical()
+{
+  criticalMutex.lock();
+}
+
+void simExitCritical()
+{
+  criticalMutex.unlock();
+}
+
+template<typename Ready>
+static bool waitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks, Ready ready)
+{
+  if (ready()) return true;
+  lock.unlock();
+  simRunDue(); // 到期事件（如BUSY中断）可能正好满足条件
+  lock.lock();
+  if (ready() || (ticks == 0)) return ready();
+  uint64_t deadline = ticks == portMAX_DELAY ? UINT64_MAX : simNow() + uint64_t(ticks) * 1000;
+  simBlocked++;
+  uint16_t stalls = 0;
+  for (;;)
+  {
+    if (ready() || (simNow() >= deadline)) break;
+    if (simBlocked.load() < simThreads.load())
+    {
+      cv.wait_for(lock, std::chrono::microseconds(200), ready);
+      continue;
+    }
+    lock.unlock();
+    bool advanced = simIdleUntil(deadline);
+    lock.lock();
+    if (advanced || ready())
+    {
+      stalls = 0;
+      continue;
+    }
+    // 既没有事件也没有超时：可能只是别的线程刚被唤醒还没开始运行，持续约2s（真实时间）才算死锁
+    SimPause pause;
+    cv.wait_for(lock, std::chrono::milliseconds(1), ready);
+    if (++stalls > 2000)
+    {
+      fprintf(stderr, "sim: 所有任务都在无限期等待\n");
+      simFinish(1);
+    }
+  }
+  simBlocked--;
+  return ready();
+}
+
+// ---------------- 任务 ----------------
+
+struct SimTask
+{
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t notify;
+  BaseType_t core;
+  SimTask() : notify(0), core(1) {}
+};
+
+struct SimTaskExit {};
+
+static SimTask mainTask;
+static thread_local SimTask* currentTask = &mainTask;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t core)
+{
+  (void)name;
+  (void)stack;
+  (void)priority;
+  SimTask* task = new SimTask();
+  task->core = core;
+  if (handle) *handle = task;
+  simThreads++;
+  std::thread([fn, arg, task]()
+  {
+    currentTask = task;
+    try
+    {
+      fn(arg);
+    }
+    catch (SimTaskExit&)
+    {
+    }
+    simThreads--;
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority, TaskHandle_t* handle)
+{
+  return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  // 只支持删除自己（其余情况线程无法从外部终止，任务保持阻塞）
+  if (!task || (task == currentTask)) throw SimTaskExit();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return currentTask;
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return millis();
+}
+
+BaseType_t xPortGetCoreID()
+{
+  return currentTask->core;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+  SimTask* t = currentTask;
+  std::unique_lock<std::mutex> lock(t->m);
+  if (!waitFor(lock, t->cv, ticks, [t]() { return t->notify > 0; })) return 0;
+  uint32_t value = t->notify;
+  t->notify = clear ? 0 : value - 1;
+  return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  {
+    std::lock_guard<std::mutex> lock(task->m);
+    task->notify++;
+  }
+  task->cv.notify_all();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+  xTaskNotifyGive(task);
+  if (woken) *woken = pdTRUE;
+}
+
+// ---------------- 队列与信号量 ----------------
+
+struct SimQueue
+{
+  std::mutex m;
+  std::condition_variable cv;
+  UBaseType_t length, item_size;
+  UBaseType_t count; // 信号量（item_size == 0）只用计数
+  std::deque<std::vector<uint8_t> > items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  SimQueue* q = new SimQueue();
+  q->length = length;
+  q->item_size = item_size;
+  q->count = 0;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+  delete q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks)
+{
+  {
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(lock, q->cv, ticks, [q]() { return q->count < q->length; })) return pdFAIL;
+    if (q->item_size) q->items.push_back(std::vector<uint8_t>((const uint8_t*)item, (const uint8_t*)item + q->item_size));
+    q->count++;
+  }
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks)
+{
+  return xQueueSend(q, item, ticks);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken)
+{
+  if (woken) *woken = pdTRUE;
+  return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks)
+{
+  {
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(lock, q->cv, ticks, [q]() { return q->count > 0; })) return pdFAIL;
+    if (q->item_size)
+    {
+      memcpy(item, q->items.front().data(), q->item_size);
+      q->items.pop_front();
+    }
+    q->count--;
+  }
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+  std::lock_guard<std::mutex> lock(q->m);
+  return q->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+  SimQueue* q = xQueueCreate(max, 0);
+  q->count = initial;
+  return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  SimQueue* q = xQueueCreate(1, 0);
+  q->count = 1;
+  return q;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+  return xQueueReceive(s, 0, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+  return xQueueSend(s, 0, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken)
+{
+  if (woken) *woken = pdTRUE;
+  return xQueueSend(s, 0, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+  vQueueDelete(s);
+}
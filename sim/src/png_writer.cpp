@@ -0,0 +1,96 @@
+// png_writer.cpp
+// 最小PNG编码器实现
+#include "png_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n)
+{
+  static uint32_t table[256];
+  if (!table[1])
+  {
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  crc = ~crc;
+  while (n--) crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v)
+{
+  out.push_back(v >> 24);
+  out.push_back(v >> 16);
+  out.push_back(v >> 8);
+  out.push_back(v);
+}
+
+static void chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+  put32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put32(out, crc32(0, &out[start], out.size() - start));
+}
+
+bool simWritePng(const char* path, const uint8_t* pixels, uint16_t w, uint16_t h, uint16_t stride)
+{
+  // 原始数据：每行一个滤波类型字节（0 = 不滤波）加像素
+  const uint16_t wb = (w + 7) / 8;
+  std::vector<uint8_t> raw;
+  raw.reserve(size_t(wb + 1) * h);
+  for (uint16_t y = 0; y < h; y++)
+  {
+    raw.push_back(0);
+    raw.insert(raw.end(), pixels + size_t(y) * stride, pixels + size_t(y) * stride + wb);
+  }
+
+  // zlib流：头、存储块（每块最多65535字节）、Adler-32
+  std::vector<uint8_t> z;
+  z.push_back(0x78);
+  z.push_back(0x01);
+  size_t pos = 0;
+  do
+  {
+    size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+    z.push_back(pos + n == raw.size() ? 1 : 0);
+    z.push_back(n & 0xFF);
+    z.push_back(n >> 8);
+    z.push_back(~n & 0xFF);
+    z.push_back((~n >> 8) & 0xFF);
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+    pos += n;
+  }
+  while (pos < raw.size());
+  uint32_t a = 1, b = 0;
+  for (uint8_t c : raw)
+  {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  put32(z, (b << 16) | a);
+
+  std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  std::vector<uint8_t> ihdr;
+  put32(ihdr, w);
+  put32(ihdr, h);
+  ihdr.push_back(1); // 位深度
+  ihdr.push_back(0); // 灰度
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  ihdr.push_back(0);
+  chunk(png, "IHDR", ihdr);
+  chunk(png, "IDAT", z);
+  chunk(png, "IEND", std::vector<uint8_t>());
+
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+  return (fclose(f) == 0) && ok;
+}
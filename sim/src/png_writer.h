@@ -0,0 +1,11 @@
+// png_writer.h
+// 最小PNG编码器：1位灰度，deflate只用不压缩的存储块，不依赖zlib
+#ifndef SIM_PNG_WRITER_H
+#define SIM_PNG_WRITER_H
+
+#include <stdint.h>
+
+// pixels为w×h的1位图像（每行stride字节，MSB在左，1为白），写入成功返回true
+bool simWritePng(const char* path, const uint8_t* pixels, uint16_t w, uint16_t h, uint16_t stride);
+
+#endif
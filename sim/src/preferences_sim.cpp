@@ -0,0 +1,100 @@
+// preferences_sim.cpp
+// Preferences的主机模拟：打开时读入整个文件，每次写入后整体写回（记录：键长、键、值长、值）
+#include <Preferences.h>
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partition_label)
+{
+  (void)partition_label;
+  end();
+  if (!name || !*name || (strlen(name) > 15)) return false; // NVS命名空间最长15个字符
+  char file[64], path[512];
+  snprintf(file, sizeof(file), "nvs_%s.bin", name);
+  _path = simOutPath(path, sizeof(path), file);
+  _read_only = readOnly;
+  _items.clear();
+  FILE* f = fopen(_path.c_str(), "rb");
+  if (f)
+  {
+    uint32_t klen, vlen;
+    while ((fread(&klen, sizeof(klen), 1, f) == 1) && (klen < 256))
+    {
+      std::string key(klen, '\0');
+      if ((fread(&key[0], 1, klen, f) != klen) || (fread(&vlen, sizeof(vlen), 1, f) != 1)) break;
+      std::vector<uint8_t> value(vlen);
+      if (vlen && (fread(value.data(), 1, vlen, f) != vlen)) break;
+      _items[key] = value;
+    }
+    fclose(f);
+  }
+  _open = true;
+  return true;
+}
+
+void Preferences::end()
+{
+  _open = false;
+  _items.clear();
+}
+
+bool Preferences::clear()
+{
+  if (!_open || _read_only) return false;
+  _items.clear();
+  return _flush();
+}
+
+bool Preferences::remove(const char* key)
+{
+  if (!_open || _read_only || !_items.erase(key)) return false;
+  return _flush();
+}
+
+bool Preferences::isKey(const char* key)
+{
+  return _open && _items.count(key);
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len)
+{
+  if (!_open || _read_only || !key || (strlen(key) > 15)) return 0;
+  const uint8_t* p = (const uint8_t*)value;
+  _items[key] = std::vector<uint8_t>(p, p + len);
+  return _flush() ? len : 0;
+}
+
+size_t Preferences::getBytesLength(const char* key)
+{
+  if (!_open) return 0;
+  std::map<std::string, std::vector<uint8_t> >::const_iterator it = _items.find(key);
+  return it == _items.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen)
+{
+  size_t len = getBytesLength(key);
+  if (!len || (len > maxLen)) return 0;
+  memcpy(buf, _items[key].data(), len);
+  return len;
+}
+
+bool Preferences::_get(const char* key, void* buf, size_t len)
+{
+  return (getBytesLength(key) == len) && (getBytes(key, buf, len) == len);
+}
+
+bool Preferences::_flush()
+{
+  FILE* f = fopen(_path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = true;
+  for (std::map<std::string, std::vector<uint8_t> >::const_iterator it = _items.begin(); ok && (it != _items.end()); ++it)
+  {
+    uint32_t klen = it->first.size(), vlen = it->second.size();
+    ok = (fwrite(&klen, sizeof(klen), 1, f) == 1) && (fwrite(it->first.data(), 1, klen, f) == klen) &&
+         (fwrite(&vlen, sizeof(vlen), 1, f) == 1) && (!vlen || (fwrite(it->second.data(), 1, vlen, f) == vlen));
+  }
+  return (fclose(f) == 0) && ok;
+}
@@ -0,0 +1,58 @@
+// sim.h
+// 模拟器内部接口：模拟时钟、事件队列、GPIO与面板模型（只在sim/src内使用，固件代码看不到）
+#ifndef SIM_SIM_H
+#define SIM_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 模拟时间（μs）= 主机CPU耗时 × EPD_SIM_CPU_SCALE + I/O耗时
+ * I/O耗时由模拟器推进：delay()、SPI字节按时钟折算、等待BUSY/DMA完成时跳到事件发生时刻。
+ * 模拟器自身的开销（解码字节流、写PNG等）用SimPause排除在外，不计入固件的CPU时间。
+ */
+uint64_t simNow();
+void simAdvance(uint64_t us);
+void simAdvanceNs(uint64_t ns);
+void simAdvanceTo(uint64_t t);
+
+class SimPause
+{
+  public:
+    SimPause();
+    ~SimPause();
+};
+
+// 定时事件（BUSY释放、DMA传输完成等）：到期后在推进时钟或等待的线程里执行，执行时持有模拟器锁
+typedef void (*SimEventFn)(void* arg, uint32_t tag);
+void simSchedule(uint64_t at, SimEventFn fn, void* arg, uint32_t tag = 0);
+// 执行所有已到期的事件
+void simRunDue();
+// 最早的未到期事件时刻，没有时返回UINT64_MAX
+uint64_t simNextEvent();
+// 空等：把时钟推进到min(limit, 下一个事件)，执行到期事件；返回是否推进了时钟
+bool simIdleUntil(uint64_t limit);
+
+// 模拟器全局锁（可重入），事件、GPIO与面板模型共用
+void simLock();
+void simUnlock();
+
+// GPIO：面板驱动的输入引脚（BUSY），电平变化触发已挂接的中断
+void simSetInput(uint8_t pin, uint8_t level);
+int simGpioLevel(uint8_t pin);
+
+// 环境变量配置
+long simEnvLong(const char* name, long def);
+double simEnvDouble(const char* name, double def);
+const char* simEnvString(const char* name, const char* def);
+// 输出目录（EPD_SIM_OUT，默认sim_out），path在其中拼出完整路径
+const char* simOutPath(char* path, size_t size, const char* name);
+
+// 深睡眠唤醒：由上一个进程（esp_deep_sleep_start()）保存的RTC内存、面板状态与模拟时间，
+// 启动时在setup()之前恢复，没有时什么都不做
+void simResumeDeepSleep();
+
+// 结束模拟：写汇总并退出进程（深睡眠、loop()次数用完时调用）
+void simFinish(int code) __attribute__((noreturn));
+
+#endif
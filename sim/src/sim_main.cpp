@@ -0,0 +1,43 @@
+// sim_main.cpp
+// 模拟器入口：代替Arduino核心的main()，执行setup()和EPD_SIM_LOOPS次loop()（默认1次），结束时输出汇总；
+// 深睡眠定时唤醒时进程重新启动，先恢复睡眠前的状态
+#include <Arduino.h>
+#include "sim.h"
+#include "ssd1608_model.h"
+#include <atomic>
+#include <unistd.h>
+
+int main()
+{
+  SimPanel::setupAll();
+  simResumeDeepSleep();
+  setup();
+  long loops = simEnvLong("EPD_SIM_LOOPS", 1);
+  for (long i = 0; i < loops; i++) loop();
+  simFinish(0);
+}
+
+void simFinish(int code)
+{
+  static std::atomic<bool> finished(false);
+  if (finished.exchange(true)) _exit(code);
+  Serial.flush();
+  fflush(stdout);
+  simLock();
+  uint64_t now = simNow();
+  fprintf(stderr, "sim: 模拟时间%.3fs\n", now / 1e6);
+  SimPanel::summaryAll(stderr, false);
+  SimPanel::saveScreens();
+  char path[512];
+  FILE* f = fopen(simOutPath(path, sizeof(path), "summary.json"), "w");
+  if (f)
+  {
+    fprintf(f, "{\"sim_us\":%llu,\"panels\":[", (unsigned long long)now);
+    SimPanel::summaryAll(f, true);
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  fflush(stderr);
+  // 渲染任务等线程仍阻塞在等待中，不做静态析构直接退出
+  _exit(code);
+}
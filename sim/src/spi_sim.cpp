@@ -0,0 +1,210 @@
+// spi_sim.cpp
+// SPI的主机模拟：Arduino SPIClass（阻塞，逐字节计时）与ESP-IDF spi_master（DMA队列，后台按总线时钟完成）
+// 字节都送到面板模型；EPD_SIM_SPI_HZ非0时覆盖固件配置的SPI时钟
+#include <Arduino.h>
+#include <SPI.h>
+#include <driver/spi_master.h>
+#include "sim.h"
+#include "ssd1608_model.h"
+#include <deque>
+
+SPIClass SPI(VSPI);
+
+// spi_master的状态（SPIClass发送时检查总线是否已借给它）
+static bool busInitialized[3];
+static int busDevices[3];
+static spi_device_handle_t busOwner[3]; // spi_device_acquire_bus()占住总线的设备
+
+static uint64_t byteNs(uint32_t clock_hz)
+{
+  static const long override_hz = simEnvLong("EPD_SIM_SPI_HZ", 0);
+  uint32_t hz = override_hz > 0 ? override_hz : clock_hz;
+  return hz ? 8000000000ull / hz : 0;
+}
+
+// ---------------- SPIClass ----------------
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+  // HSPI上挂着ESP-IDF设备时，SPIClass只能在总线借出（被某个设备占住）期间使用
+  int host = _bus == HSPI ? HSPI_HOST : VSPI_HOST;
+  static bool warned = false;
+  if (busDevices[host] && !busOwner[host] && !warned)
+  {
+    fprintf(stderr, "sim: SPIClass在ESP-IDF驱动占用总线时传输\n");
+    warned = true;
+  }
+  simLock();
+  SimPanel::spiByteAll(data, simNow());
+  simUnlock();
+  simAdvanceNs(byteNs(_clock));
+  return 0xFF; // 面板没有MISO
+}
+
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+  transfer(data >> 8);
+  transfer(data & 0xFF);
+  return 0xFFFF;
+}
+
+void SPIClass::transfer(void* data, uint32_t size)
+{
+  uint8_t* p = (uint8_t*)data;
+  for (uint32_t i = 0; i < size; i++) p[i] = transfer(p[i]);
+}
+
+void SPIClass::writeBytes(const uint8_t* data, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; i++) transfer(data[i]);
+}
+
+// ---------------- spi_master ----------------
+
+struct SimPending
+{
+  spi_transaction_t* t;
+  uint64_t done;
+  bool completed;
+};
+
+struct spi_device_t
+{
+  spi_host_device_t host;
+  int cs;
+  int clock_hz;
+  transaction_cb_t pre_cb, post_cb;
+  std::deque<SimPending> pending;
+};
+
+static uint64_t busFreeAt = 0; // 总线上最后一个已排队传输的完成时刻
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* bus, int dma_chan)
+{
+  (void)bus;
+  (void)dma_chan;
+  if (busInitialized[host]) return ESP_ERR_INVALID_STATE;
+  busInitialized[host] = true;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host)
+{
+  if (!busInitialized[host] || busDevices[host]) return ESP_ERR_INVALID_STATE;
+  busInitialized[host] = false;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* dev, spi_device_handle_t* handle)
+{
+  if (!busInitialized[host]) return ESP_ERR_INVALID_STATE;
+  spi_device_t* d = new spi_device_t();
+  d->host = host;
+  d->cs = dev->spics_io_num;
+  d->clock_hz = dev->clock_speed_hz;
+  d->pre_cb = dev->pre_cb;
+  d->post_cb = dev->post_cb;
+  busDevices[host]++;
+  *handle = d;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+  if (!handle) return ESP_ERR_INVALID_ARG;
+  if (!handle->pending.empty() || (busOwner[handle->host] == handle)) return ESP_ERR_INVALID_STATE;
+  busDevices[handle->host]--;
+  delete handle;
+  return ESP_OK;
+}
+
+// 传输完成事件：在ISR上下文的位置调用post_cb
+static void transferDone(void* arg, uint32_t tag)
+{
+  spi_device_t* d = (spi_device_t*)arg;
+  for (SimPending& p : d->pending)
+  {
+    if (!p.completed && (p.done <= simNow()))
+    {
+      p.completed = true;
+      if (d->post_cb) d->post_cb(p.t);
+    }
+  }
+  (void)tag;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans, TickType_t ticks)
+{
+  (void)ticks;
+  simLock();
+  // 字节在排队时就交给面板模型（时间戳按它在总线上的实际时刻），完成时刻由总线时钟决定
+  uint64_t now = simNow();
+  uint64_t start = busFreeAt > now ? busFreeAt : now;
+  if (handle->pre_cb) handle->pre_cb(trans);
+  const uint8_t* data = trans->flags & SPI_TRANS_USE_TXDATA ? trans->tx_data : (const uint8_t*)trans->tx_buffer;
+  size_t n = trans->length / 8;
+  uint64_t ns = byteNs(handle->clock_hz);
+  SimPanel* panel = SimPanel::byCs(handle->cs);
+  for (size_t i = 0; i < n; i++)
+    if (panel) panel->spiByte(data[i], start + i * ns / 1000);
+  SimPending p = { trans, start + (n * ns + 999) / 1000, false };
+  handle->pending.push_back(p);
+  busFreeAt = p.done;
+  simSchedule(p.done, transferDone, handle);
+  simUnlock();
+  return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** trans, TickType_t ticks)
+{
+  simLock();
+  if (handle->pending.empty())
+  {
+    simUnlock();
+    return ESP_ERR_TIMEOUT;
+  }
+  uint64_t done = handle->pending.front().done;
+  if (done > simNow())
+  {
+    // 等待DMA：CPU空等，时钟拨到完成时刻（或超时）
+    if (ticks == 0)
+    {
+      simUnlock();
+      simRunDue();
+      return ESP_ERR_TIMEOUT;
+    }
+    uint64_t limit = ticks == portMAX_DELAY ? done : simNow() + uint64_t(ticks) * 1000;
+    simAdvanceTo(done < limit ? done : limit);
+  }
+  simRunDue();
+  if (!handle->pending.front().completed)
+  {
+    simUnlock();
+    return ESP_ERR_TIMEOUT;
+  }
+  *trans = handle->pending.front().t;
+  handle->pending.pop_front();
+  simUnlock();
+  return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* trans)
+{
+  spi_transaction_t* done;
+  esp_err_t err = spi_device_queue_trans(handle, trans, portMAX_DELAY);
+  if (err == ESP_OK) err = spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+  return err;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t device, TickType_t wait)
+{
+  (void)wait;
+  if (!device || !device->pending.empty()) return ESP_ERR_INVALID_STATE;
+  busOwner[device->host] = device;
+  return ESP_OK;
+}
+
+void spi_device_release_bus(spi_device_handle_t dev)
+{
+  if (busOwner[dev->host] == dev) busOwner[dev->host] = 0;
+}
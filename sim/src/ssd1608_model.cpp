@@ -0,0 +1,435 @@
+// ssd1608_model.cpp
+// SSD1608控制器模型实现
+#include "ssd1608_model.h"
+#include "sim.h"
+#include "png_writer.h"
+#include <string.h>
+#include <stdlib.h>
+
+// GxEPD2_290的默认LUT帧数（全刷FF FF 1F，局部13 14 44 12），时序模型以它们为基准
+static const uint16_t FULL_LUT_FRAMES = 76;
+static const uint16_t PARTIAL_LUT_FRAMES = 20;
+
+static SimPanel* panels[SimPanel::MAX_PANELS];
+static uint8_t panelCount = 0;
+static bool multiPanel = false; // 多块面板时输出文件加pN_前缀
+
+struct SimTiming
+{
+  uint32_t partial_us, full_us, power_on_us, power_off_us;
+  bool png, stream;
+  uint8_t rotation;
+};
+static SimTiming timing;
+
+void SimPanel::setupAll()
+{
+  timing.partial_us = simEnvLong("EPD_SIM_PARTIAL_MS", 300) * 1000;
+  timing.full_us = simEnvLong("EPD_SIM_FULL_MS", 2000) * 1000;
+  timing.power_on_us = simEnvLong("EPD_SIM_POWER_ON_MS", 100) * 1000;
+  timing.power_off_us = simEnvLong("EPD_SIM_POWER_OFF_MS", 150) * 1000;
+  timing.png = simEnvLong("EPD_SIM_PNG", 1) != 0;
+  timing.stream = simEnvLong("EPD_SIM_STREAM", 1) != 0;
+  timing.rotation = simEnvLong("EPD_SIM_PNG_ROTATION", 1) & 3;
+
+  const char* spec = simEnvString("EPD_SIM_PANELS", "15:27:26:25");
+  multiPanel = strchr(spec, ',') != 0;
+  while (*spec && (panelCount < MAX_PANELS))
+  {
+    int cs, dc, rst, busy, n = 0;
+    if (sscanf(spec, "%d:%d:%d:%d%n", &cs, &dc, &rst, &busy, &n) != 4)
+    {
+      fprintf(stderr, "sim: EPD_SIM_PANELS格式错误：%s\n", spec);
+      break;
+    }
+    panels[panelCount] = new SimPanel(panelCount, cs, dc, rst, busy);
+    panelCount++;
+    spec += n;
+    if (*spec == ',') spec++;
+  }
+}
+
+uint8_t SimPanel::count()
+{
+  return panelCount;
+}
+
+SimPanel* SimPanel::at(uint8_t i)
+{
+  return i < panelCount ? panels[i] : 0;
+}
+
+SimPanel* SimPanel::byCs(int pin)
+{
+  for (uint8_t i = 0; i < panelCount; i++)
+    if (panels[i]->_cs == pin) return panels[i];
+  return 0;
+}
+
+void SimPanel::spiByteAll(uint8_t b, uint64_t t)
+{
+  for (uint8_t i = 0; i < panelCount; i++)
+    if (simGpioLevel(panels[i]->_cs) == 0) panels[i]->spiByte(b, t);
+}
+
+void SimPanel::gpioWritten(uint8_t pin, uint8_t level)
+{
+  for (uint8_t i = 0; i < panelCount; i++)
+  {
+    // 硬件复位：RST拉低即复位（唤醒深睡眠，RAM内容保留）
+    if ((panels[i]->_rst == pin) && !level) panels[i]->_reset();
+  }
+}
+
+SimPanel::SimPanel(uint8_t index, int cs, int dc, int rst, int busy) :
+  _index(index), _cs(cs), _dc(dc), _rst(rst), _busy(busy),
+  _cmd(0), _nparam(0), _lut_loaded(false), _entry_mode(0x03), _update_ctrl(0xFF),
+  _xs(0), _xe(WIDTH / 8 - 1), _xc(0), _ys(0), _ye(HEIGHT - 1), _yc(0),
+  _powered(false), _sleeping(false), _busy_until(0), _busy_seq(0),
+  _commands(0), _data_bytes(0), _ignored(0), _refresh_full(0), _refresh_partial(0), _lut_writes(0), _bytes_since_refresh(0), _busy_us(0),
+  _stream(0), _refreshes(0), _stream_run(0)
+{
+  // 上电时RAM内容不确定，这里取白色，屏幕也按白色开始
+  memset(_ram, 0xFF, sizeof(_ram));
+  memset(_screen, 0xFF, sizeof(_screen));
+  memset(_lut, 0, sizeof(_lut));
+  // 深睡眠唤醒后接着上一个进程的输出追加
+  bool resume = getenv("EPD_SIM_RESUME") != 0;
+  if (!resume && simEnvLong("EPD_SIM_POWER_CYCLE", 0))
+  {
+    // 重新上电：屏幕保留上次的画面，RAM是随机内容（差分传输若误信RAM，刷新后就能看出来）
+    FILE* f = _open("screen.bin", "rb");
+    if (f)
+    {
+      if (fread(_screen, sizeof(_screen), 1, f) != 1) memset(_screen, 0xFF, sizeof(_screen));
+      fclose(f);
+    }
+    srand(12345 + index);
+    for (uint16_t y = 0; y < HEIGHT; y++)
+      for (uint16_t x = 0; x < WIDTH / 8; x++) _ram[y][x] = uint8_t(rand());
+  }
+  if (timing.stream) _stream = _open("stream.log", resume ? "a" : "w");
+  _refreshes = _open("refreshes.csv", resume ? "a" : "w");
+  if (_refreshes && !resume) fprintf(_refreshes, "refresh,start_us,busy_us,kind,lut_frames,bytes,changed_px,png\n");
+  simSetInput(_busy, 0);
+}
+
+FILE* SimPanel::_open(const char* name, const char* mode)
+{
+  char file[64], path[512];
+  if (multiPanel) snprintf(file, sizeof(file), "p%u_%s", _index, name);
+  else snprintf(file, sizeof(file), "%s", name);
+  return fopen(simOutPath(path, sizeof(path), file), mode);
+}
+
+void SimPanel::_reset()
+{
+  _sleeping = false;
+  _powered = false;
+  _lut_loaded = false;
+  _entry_mode = 0x03;
+  _xs = _xc = 0;
+  _xe = WIDTH / 8 - 1;
+  _ys = _yc = 0;
+  _ye = HEIGHT - 1;
+  _nparam = 0;
+  if (_stream) fprintf(_stream, "%s%10llu RESET\n", _stream_run ? "\n" : "", (unsigned long long)simNow());
+  _stream_run = 0;
+}
+
+void SimPanel::spiByte(uint8_t b, uint64_t t)
+{
+  SimPause pause;
+  bool dc = simGpioLevel(_dc) != 0;
+  _log(dc, b, t);
+  if (_sleeping)
+  {
+    _ignored++;
+    return;
+  }
+  if (dc) _param(b, t);
+  else _command(b, t);
+}
+
+void SimPanel::_log(bool dc, uint8_t b, uint64_t t)
+{
+  if (!_stream) return;
+  // 每个命令一行，后面的数据每行16字节
+  if (!dc)
+  {
+    fprintf(_stream, "%s%10llu C %02X", _stream_run ? "\n" : "", (unsigned long long)t, b);
+    _stream_run = 1;
+  }
+  else
+  {
+    if (!_stream_run || (_stream_run > 16))
+    {
+      fprintf(_stream, "%s%10llu D", _stream_run ? "\n" : "", (unsigned long long)t);
+      _stream_run = 1;
+    }
+    fprintf(_stream, " %02X", b);
+    _stream_run++;
+  }
+}
+
+void SimPanel::_command(uint8_t c, uint64_t t)
+{
+  _commands++;
+  _bytes_since_refresh++;
+  _cmd = c;
+  _nparam = 0;
+  switch (c)
+  {
+    case 0x12: // 软件复位
+      _reset();
+      _busy_until = t + 1000;
+      simSetInput(_busy, 1);
+      simSchedule(_busy_until, _busyDone, this, ++_busy_seq);
+      break;
+    case 0x20: // 执行0x22设置的更新序列
+      _activate(t);
+      break;
+    case 0x24: // 写RAM：从当前地址计数器开始
+      break;
+    default:
+      break;
+  }
+}
+
+void SimPanel::_param(uint8_t d, uint64_t t)
+{
+  _data_bytes++;
+  _bytes_since_refresh++;
+  if (_cmd == 0x24)
+  {
+    _ramWrite(d);
+    return;
+  }
+  if (_nparam < sizeof(_params)) _params[_nparam] = d;
+  _nparam++;
+  switch (_cmd)
+  {
+    case 0x10: // 深睡眠
+      if (d & 0x01) _sleeping = true;
+      break;
+    case 0x11: // 数据输入模式
+      _entry_mode = d & 0x07;
+      break;
+    case 0x22:
+      _update_ctrl = d;
+      break;
+    case 0x32:
+      if (_nparam <= sizeof(_lut)) _lut[_nparam - 1] = d;
+      if (_nparam == sizeof(_lut))
+      {
+        _lut_loaded = true;
+        _lut_writes++;
+      }
+      break;
+    case 0x44:
+      if (_nparam == 1) _xs = d & 0x1F;
+      if (_nparam == 2) _xe = d & 0x1F;
+      break;
+    case 0x45:
+      if (_nparam == 2) _ys = (_params[0] | (uint16_t(d & 1) << 8));
+      if (_nparam == 4) _ye = (_params[2] | (uint16_t(d & 1) << 8));
+      break;
+    case 0x4E:
+      if (_nparam == 1) _xc = d & 0x1F;
+      break;
+    case 0x4F:
+      if (_nparam == 1) _yc = d;
+      if (_nparam == 2) _yc = _params[0] | (uint16_t(d & 1) << 8);
+      break;
+    default:
+      break;
+  }
+  (void)t;
+}
+
+// 写一个字节并按数据输入模式（0x11）移动地址计数器：bit0 X递增，bit1 Y递增，bit2 先Y后X
+void SimPanel::_ramWrite(uint8_t d)
+{
+  if ((_xc < WIDTH / 8) && (_yc < HEIGHT)) _ram[_yc][_xc] = d;
+  bool x_inc = _entry_mode & 0x01, y_inc = _entry_mode & 0x02;
+  bool x_done = false, y_done = false;
+  if (!(_entry_mode & 0x04))
+  {
+    if (_xc == (x_inc ? _xe : _xs)) { _xc = x_inc ? _xs : _xe; x_done = true; }
+    else _xc += x_inc ? 1 : -1;
+    if (x_done)
+    {
+      if (_yc == (y_inc ? _ye : _ys)) _yc = y_inc ? _ys : _ye;
+      else _yc += y_inc ? 1 : -1;
+    }
+  }
+  else
+  {
+    if (_yc == (y_inc ? _ye : _ys)) { _yc = y_inc ? _ys : _ye; y_done = true; }
+    else _yc += y_inc ? 1 : -1;
+    if (y_done)
+    {
+      if (_xc == (x_inc ? _xe : _xs)) _xc = x_inc ? _xs : _xe;
+      else _xc += x_inc ? 1 : -1;
+    }
+  }
+}
+
+uint16_t SimPanel::_lutFrames() const
+{
+  uint16_t frames = 0;
+  for (uint8_t i = 20; i < 30; i++) frames += (_lut[i] & 0x0F) + (_lut[i] >> 4);
+  return frames;
+}
+
+// 0x22的位：0x80开时钟，0x40开模拟电路，0x04显示（按LUT驱动），0x02关模拟电路，0x01关时钟
+void SimPanel::_activate(uint64_t t)
+{
+  uint32_t duration = 0;
+  uint8_t ctrl = _update_ctrl;
+  if ((ctrl & 0x40) && !_powered)
+  {
+    _powered = true;
+    duration += timing.power_on_us;
+  }
+  if (ctrl & 0x04)
+  {
+    uint16_t frames = _lut_loaded ? _lutFrames() : FULL_LUT_FRAMES;
+    bool partial = frames < (FULL_LUT_FRAMES + PARTIAL_LUT_FRAMES) / 2;
+    uint32_t refresh = partial ? uint64_t(timing.partial_us) * frames / PARTIAL_LUT_FRAMES
+                               : uint64_t(timing.full_us) * frames / FULL_LUT_FRAMES;
+    _display(t + duration, refresh, partial);
+    duration += refresh;
+  }
+  if ((ctrl & 0x02) && _powered)
+  {
+    _powered = false;
+    duration += timing.power_off_us;
+  }
+  if (!duration) return;
+  _busy_us += duration;
+  _busy_until = (_busy_until > t ? _busy_until : t) + duration;
+  simSetInput(_busy, 1);
+  simSchedule(_busy_until, _busyDone, this, ++_busy_seq);
+}
+
+void SimPanel::_display(uint64_t t, uint32_t duration_us, bool partial)
+{
+  uint32_t changed = 0;
+  for (uint16_t y = 0; y < HEIGHT; y++)
+    for (uint16_t x = 0; x < WIDTH / 8; x++) changed += __builtin_popcount(_screen[y][x] ^ _ram[y][x]);
+  memcpy(_screen, _ram, sizeof(_screen));
+  uint32_t n = _refresh_full + _refresh_partial;
+  if (partial) _refresh_partial++;
+  else _refresh_full++;
+
+  char name[32] = "";
+  if (timing.png)
+  {
+    // 按固件的旋转方向转正：与GxEPD2_BW::drawPixel()相同的坐标映射
+    const uint16_t w = timing.rotation & 1 ? HEIGHT : WIDTH, h = timing.rotation & 1 ? WIDTH : HEIGHT;
+    static uint8_t image[WIDTH * HEIGHT / 8 + HEIGHT];
+    const uint16_t wb = (w + 7) / 8;
+    memset(image, 0, sizeof(image));
+    for (uint16_t ly = 0; ly < h; ly++)
+    {
+      for (uint16_t lx = 0; lx < w; lx++)
+      {
+        uint16_t px = lx, py = ly;
+        switch (timing.rotation)
+        {
+          case 1: px = WIDTH - 1 - ly; py = lx; break;
+          case 2: px = WIDTH - 1 - lx; py = HEIGHT - 1 - ly; break;
+          case 3: px = ly; py = HEIGHT - 1 - lx; break;
+        }
+        if (_screen[py][px / 8] & (0x80 >> (px % 8))) image[ly * wb + lx / 8] |= 0x80 >> (lx % 8);
+      }
+    }
+    char file[40], path[512];
+    snprintf(name, sizeof(name), "refresh_%04u.png", (unsigned)n);
+    if (multiPanel) snprintf(file, sizeof(file), "p%u_%s", _index, name);
+    else snprintf(file, sizeof(file), "%s", name);
+    if (!simWritePng(simOutPath(path, sizeof(path), file), image, w, h, wb)) name[0] = 0;
+  }
+  if (_refreshes)
+  {
+    fprintf(_refreshes, "%u,%llu,%lu,%s,%u,%lu,%lu,%s\n", (unsigned)n, (unsigned long long)t, (unsigned long)duration_us,
+            partial ? "partial" : "full", _lut_loaded ? _lutFrames() : FULL_LUT_FRAMES,
+            (unsigned long)_bytes_since_refresh, (unsigned long)changed, name);
+  }
+  _bytes_since_refresh = 0;
+}
+
+void SimPanel::_busyDone(void* arg, uint32_t tag)
+{
+  SimPanel* p = (SimPanel*)arg;
+  // 之后又有新的刷新排在后面时，由最后一个事件释放BUSY
+  if (tag == p->_busy_seq) simSetInput(p->_busy, 0);
+}
+
+void SimPanel::summaryAll(FILE* out, bool json)
+{
+  for (uint8_t i = 0; i < panelCount; i++)
+  {
+    SimPanel* p = panels[i];
+    if (p->_stream) fprintf(p->_stream, "\n");
+    if (p->_stream) fflush(p->_stream);
+    if (p->_refreshes) fflush(p->_refreshes);
+    if (json)
+    {
+      fprintf(out, "%s{\"panel\":%u,\"commands\":%lu,\"data_bytes\":%lu,\"ignored\":%lu,\"refresh_full\":%lu,\"refresh_partial\":%lu,\"busy_us\":%llu}",
+              i ? "," : "", i, (unsigned long)p->_commands, (unsigned long)p->_data_bytes, (unsigned long)p->_ignored,
+              (unsigned long)p->_refresh_full, (unsigned long)p->_refresh_partial, (unsigned long long)p->_busy_us);
+    }
+    else
+    {
+      fprintf(out, "sim: 面板%u：命令%lu个，数据%lu字节，全刷%lu次，局刷%lu次，BUSY %.3fs\n", i, (unsigned long)p->_commands,
+              (unsigned long)p->_data_bytes, (unsigned long)p->_refresh_full, (unsigned long)p->_refresh_partial, p->_busy_us / 1e6);
+    }
+  }
+}
+
+void SimPanel::saveScreens()
+{
+  for (uint8_t i = 0; i < panelCount; i++)
+  {
+    FILE* f = panels[i]->_open("screen.bin", "wb");
+    if (!f) continue;
+    fwrite(panels[i]->_screen, sizeof(panels[i]->_screen), 1, f);
+    fclose(f);
+  }
+}
+
+bool SimPanel::saveAll(FILE* f)
+{
+  bool ok = fwrite(&panelCount, sizeof(panelCount), 1, f) == 1;
+  for (uint8_t i = 0; ok && (i < panelCount); i++)
+  {
+    SimPanel* p = panels[i];
+    if (p->_stream) fflush(p->_stream);
+    if (p->_refreshes) fflush(p->_refreshes);
+    ok = (fwrite(p->_ram, sizeof(p->_ram), 1, f) == 1) && (fwrite(p->_screen, sizeof(p->_screen), 1, f) == 1) &&
+         (fwrite(&p->_sleeping, sizeof(p->_sleeping), 1, f) == 1) && (fwrite(&p->_commands, sizeof(uint32_t), 1, f) == 1) &&
+         (fwrite(&p->_data_bytes, sizeof(uint32_t), 1, f) == 1) && (fwrite(&p->_ignored, sizeof(uint32_t), 1, f) == 1) &&
+         (fwrite(&p->_refresh_full, sizeof(uint32_t), 1, f) == 1) && (fwrite(&p->_refresh_partial, sizeof(uint32_t), 1, f) == 1) &&
+         (fwrite(&p->_bytes_since_refresh, sizeof(uint32_t), 1, f) == 1) && (fwrite(&p->_busy_us, sizeof(uint64_t), 1, f) == 1);
+  }
+  return ok;
+}
+
+bool SimPanel::loadAll(FILE* f)
+{
+  uint8_t n = 0;
+  if ((fread(&n, sizeof(n), 1, f) != 1) || (n != panelCount)) return false;
+  bool ok = true;
+  for (uint8_t i = 0; ok && (i < panelCount); i++)
+  {
+    SimPanel* p = panels[i];
+    ok = (fread(p->_ram, sizeof(p->_ram), 1, f) == 1) && (fread(p->_screen, sizeof(p->_screen), 1, f) == 1) &&
+         (fread(&p->_sleeping, sizeof(p->_sleeping), 1, f) == 1) && (fread(&p->_commands, sizeof(uint32_t), 1, f) == 1) &&
+         (fread(&p->_data_bytes, sizeof(uint32_t), 1, f) == 1) && (fread(&p->_ignored, sizeof(uint32_t), 1, f) == 1) &&
+         (fread(&p->_refresh_full, sizeof(uint32_t), 1, f) == 1) && (fread(&p->_refresh_partial, sizeof(uint32_t), 1, f) == 1) &&
+         (fread(&p->_bytes_since_refresh, sizeof(uint32_t), 1, f) == 1) && (fread(&p->_busy_us, sizeof(uint64_t), 1, f) == 1);
+  }
+  return ok;
+}
@@ -0,0 +1,92 @@
+// ssd1608_model.h
+// SSD1608（GDEH029A1）控制器模型：解码命令/数据字节流，维护RAM、地址计数器与LUT，
+// 刷新时把RAM复制到“屏幕”并写出PNG，BUSY按时序模型拉高
+#ifndef SIM_SSD1608_MODEL_H
+#define SIM_SSD1608_MODEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * 时序模型（环境变量，单位ms）：
+ *   EPD_SIM_PARTIAL_MS  局部刷新（GxEPD2_290默认局部LUT）耗时，默认300
+ *   EPD_SIM_FULL_MS     全刷（默认全刷LUT或未加载LUT）耗时，默认2000
+ *   EPD_SIM_POWER_ON_MS / EPD_SIM_POWER_OFF_MS  升压电路开/关，默认100/150
+ * 其他LUT按帧数（TP字节各半字节之和）相对同类默认LUT折算，帧数少于两者中点的归为局部刷新。
+ * 输出（EPD_SIM_OUT目录）：stream.log命令/数据字节流（EPD_SIM_STREAM=0关闭），
+ * refreshes.csv每次刷新一行，refresh_NNNN.png刷新后的屏幕（EPD_SIM_PNG=0关闭，
+ * EPD_SIM_PNG_ROTATION按setRotation()的方向转正，默认1）。多块面板时文件名加pN_前缀。
+ * 深睡眠唤醒重新启动进程（EPD_SIM_WAKEUPS）后，输出文件接着追加，刷新序号也接着计数。
+ * 重新上电：EPD_SIM_POWER_CYCLE=1时屏幕沿用上一次运行结束时的内容（screen.bin，电子纸断电后画面保留），
+ * 控制器RAM为随机内容。
+ */
+class SimPanel
+{
+  public:
+    static const uint16_t WIDTH = 128;
+    static const uint16_t HEIGHT = 296;
+    static const uint8_t MAX_PANELS = 4;
+
+    // 按EPD_SIM_PANELS（"cs:dc:rst:busy[,...]"，默认"15:27:26:25"，与main.cpp的接线相同）创建面板
+    static void setupAll();
+    static uint8_t count();
+    static SimPanel* at(uint8_t i);
+    static SimPanel* byCs(int pin);
+    // 每个面板的DC引脚当前电平即为该字节的命令/数据标志
+    static void spiByteAll(uint8_t b, uint64_t t);
+    static void gpioWritten(uint8_t pin, uint8_t level);
+    static void summaryAll(FILE* out, bool json);
+    // 结束时保存各面板的屏幕内容，供下一次以EPD_SIM_POWER_CYCLE=1运行时接着显示
+    static void saveScreens();
+    // 深睡眠前保存/唤醒后恢复RAM、屏幕与统计（模拟进程重新启动，面板保持供电）
+    static bool saveAll(FILE* f);
+    static bool loadAll(FILE* f);
+
+    void spiByte(uint8_t b, uint64_t t);
+
+    // 屏幕上的像素（最近一次刷新后的画面，面板物理坐标，true为白）、刷新次数与完整写入LUT的次数，供test/中的用例检查
+    bool screenWhite(uint16_t x, uint16_t y) const { return _screen[y][x / 8] & (0x80 >> (x % 8)); }
+    uint32_t fullRefreshes() const { return _refresh_full; }
+    uint32_t partialRefreshes() const { return _refresh_partial; }
+    uint32_t lutWrites() const { return _lut_writes; }
+
+  private:
+    SimPanel(uint8_t index, int cs, int dc, int rst, int busy);
+    void _reset();
+    void _command(uint8_t c, uint64_t t);
+    void _param(uint8_t d, uint64_t t);
+    void _ramWrite(uint8_t d);
+    void _activate(uint64_t t);
+    void _display(uint64_t t, uint32_t duration_us, bool partial);
+    void _log(bool dc, uint8_t b, uint64_t t);
+    uint16_t _lutFrames() const;
+    static void _busyDone(void* arg, uint32_t tag);
+    FILE* _open(const char* name, const char* mode);
+
+    uint8_t _index;
+    int _cs, _dc, _rst, _busy;
+    uint8_t _ram[HEIGHT][WIDTH / 8];
+    uint8_t _screen[HEIGHT][WIDTH / 8];
+    uint8_t _cmd;
+    uint16_t _nparam;
+    uint8_t _params[32];
+    uint8_t _lut[30];
+    bool _lut_loaded;
+    uint8_t _entry_mode, _update_ctrl;
+    uint8_t _xs, _xe, _xc;
+    uint16_t _ys, _ye, _yc;
+    bool _powered, _sleeping;
+    uint64_t _busy_until;
+    uint32_t _busy_seq;
+    // 统计
+    uint32_t _commands, _data_bytes, _ignored, _refresh_full, _refresh_partial;
+    uint32_t _lut_writes;
+    uint32_t _bytes_since_refresh;
+    uint64_t _busy_us;
+    // 字节流日志
+    FILE* _stream;
+    FILE* _refreshes;
+    int _stream_run;
+};
+
+#endif
@@ -0,0 +1,32 @@
+// boot_profiler.cpp
+// 启动计时实现
+#include "boot_profiler.h"
+
+BootProfiler::BootProfiler() :
+  _count(0)
+{
+}
+
+void BootProfiler::mark(const char* name)
+{
+  if ((_count >= BOOT_PROFILER_MAX) || at(name)) return;
+  _names[_count] = name;
+  _us[_count] = micros();
+  _count++;
+}
+
+uint32_t BootProfiler::at(const char* name) const
+{
+  for (uint8_t i = 0; i < _count; i++)
+    if (strcmp(_names[i], name) == 0) return _us[i];
+  return 0;
+}
+
+void BootProfiler::report(Print& out) const
+{
+  out.println("boot,milestone,us,delta_us");
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    out.printf("boot,%s,%lu,%lu\n", _names[i], (unsigned long)_us[i], (unsigned long)(i ? _us[i] - _us[i - 1] : _us[i]));
+  }
+}
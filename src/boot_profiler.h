@@ -0,0 +1,31 @@
+// boot_profiler.h
+// 启动计时：记录从复位到各个里程碑（SPI就绪、控制器就绪、第一帧可见等）的时间，经串口输出
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+
+#define BOOT_PROFILER_MAX 12   // 最多记录的里程碑数
+
+/**
+ * 时间取micros()：ESP32上从应用启动（esp_timer初始化）起计时，ROM与二级引导程序的时间不在其中（通常几十到几百ms）。
+ * report()每个里程碑输出一行CSV：boot,<名称>,<距复位μs>,<距上一个里程碑μs>
+ */
+class BootProfiler
+{
+  public:
+    BootProfiler();
+
+    // 记录一个里程碑，name须为常量字符串；重复的名称只记第一次
+    void mark(const char* name);
+    // 某个里程碑的时间，没有记录过返回0
+    uint32_t at(const char* name) const;
+    void report(Print& out) const;
+
+  private:
+    const char* _names[BOOT_PROFILER_MAX];
+    uint32_t _us[BOOT_PROFILER_MAX];
+    uint8_t _count;
+};
+
+#endif
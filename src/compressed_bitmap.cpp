@@ -0,0 +1,129 @@
+// compressed_bitmap.cpp
+// 压缩位图解码实现
+#include "compressed_bitmap.h"
+
+void CbmStream::read(uint8_t* out, uint16_t n)
+{
+  while (n > 0)
+  {
+    if (repeat)
+    {
+      uint8_t k = repeat < n ? repeat : n;
+      memset(out, value, k);
+      out += k;
+      n -= k;
+      repeat -= k;
+    }
+    else if (literal)
+    {
+      uint8_t k = literal < n ? literal : n;
+      memcpy_P(out, p, k);
+      p += k;
+      out += k;
+      n -= k;
+      literal -= k;
+    }
+    else
+    {
+      uint8_t c = pgm_read_byte(p++);
+      if (c < 128)
+      {
+        literal = c + 1;
+      }
+      else
+      {
+        repeat = c - 125;
+        value = pgm_read_byte(p++);
+      }
+    }
+  }
+}
+
+static uint16_t readU16(const uint8_t* p)
+{
+  return pgm_read_byte(p) | (uint16_t(pgm_read_byte(p + 1)) << 8);
+}
+
+bool compressedBitmapSize(const uint8_t* asset, uint16_t* w, uint16_t* h)
+{
+  if ((pgm_read_byte(asset) != 'C') || (pgm_read_byte(asset + 1) != 'B')) return false;
+  *w = readU16(asset + 2);
+  *h = readU16(asset + 4);
+  return (*w + 7) / 8 <= CBM_MAX_ROW_BYTES;
+}
+
+void drawCompressedBitmap(EpdDisplay& gfx, int16_t x, int16_t y, const uint8_t* asset, uint16_t color)
+{
+  uint16_t w, h;
+  if (!compressedBitmapSize(asset, &w, &h)) return;
+  if (gfx.isRecording())
+  {
+    gfx.markDirty(x, y, w, h); // 整块记录，不解码
+    return;
+  }
+
+  // 与当前页相交的行列范围（位图内坐标）
+  DirtyRect clip = gfx.pageRect();
+  int16_t r0 = clip.y - y > 0 ? clip.y - y : 0;
+  int16_t r1 = clip.bottom() - y < int16_t(h) ? clip.bottom() - y : h;
+  int16_t c0 = clip.x - x > 0 ? clip.x - x : 0;
+  int16_t c1 = clip.right() - x < int16_t(w) ? clip.right() - x : w;
+  if ((r0 >= r1) || (c0 >= c1)) return;
+
+  // 从r0所在组的起点开始解码，组内r0之前的行只解码不绘制
+  uint8_t group_rows = pgm_read_byte(asset + 6);
+  uint16_t groups = (h + group_rows - 1) / group_rows;
+  const uint8_t* data = asset + CBM_HEADER_SIZE + 2 * groups;
+  uint16_t g = r0 / group_rows;
+  CbmStream s = { data + readU16(asset + CBM_HEADER_SIZE + 2 * g), 0, 0, 0 };
+
+  uint8_t row[CBM_MAX_ROW_BYTES];
+  uint16_t wb = (w + 7) / 8;
+  for (int16_t r = g * group_rows; r < r1; r++)
+  {
+    s.read(row, wb);
+    if (r < r0) continue;
+    // 全0字节整体跳过，连续的1合并为一条水平线
+    int16_t run = -1;
+    for (int16_t c = c0; c < c1; c++)
+    {
+      uint8_t b = row[c >> 3];
+      if ((b == 0) && ((c & 7) == 0) && (run < 0) && (c + 8 <= c1))
+      {
+        c += 7;
+        continue;
+      }
+      bool on = b & (0x80 >> (c & 7));
+      if (on && (run < 0)) run = c;
+      else if (!on && (run >= 0))
+      {
+        gfx.drawFastHLine(x + run, y + r, c - run, color);
+        run = -1;
+      }
+    }
+    if (run >= 0) gfx.drawFastHLine(x + run, y + r, c1 - run, color);
+  }
+}
+
+bool compressedBitmapRowSource(uint8_t* row, int16_t y, void* ctx)
+{
+  CompressedBitmapSource* src = (CompressedBitmapSource*)ctx;
+  uint16_t w, h;
+  if (!compressedBitmapSize(src->asset, &w, &h)) return false;
+  uint16_t groups = (h + pgm_read_byte(src->asset + 6) - 1) / pgm_read_byte(src->asset + 6);
+  if (y == 0)
+  {
+    // 每一遍从头开始解码
+    src->stream.p = src->asset + CBM_HEADER_SIZE + 2 * groups + readU16(src->asset + CBM_HEADER_SIZE);
+    src->stream.literal = src->stream.repeat = 0;
+  }
+  int16_t wb = (display.width() + 7) / 8;
+  memset(row, 0, wb);
+  if (y >= int16_t(h)) return true;
+  // 位图比屏幕宽时多出的部分解码后丢弃
+  uint8_t tmp[CBM_MAX_ROW_BYTES];
+  uint16_t bwb = (w + 7) / 8;
+  src->stream.read(tmp, bwb);
+  memcpy(row, tmp, bwb < uint16_t(wb) ? bwb : wb);
+  return true;
+}
@@ -0,0 +1,48 @@
+// compressed_bitmap.h
+// 压缩位图：PackBits风格的行程编码，按行组建立索引，分页绘制时只解码当前页覆盖的行，
+// 解码暂存区只有一行。资源由tools/img2epd.py --compress生成
+//
+// 格式（多字节字段为小端）：
+//   0  'C' 'B'            魔数
+//   2  uint16 width
+//   4  uint16 height
+//   6  uint8  group_rows  每组行数，每组的编码流独立，可以从组起点开始解码
+//   7  uint8  0           保留
+//   8  uint16 offset[(height + group_rows - 1) / group_rows]  各组相对数据区起点的偏移
+//   .. 数据区：每行(width + 7) / 8字节（MSB在左，1为前景色）按行连续编码，
+//      控制字节c < 128：其后c + 1个字节原样复制；c >= 128：下一个字节重复c - 125次（3~130）
+#ifndef COMPRESSED_BITMAP_H
+#define COMPRESSED_BITMAP_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+
+#define CBM_HEADER_SIZE 8
+#define CBM_MAX_ROW_BYTES 64   // 解码暂存区（一行），位图最宽512像素
+
+// 行程编码流的解码状态（控制字节可以跨行）
+struct CbmStream
+{
+  const uint8_t* p;
+  uint8_t literal;   // 剩余原样复制的字节数
+  uint8_t repeat;    // 剩余重复次数
+  uint8_t value;
+
+  void read(uint8_t* out, uint16_t n);
+};
+
+// 读取尺寸；不是压缩位图或超出暂存区宽度时返回false
+bool compressedBitmapSize(const uint8_t* asset, uint16_t* w, uint16_t* h);
+
+// 以(x, y)为左上角绘制（透明背景，只画1的像素），只解码当前页与位图相交的行
+void drawCompressedBitmap(EpdDisplay& gfx, int16_t x, int16_t y, const uint8_t* asset, uint16_t color);
+
+// 流式绘制（EpdDisplay::streamFrame()）的行源：位图放在左上角，其余部分为白
+struct CompressedBitmapSource
+{
+  const uint8_t* asset;
+  CbmStream stream;
+};
+bool compressedBitmapRowSource(uint8_t* row, int16_t y, void* ctx);
+
+#endif
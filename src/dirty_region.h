@@ -0,0 +1,90 @@
+// dirty_region.h
+// 脏矩形累加器：记录一次更新中所有绘图调用覆盖的区域（物理坐标，未旋转）
+#ifndef DIRTY_REGION_H
+#define DIRTY_REGION_H
+
+#include <Arduino.h>
+
+// 矩形（x, y为左上角；w或h<=0表示空矩形）
+struct DirtyRect
+{
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+
+  bool isEmpty() const { return (w <= 0) || (h <= 0); }
+  int16_t right() const { return x + w; }   // 右边界（不含）
+  int16_t bottom() const { return y + h; }  // 下边界（不含）
+  bool intersects(const DirtyRect& o) const
+  {
+    return !isEmpty() && !o.isEmpty() && (x < o.right()) && (o.x < right()) && (y < o.bottom()) && (o.y < bottom());
+  }
+};
+
+class DirtyRegion
+{
+  public:
+    DirtyRegion() { clear(); }
+
+    void clear()
+    {
+      _bounds.x = _bounds.y = _bounds.w = _bounds.h = 0;
+    }
+
+    // 合并一个矩形到当前并集（外接矩形）
+    void add(int16_t x, int16_t y, int16_t w, int16_t h)
+    {
+      if ((w <= 0) || (h <= 0)) return;
+      if (_bounds.isEmpty())
+      {
+        _bounds.x = x; _bounds.y = y; _bounds.w = w; _bounds.h = h;
+        return;
+      }
+      int16_t x1 = x < _bounds.x ? x : _bounds.x;
+      int16_t y1 = y < _bounds.y ? y : _bounds.y;
+      int16_t x2 = x + w > _bounds.right() ? x + w : _bounds.right();
+      int16_t y2 = y + h > _bounds.bottom() ? y + h : _bounds.bottom();
+      _bounds.x = x1; _bounds.y = y1; _bounds.w = x2 - x1; _bounds.h = y2 - y1;
+    }
+
+    void add(const DirtyRect& r) { add(r.x, r.y, r.w, r.h); }
+
+    // 单点（drawPixel）合并的快速路径
+    void addPixel(int16_t x, int16_t y)
+    {
+      if (_bounds.isEmpty())
+      {
+        _bounds.x = x; _bounds.y = y; _bounds.w = 1; _bounds.h = 1;
+        return;
+      }
+      if (x < _bounds.x) { _bounds.w += _bounds.x - x; _bounds.x = x; }
+      else if (x >= _bounds.right()) _bounds.w = x - _bounds.x + 1;
+      if (y < _bounds.y) { _bounds.h += _bounds.y - y; _bounds.y = y; }
+      else if (y >= _bounds.bottom()) _bounds.h = y - _bounds.y + 1;
+    }
+
+    bool isEmpty() const { return _bounds.isEmpty(); }
+    const DirtyRect& bounds() const { return _bounds; }
+
+    // 按SSD1608的RAM字节对齐扩展：物理x方向对齐到8像素，并裁剪到面板范围
+    static DirtyRect snapToByteAlignment(DirtyRect r, int16_t panel_w, int16_t panel_h)
+    {
+      int16_t x1 = r.x < 0 ? 0 : r.x;
+      int16_t y1 = r.y < 0 ? 0 : r.y;
+      int16_t x2 = r.right() > panel_w ? panel_w : r.right();
+      int16_t y2 = r.bottom() > panel_h ? panel_h : r.bottom();
+      x1 &= ~7;
+      x2 = (x2 + 7) & ~7;
+      if (x2 > panel_w) x2 = panel_w;
+      DirtyRect s = { x1, y1, int16_t(x2 - x1), int16_t(y2 - y1) };
+      if (s.w < 0) s.w = 0;
+      if (s.h < 0) s.h = 0;
+      return s;
+    }
+
+  private:
+    DirtyRect _bounds;
+};
+
+#endif
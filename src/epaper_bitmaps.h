@@ -3,92 +3,46 @@
 #define EPAPER_BITMAPS_H
 
 
-#include <GxEPD2_BW.h>
-#include <GxEPD2_3C.h>
+#include "epd_display.h"
+#include "compressed_bitmap.h"
 
-#if defined(ESP32)
-  #define MAX_DISPLAY_BUFFER_SIZE 65536ul
-  #if IS_GxEPD2_BW(GxEPD2_DISPLAY_CLASS)
-    #define MAX_HEIGHT(EPD) (EPD::HEIGHT <= MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8) ? EPD::HEIGHT : MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8))
-  #endif
-
-  // ¶DisplayTypeȷͷļʶͣ
-  typedef GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> DisplayType;
-#endif
-
-extern DisplayType display;
-
-// Bitmap: input_imgs/rgb_cam_1758806792.png (296x128)
-const unsigned char rgb_cam_1758806792_png[] PROGMEM = {
-  0X00,0X01,0X39,0X00,0X80,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X0C,0X00,0X00,0X00,0X11,0X02,0X80,0X00,
-0X30,0X00,0X00,0X00,0X00,0X9E,0XB0,0X00,0X38,0X00,0X00,0X00,0X00,0X3F,0X38,0X00,
-0X38,0X00,0X00,0X00,0X00,0X3B,0XB8,0X00,0X3B,0XFE,0X9F,0X1F,0X1E,0X1B,0XB8,0X00,
-0X3B,0XFF,0XBF,0X3F,0XBF,0X07,0XB8,0X00,0X3B,0XBB,0X9F,0XBB,0XBF,0X8F,0X38,0X00,
-0X3B,0XBB,0X9F,0XBB,0XBF,0X9E,0X38,0X00,0X3B,0XBB,0XBF,0XBB,0XB8,0X3C,0X38,0X00,
-0X3B,0XBB,0XBB,0XBB,0XBB,0X38,0X38,0X00,0X3B,0XBB,0X9F,0X9F,0X9F,0XBF,0X3F,0X80,
-0X19,0X99,0X8F,0X8F,0X8F,0XFF,0X9F,0X80,0X06,0X5E,0X20,0XF3,0X8E,0XF8,0X01,0X00,
-0X00,0X00,0X00,0X1F,0X8E,0XF8,0X20,0X00,0X00,0X00,0X00,0X0F,0X07,0XF0,0X02,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X02,0X00,0X00,0X00,
-0X00,0X00,0X40,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X80,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X80,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X70,0X00,0X00,
-0X00,0X01,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X06,0X81,0X00,0X00,0X00,0X00,0X00,
-0X00,0X40,0XC1,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X10,0X18,0X00,0X00,0X08,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X0E,0X00,0X00,0X01,0XC0,0X00,0X00,0X00,0X04,0X18,0X20,0X00,0X82,0X40,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X0C,0X03,0XD1,0XA8,0XC0,0X00,0X00,0X00,0X04,0X22,0X41,0X65,0XC4,0X10,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X05,0X80,0X00,0X00,0X00,0X00,0X00,0X00,0X1C,0X4A,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X01,0X44,0X00,0X82,0X00,0X00,
-0X00,0X00,0X00,0X04,0X00,0X04,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X1F,0XF0,0XC0,0X00,0X00,0X00,0X00,0X00,0X17,0XE0,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X3F,0XFF,0XF8,0X03,0XC0,0X00,0X00,0X00,0X7D,0X51,0XB8,0X02,0X00,0X00,0X00,
-0X00,0X3F,0XFF,0XF8,0X03,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X03,0X00,0X00,0X00,
-0X07,0XF0,0X15,0XF6,0X83,0X06,0X00,0X00,0X01,0X52,0X42,0XEE,0XC3,0X06,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X04,0X00,0X08,0X00,0X00,0X00,0X00,0XB5,0X7F,0X5E,0XF7,0XFB,0X80,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X01,0X7C,0X00,
-0X08,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X06,0X20,0X04,0X05,0X02,0X6A,0X00,0X00,
-0X00,0X33,0X25,0X01,0X0A,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X00,0X00,0X85,0X20,0X64,0X80,0X00,0X00,0X00,0X00,0X80,0X0B,0X83,0X90,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X10,0X00,0X01,0XC9,0XC0,0X00,0X00,0X00,
-0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
-0X1F,0X40,0X80,0X09,0X05,0X00,0X00,0X00,0X1F,0XFF,0X80,0X00,0X00,0X00,0X00,0X00,
+// Bitmap: input_imgs/rgb_cam_1758806792.png (57x128)
+// ԭת6ֽͷɨ跽ʽλ57128ȥ
+// ѹλͼʽţcompressed_bitmap.hԭʼ1024ֽ -> 408ֽڣͼƬtools/img2epd.py --compressת
+#define RGB_CAM_1758806792_PNG_WIDTH 57
+#define RGB_CAM_1758806792_PNG_HEIGHT 128
+const unsigned char rgb_cam_1758806792_png[408] PROGMEM = {
+0X43,0X42,0X39,0X00,0X80,0X00,0X08,0X00,0X00,0X00,0X28,0X00,0X68,0X00,0X78,0X00,
+0X7A,0X00,0X8C,0X00,0X9B,0X00,0XA1,0X00,0XAB,0X00,0XBE,0X00,0XD9,0X00,0XDB,0X00,
+0XEA,0X00,0X20,0X01,0X31,0X01,0X4A,0X01,0X95,0X00,0X00,0X0C,0X80,0X00,0X04,0X11,
+0X02,0X80,0X00,0X30,0X81,0X00,0X03,0X9E,0XB0,0X00,0X38,0X81,0X00,0X03,0X3F,0X38,
+0X00,0X38,0X81,0X00,0X0A,0X3B,0XB8,0X00,0X3B,0XFE,0X9F,0X1F,0X1E,0X1B,0XB8,0X00,
+0X20,0X3B,0XFF,0XBF,0X3F,0XBF,0X07,0XB8,0X00,0X3B,0XBB,0X9F,0XBB,0XBF,0X8F,0X38,
+0X00,0X3B,0XBB,0X9F,0XBB,0XBF,0X9E,0X38,0X00,0X3B,0XBB,0XBF,0XBB,0XB8,0X3C,0X38,
+0X00,0X3B,0X81,0XBB,0X04,0X38,0X38,0X00,0X3B,0XBB,0X80,0X9F,0X04,0XBF,0X3F,0X80,
+0X19,0X99,0X80,0X8F,0X0A,0XFF,0X9F,0X80,0X06,0X5E,0X20,0XF3,0X8E,0XF8,0X01,0X00,
+0X80,0X00,0X03,0X1F,0X8E,0XF8,0X20,0X81,0X00,0X03,0X0F,0X07,0XF0,0X02,0XAE,0X00,
+0XBD,0X00,0X99,0X00,0X00,0X02,0X82,0X00,0X00,0X40,0X84,0X00,0X00,0X80,0X84,0X00,
+0X00,0X80,0X8A,0X00,0X8A,0X00,0X00,0X70,0X80,0X00,0X00,0X01,0XA4,0X00,0X01,0X06,
+0X81,0X82,0X00,0X02,0X00,0X40,0XC1,0XBA,0X00,0XA5,0X00,0X04,0X10,0X18,0X00,0X00,
+0X08,0X90,0X00,0X8D,0X00,0X04,0X0E,0X00,0X00,0X01,0XC0,0X80,0X00,0X05,0X04,0X18,
+0X20,0X00,0X82,0X40,0X9F,0X00,0X04,0X0C,0X03,0XD1,0XA8,0XC0,0X80,0X00,0X05,0X04,
+0X22,0X41,0X65,0XC4,0X10,0X9F,0X00,0X01,0X05,0X80,0X83,0X00,0X01,0X1C,0X4A,0X83,
+0X00,0XBD,0X00,0X97,0X00,0X03,0X01,0X44,0X00,0X82,0X82,0X00,0X02,0X04,0X00,0X04,
+0X97,0X00,0X02,0X1F,0XF0,0XC0,0X82,0X00,0X01,0X17,0XE0,0X84,0X00,0X04,0X3F,0XFF,
+0XF8,0X03,0XC0,0X80,0X00,0X03,0X7D,0X51,0XB8,0X02,0X81,0X00,0X03,0X3F,0XFF,0XF8,
+0X03,0X84,0X00,0X00,0X03,0X80,0X00,0X0F,0X07,0XF0,0X15,0XF6,0X83,0X06,0X00,0X00,
+0X01,0X52,0X42,0XEE,0XC3,0X06,0X00,0X00,0X9F,0X00,0X02,0X04,0X00,0X08,0X81,0X00,
+0X05,0XB5,0X7F,0X5E,0XF7,0XFB,0X80,0X8E,0X00,0X9A,0X00,0X03,0X01,0X7C,0X00,0X08,
+0X84,0X00,0X05,0X06,0X20,0X04,0X05,0X02,0X6A,0X80,0X00,0X03,0X33,0X25,0X01,0X0A,
+0X88,0X00,0X05,0X00,0X00,0X85,0X20,0X64,0X80,0X81,0X00,0X03,0X80,0X0B,0X83,0X90,
+0X87,0X00,0X04,0X10,0X00,0X01,0XC9,0XC0,0X90,0X00,0X04,0X1F,0X40,0X80,0X09,0X05,
+0X80,0X00,0X02,0X1F,0XFF,0X80,0X82,0X00,
 };
 // Function to draw this bitmap (x=0,y=0 is top-left corner)
+// ҳʱֻ뵱ǰҳǵ
 inline void draw_rgb_cam_1758806792_png() {
-  display.drawBitmap(0, 0, rgb_cam_1758806792_png, 296, 128, GxEPD_BLACK);
+  drawCompressedBitmap(display, 0, 0, rgb_cam_1758806792_png, GxEPD_BLACK);
 }
 
 #endif  // ͷļ
\ No newline at end of file
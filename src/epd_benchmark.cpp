@@ -0,0 +1,176 @@
+// epd_benchmark.cpp
+// 分阶段刷新基准测试实现
+#include "epd_benchmark.h"
+#include <algorithm>
+
+enum
+{
+  PHASE_RENDER,
+  PHASE_TRANSFER,
+  PHASE_BUSY,
+  PHASE_TOTAL,
+  PHASE_COUNT
+};
+static const char* const phaseNames[PHASE_COUNT] = { "render", "transfer", "busy", "total" };
+
+struct BenchBox
+{
+  int16_t x, y, w, h;
+  uint16_t color;
+};
+
+static void drawBenchBox(const void* pv)
+{
+  const BenchBox* b = (const BenchBox*)pv;
+  display.fillScreen(GxEPD_WHITE);
+  display.fillRect(b->x, b->y, b->w, b->h, b->color);
+}
+
+struct PhaseStats
+{
+  uint32_t min, p50, p95, p99, max, mean;
+};
+
+// 最近秩法求百分位（samples已排序）
+static uint32_t percentile(const uint32_t* samples, uint8_t n, uint8_t p)
+{
+  uint16_t rank = (uint16_t(p) * n + 99) / 100;
+  return samples[rank > 0 ? rank - 1 : 0];
+}
+
+static PhaseStats computeStats(uint32_t* samples, uint8_t n)
+{
+  std::sort(samples, samples + n);
+  uint64_t sum = 0;
+  for (uint8_t i = 0; i < n; i++) sum += samples[i];
+  PhaseStats s = { samples[0], percentile(samples, n, 50), percentile(samples, n, 95), percentile(samples, n, 99), samples[n - 1], uint32_t(sum / n) };
+  return s;
+}
+
+static void printJsonStats(Print& out, const char* name, const PhaseStats& s)
+{
+  out.printf("\"%s\":{\"min\":%lu,\"p50\":%lu,\"p95\":%lu,\"p99\":%lu,\"max\":%lu,\"mean\":%lu}", name,
+             (unsigned long)s.min, (unsigned long)s.p50, (unsigned long)s.p95, (unsigned long)s.p99, (unsigned long)s.max, (unsigned long)s.mean);
+}
+
+static void runCase(EpdDisplay& gfx, const EpdBenchConfig& config, uint16_t index, const BenchBox& box, uint8_t rotation, Print& out)
+{
+  static uint32_t samples[PHASE_COUNT][EPD_BENCH_MAX_SAMPLES];
+  uint8_t n = config.iterations < EPD_BENCH_MAX_SAMPLES ? config.iterations : EPD_BENCH_MAX_SAMPLES;
+  if (n == 0) return;
+  BenchBox b = box;
+  for (uint16_t i = 0; i < uint16_t(config.warmup) + n; i++)
+  {
+    b.color = i % 2 == 0 ? GxEPD_BLACK : GxEPD_WHITE;
+    gfx.epd2.resetPhaseTimes();
+    uint32_t t0 = micros();
+    gfx.updateDirty(drawBenchBox, &b);
+    uint32_t total = micros() - t0;
+    if (i < config.warmup) continue;
+    uint8_t k = i - config.warmup;
+    uint32_t transfer = gfx.epd2.transferMicros();
+    uint32_t busy = gfx.epd2.refreshMicros();
+    samples[PHASE_TRANSFER][k] = transfer;
+    samples[PHASE_BUSY][k] = busy;
+    samples[PHASE_TOTAL][k] = total;
+    // 其余时间都算渲染：记录遍、每页绘制、差分比较
+    samples[PHASE_RENDER][k] = total > transfer + busy ? total - transfer - busy : 0;
+  }
+
+  // 直方图在排序前后都一样，用排好序的总耗时算
+  const char* lut = epdLutInfo(gfx.epd2.lutProfile()).name;
+  PhaseStats stats[PHASE_COUNT];
+  for (uint8_t p = 0; p < PHASE_COUNT; p++) stats[p] = computeStats(samples[p], n);
+  uint16_t hist[EPD_BENCH_HIST_BINS] = { 0 };
+  uint32_t lo = stats[PHASE_TOTAL].min;
+  uint32_t step = (stats[PHASE_TOTAL].max - lo) / EPD_BENCH_HIST_BINS + 1;
+  for (uint8_t i = 0; i < n; i++) hist[(samples[PHASE_TOTAL][i] - lo) / step]++;
+
+  if (config.format & EPD_BENCH_CSV)
+  {
+    for (uint8_t p = 0; p < PHASE_COUNT; p++)
+    {
+      const PhaseStats& s = stats[p];
+      out.printf("bench,%u,%u,%s,%d,%d,%d,%d,%s,%u,%lu,%lu,%lu,%lu,%lu,%lu,", index, rotation, lut, box.x, box.y, box.w, box.h, phaseNames[p], n,
+                 (unsigned long)s.min, (unsigned long)s.p50, (unsigned long)s.p95, (unsigned long)s.p99, (unsigned long)s.max, (unsigned long)s.mean);
+      // 只有总耗时带直方图：起点、箱宽、各箱计数（空格分隔）
+      if (p == PHASE_TOTAL)
+      {
+        out.printf("%lu,%lu,", (unsigned long)lo, (unsigned long)step);
+        for (uint8_t j = 0; j < EPD_BENCH_HIST_BINS; j++) out.printf(j ? " %u" : "%u", hist[j]);
+        out.println();
+      }
+      else out.println(",,");
+    }
+  }
+  if (config.format & EPD_BENCH_JSON)
+  {
+    out.printf("{\"case\":%u,\"rotation\":%u,\"lut\":\"%s\",\"x\":%d,\"y\":%d,\"w\":%d,\"h\":%d,\"n\":%u,", index, rotation, lut, box.x, box.y, box.w, box.h, n);
+    for (uint8_t p = 0; p < PHASE_COUNT; p++)
+    {
+      printJsonStats(out, phaseNames[p], stats[p]);
+      out.print(',');
+    }
+    out.printf("\"hist\":{\"lo\":%lu,\"step\":%lu,\"counts\":[", (unsigned long)lo, (unsigned long)step);
+    for (uint8_t j = 0; j < EPD_BENCH_HIST_BINS; j++) out.printf(j ? ",%u" : "%u", hist[j]);
+    out.println("]}}");
+  }
+}
+
+void runRefreshBenchmark(EpdDisplay& gfx, const EpdBenchConfig& config, Print& out)
+{
+  uint8_t saved_rotation = gfx.getRotation();
+  EpdLutProfile saved_lut = gfx.epd2.lutProfile();
+  uint16_t index = 0;
+  if (config.format & EPD_BENCH_CSV)
+    out.println("bench,case,rotation,lut,x,y,w,h,phase,n,min_us,p50_us,p95_us,p99_us,max_us,mean_us,hist_lo_us,hist_step_us,hist_counts");
+  for (uint8_t l = 0; l < EPD_LUT_PROFILE_COUNT; l++)
+  {
+    if (config.lut_profiles && !(config.lut_profiles & (1 << l))) continue;
+    if (!config.lut_profiles && (l != saved_lut)) continue;
+    gfx.epd2.setLutProfile(EpdLutProfile(l));
+    for (uint8_t r = 0; r < 4; r++)
+    {
+      if (!(config.rotations & (1 << r))) continue;
+      gfx.setRotation(r);
+      for (uint8_t s = 0; s < config.size_count; s++)
+      {
+        BenchBox box = { 0, 0, config.sizes[s].w, config.sizes[s].h, GxEPD_BLACK };
+        if ((box.w > gfx.width()) || (box.h > gfx.height())) continue;
+        for (uint8_t pos = 0; pos < 3; pos++)
+        {
+          if (!(config.positions & (1 << pos))) continue;
+          // 位置按8对齐，方块边缘不跨字节，窗口大小只由方块尺寸决定
+          switch (1 << pos)
+          {
+            case EPD_BENCH_TOP_LEFT:
+              box.x = box.y = 0;
+              break;
+            case EPD_BENCH_CENTER:
+              box.x = ((gfx.width() - box.w) / 2) & ~7;
+              box.y = ((gfx.height() - box.h) / 2) & ~7;
+              break;
+            case EPD_BENCH_BOTTOM_RIGHT:
+              box.x = (gfx.width() - box.w) & ~7;
+              box.y = (gfx.height() - box.h) & ~7;
+              break;
+          }
+          runCase(gfx, config, index++, box, r, out);
+        }
+      }
+    }
+  }
+  // 各档位的实测刷新时间（驱动记录的滑动平均）与标称值
+  if (config.lut_profiles && (config.format & EPD_BENCH_CSV)) out.println("lut,name,frames,nominal_ms,refresh_us");
+  for (uint8_t l = 0; config.lut_profiles && (l < EPD_LUT_PROFILE_COUNT); l++)
+  {
+    if (!(config.lut_profiles & (1 << l))) continue;
+    const EpdLutInfo& info = epdLutInfo(EpdLutProfile(l));
+    unsigned long measured = gfx.epd2.lutRefreshMicros(EpdLutProfile(l));
+    if (config.format & EPD_BENCH_CSV) out.printf("lut,%s,%u,%u,%lu\n", info.name, info.frames, info.refresh_ms, measured);
+    if (config.format & EPD_BENCH_JSON)
+      out.printf("{\"lut\":\"%s\",\"frames\":%u,\"nominal_ms\":%u,\"refresh_us\":%lu}\n", info.name, info.frames, info.refresh_ms, measured);
+  }
+  gfx.epd2.setLutProfile(saved_lut);
+  gfx.setRotation(saved_rotation);
+}
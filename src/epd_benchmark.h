@@ -0,0 +1,43 @@
+// epd_benchmark.h
+// 分阶段刷新基准测试：每次局部刷新分别计时渲染、SPI传输和BUSY等待，
+// 按窗口尺寸、位置、旋转和局部刷新波形扫描，输出p50/p95/p99与直方图（CSV/JSON，经串口）
+#ifndef EPD_BENCHMARK_H
+#define EPD_BENCHMARK_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+
+#define EPD_BENCH_MAX_SAMPLES 64   // 每个测试项的最大采样数
+#define EPD_BENCH_HIST_BINS 10     // 总耗时直方图的分箱数（min到max等分）
+
+// 输出格式（可同时选择）
+#define EPD_BENCH_CSV  0x01
+#define EPD_BENCH_JSON 0x02        // 每个测试项一行JSON（JSON Lines）
+
+// 窗口位置（可组合）
+#define EPD_BENCH_TOP_LEFT     0x01
+#define EPD_BENCH_CENTER       0x02
+#define EPD_BENCH_BOTTOM_RIGHT 0x04
+
+struct EpdBenchSize
+{
+  int16_t w, h;
+};
+
+struct EpdBenchConfig
+{
+  const EpdBenchSize* sizes;
+  uint8_t size_count;
+  uint8_t positions;   // EPD_BENCH_TOP_LEFT等的组合
+  uint8_t rotations;   // 位0~3对应旋转0~3
+  uint8_t lut_profiles; // 位n对应EpdLutProfile n（见epd_lut.h），0表示只测当前档位
+  uint8_t iterations;  // 每个测试项的采样数（不超过EPD_BENCH_MAX_SAMPLES）
+  uint8_t warmup;      // 每个测试项开头不计入的次数（第一次还要擦除上一项的方块）
+  uint8_t format;      // EPD_BENCH_CSV / EPD_BENCH_JSON
+};
+
+// 依次执行所有组合：每次用updateDirty()交替画黑/白方块，结束后恢复原来的旋转与波形；
+// 扫描了波形时最后每档输出一行实测刷新时间（CSV为lut,开头，JSON为{"lut":...}）
+void runRefreshBenchmark(EpdDisplay& gfx, const EpdBenchConfig& config, Print& out);
+
+#endif
@@ -0,0 +1,69 @@
+// epd_busy.cpp
+// 电子纸BUSY等待实现
+#include "epd_busy.h"
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+EpdBusyWait::EpdBusyWait() :
+  _pin(-1), _busy_level(HIGH), _mode(EPD_BUSY_POLL), _sem(0), _blocked_us(0), _wakeups(0)
+{
+}
+
+bool EpdBusyWait::begin(int8_t pin, int16_t busy_level, EpdBusyMode mode)
+{
+  if (pin < 0) return false;
+  if (!_sem) _sem = xSemaphoreCreateBinary();
+  if (!_sem) return false;
+  _pin = pin;
+  _busy_level = busy_level;
+  _mode = EPD_BUSY_POLL;
+  setMode(mode);
+  return true;
+}
+
+void EpdBusyWait::setMode(EpdBusyMode mode)
+{
+  if (_pin < 0) return;
+  // 浅睡眠唤醒使用电平触发，会改写引脚的中断类型，两种方式不同时挂接
+  if (_mode == EPD_BUSY_IRQ) detachInterrupt(_pin);
+  _mode = mode;
+  if (_mode == EPD_BUSY_IRQ) attachInterruptArg(_pin, _isr, this, _busy_level == HIGH ? FALLING : RISING);
+}
+
+void EpdBusyWait::callback(const void* ctx)
+{
+  ((EpdBusyWait*)ctx)->_wait();
+}
+
+void EpdBusyWait::_wait()
+{
+  uint32_t t0 = micros();
+  switch (_mode)
+  {
+    case EPD_BUSY_POLL:
+      delay(1);
+      break;
+    case EPD_BUSY_IRQ:
+      // 信号量可能是上一次刷新结束时留下的，这时立即返回，原驱动读到仍忙会再次调用
+      if (xSemaphoreTake(_sem, pdMS_TO_TICKS(EPD_BUSY_SLICE_MS)) == pdTRUE) _wakeups++;
+      break;
+    case EPD_BUSY_LIGHT_SLEEP:
+      gpio_wakeup_enable((gpio_num_t)_pin, _busy_level == HIGH ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+      esp_sleep_enable_gpio_wakeup();
+      esp_sleep_enable_timer_wakeup(EPD_BUSY_SLICE_MS * 1000ul);
+      if (esp_light_sleep_start() == ESP_OK && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) _wakeups++;
+      esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+      esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+      gpio_wakeup_disable((gpio_num_t)_pin);
+      break;
+  }
+  _blocked_us += micros() - t0;
+}
+
+void IRAM_ATTR EpdBusyWait::_isr(void* arg)
+{
+  EpdBusyWait* w = (EpdBusyWait*)arg;
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(w->_sem, &woken);
+  portYIELD_FROM_ISR(woken);
+}
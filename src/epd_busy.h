@@ -0,0 +1,53 @@
+// epd_busy.h
+// 电子纸BUSY等待：用GPIO中断加FreeRTOS信号量代替GxEPD2的轮询，可选在等待期间进入浅睡眠
+#ifndef EPD_BUSY_H
+#define EPD_BUSY_H
+
+#include <Arduino.h>
+
+// 每次阻塞的最长时间。GxEPD2的_waitWhileBusy()在两次回调之间检查引脚和超时，
+// 分片等待保证它的超时（刷新卡死时的保护）照常生效
+#define EPD_BUSY_SLICE_MS 50
+
+enum EpdBusyMode
+{
+  EPD_BUSY_POLL,         // 原驱动行为：每1ms轮询一次
+  EPD_BUSY_IRQ,          // 阻塞在信号量上，BUSY变为空闲的边沿中断唤醒；其它任务照常运行
+  EPD_BUSY_LIGHT_SLEEP   // 整片进入浅睡眠直到BUSY空闲，最省电，但期间所有任务（包括另一个核）都暂停
+};
+
+/**
+ * GxEPD2_EPD::_waitWhileBusy()在BUSY有效期间反复调用setBusyCallback()设置的回调，
+ * 本类的回调在回调内部阻塞到BUSY变为空闲（或一个时间片到期），原驱动随后读引脚确认并退出循环。
+ * 用GxEPD2_290_Ext::setBusyWait()挂接，引脚和有效电平取自驱动。
+ */
+class EpdBusyWait
+{
+  public:
+    EpdBusyWait();
+
+    bool begin(int8_t pin, int16_t busy_level, EpdBusyMode mode = EPD_BUSY_IRQ);
+    void setMode(EpdBusyMode mode);
+    EpdBusyMode mode() const { return _mode; }
+
+    // GxEPD2的busy回调，ctx为EpdBusyWait对象
+    static void callback(const void* ctx);
+
+    // 统计：回调中阻塞的总时间、被中断或唤醒结束的等待次数
+    uint32_t blockedMicros() const { return _blocked_us; }
+    uint32_t wakeups() const { return _wakeups; }
+    void resetStats() { _blocked_us = _wakeups = 0; }
+
+  private:
+    void _wait();
+    static void IRAM_ATTR _isr(void* arg);
+
+  private:
+    int8_t _pin;
+    int16_t _busy_level;
+    EpdBusyMode _mode;
+    SemaphoreHandle_t _sem;
+    uint32_t _blocked_us, _wakeups;
+};
+
+#endif
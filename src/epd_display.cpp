@@ -0,0 +1,509 @@
+// epd_display.cpp
+// 带脏矩形跟踪的显示类实现
+#include "epd_display.h"
+
+EpdDisplay::EpdDisplay(GxEPD2_DRIVER_CLASS epd2_instance) :
+  DisplayBase(epd2_instance),
+  _previous_valid(false), _recording(false), _keep_background(false)
+{
+  _previous.x = _previous.y = _previous.w = _previous.h = 0;
+  _lastWindow = _previous;
+  _window.x = _window.y = 0;
+  _window.w = WIDTH;
+  _window.h = HEIGHT;
+  _page = 0;
+  _page_clip = _window;
+  _page_clip_valid = false;
+  _culled = 0;
+  _target = 0;
+  _target_y = _target_h = 0;
+  _page_buf[0] = _page_buf[1] = 0;
+  _render_task = 0;
+  _free_q = _ready_q = 0;
+  _job_cb = 0;
+  _job_pv = 0;
+  _job_passes = 0;
+}
+
+void EpdDisplay::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if (_recording)
+  {
+    if ((x >= 0) && (x < width()) && (y >= 0) && (y < height())) _dirty.addPixel(x, y);
+    return;
+  }
+  if (_target)
+  {
+    // 与GxEPD2_BW::drawPixel()相同的旋转换算，写入流水线的页缓冲
+    if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+    int16_t px = x, py = y;
+    switch (getRotation())
+    {
+      case 1: px = WIDTH - y - 1; py = x; break;
+      case 2: px = WIDTH - x - 1; py = HEIGHT - y - 1; break;
+      case 3: px = y; py = HEIGHT - x - 1; break;
+    }
+    py -= _target_y;
+    if ((py < 0) || (py >= _target_h)) return;
+    uint8_t* p = _target + py * (WIDTH / 8) + px / 8;
+    if (color == GxEPD_WHITE) *p |= 0x80 >> (px & 7);
+    else *p &= ~(0x80 >> (px & 7));
+    return;
+  }
+  DisplayBase::drawPixel(x, y, color);
+}
+
+void EpdDisplay::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  if (_recording)
+  {
+    markDirty(x, y, w, 1);
+    return;
+  }
+  int16_t h = 1;
+  if (!clipToPage(x, y, w, h)) return;
+  DisplayBase::drawFastHLine(x, y, w, color);
+}
+
+void EpdDisplay::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  if (_recording)
+  {
+    markDirty(x, y, 1, h);
+    return;
+  }
+  int16_t w = 1;
+  if (!clipToPage(x, y, w, h)) return;
+  DisplayBase::drawFastVLine(x, y, h, color);
+}
+
+void EpdDisplay::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if (_recording)
+  {
+    markDirty(x, y, w, h); // 白色填充（擦除）同样算作变化
+    return;
+  }
+  // 小窗口分页时（如基准测试的16x16方块）大部分填充都落在页外
+  if (!clipToPage(x, y, w, h)) return;
+  DisplayBase::fillRect(x, y, w, h, color);
+}
+
+void EpdDisplay::fillScreen(uint16_t color)
+{
+  if (_recording)
+  {
+    // 白色清屏是每页的背景初始化，不算内容；其它颜色等于整屏变化
+    if (color != GxEPD_WHITE) markDirty(0, 0, width(), height());
+    return;
+  }
+  if (_keep_background && (color == GxEPD_WHITE)) return;
+  if (_target)
+  {
+    memset(_target, color == GxEPD_WHITE ? 0xFF : 0x00, _target_h * (WIDTH / 8));
+    return;
+  }
+  // 页缓冲本身就是当前页，整块填充已经是最小的工作量
+  DisplayBase::fillScreen(color);
+}
+
+void EpdDisplay::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+{
+  if (_recording)
+  {
+    markDirty(x, y, w, h); // 整块记录，避免逐像素读取位图
+    return;
+  }
+  EPD_TRACE_BEGIN(EPD_TRACE_BLIT, x, y, w, h);
+  _drawBitmapRuns(x, y, bitmap, w, h, color, color, false);
+  EPD_TRACE_END(EPD_TRACE_BLIT);
+}
+
+void EpdDisplay::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  if (_recording)
+  {
+    markDirty(x, y, w, h);
+    return;
+  }
+  EPD_TRACE_BEGIN(EPD_TRACE_BLIT, x, y, w, h);
+  _drawBitmapRuns(x, y, bitmap, w, h, color, bg, true);
+  EPD_TRACE_END(EPD_TRACE_BLIT);
+}
+
+// 只遍历位图与当前页相交的行列，连续的同色像素合并为一条水平线；
+// 不透明时0位画bg，否则跳过（与Adafruit_GFX::drawBitmap()的两个版本一致）
+void EpdDisplay::_drawBitmapRuns(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg, bool opaque)
+{
+  int16_t cx = x, cy = y, cw = w, ch = h;
+  if (!clipToPage(cx, cy, cw, ch)) return;
+  int16_t bw = (w + 7) / 8;
+  int16_t c0 = cx - x, c1 = c0 + cw;
+  for (int16_t r = cy - y; r < cy - y + ch; r++)
+  {
+    const uint8_t* line = bitmap + int32_t(r) * bw;
+    int16_t run = c0;
+    bool run_on = pgm_read_byte(line + (c0 >> 3)) & (0x80 >> (c0 & 7));
+    for (int16_t c = c0 + 1; c <= c1; c++)
+    {
+      bool on = (c < c1) && (pgm_read_byte(line + (c >> 3)) & (0x80 >> (c & 7)));
+      if ((c < c1) && (on == run_on)) continue;
+      if (run_on || opaque) DisplayBase::drawFastHLine(x + run, y + r, c - run, run_on ? color : bg);
+      run = c;
+      run_on = on;
+    }
+  }
+}
+
+void EpdDisplay::setRotation(uint8_t r)
+{
+  _page_clip_valid = false;
+  DisplayBase::setRotation(r);
+}
+
+void EpdDisplay::firstPage()
+{
+  // 不经过updateDirty()的绘制会改变屏幕内容，上一次跟踪的区域不再可信
+  _previous_valid = false;
+  _page = 0;
+  _page_clip_valid = false;
+  _beginUpdate();
+  DisplayBase::firstPage();
+  EPD_TRACE_BEGIN(EPD_TRACE_PAGE, 0);
+}
+
+bool EpdDisplay::nextPage()
+{
+  // 与GxEPD2_BW相同：最后一页或窗口已画完（当前页在窗口之外）后回到第0页，
+  // 支持快速局部刷新的控制器刷新后还要从第0页起再画一遍
+  bool last = (_page + 1 >= pages()) || (_page * pageHeight() >= _window.h);
+  EPD_TRACE_END(EPD_TRACE_PAGE, _page);
+  bool more = DisplayBase::nextPage();
+  _page = (more && !last) ? _page + 1 : 0;
+  _page_clip_valid = false;
+  if (more) EPD_TRACE_BEGIN(EPD_TRACE_PAGE, _page);
+  if (!more) _endUpdate(); // firstPage()或updateWindow()开始的更新到此结束
+  return more;
+}
+
+void EpdDisplay::setFullWindow()
+{
+  _window.x = _window.y = 0;
+  _window.w = WIDTH;
+  _window.h = HEIGHT;
+  _page_clip_valid = false;
+  EPD_TRACE_MARK(EPD_TRACE_WINDOW, 0, 0, WIDTH, HEIGHT);
+  DisplayBase::setFullWindow();
+}
+
+void EpdDisplay::setPartialFullWindow()
+{
+  _window.x = _window.y = 0;
+  _window.w = WIDTH;
+  _window.h = HEIGHT;
+  _page_clip_valid = false;
+  EPD_TRACE_MARK(EPD_TRACE_WINDOW, 0, 0, WIDTH, HEIGHT);
+  DisplayBase::setPartialFullWindow();
+}
+
+void EpdDisplay::setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  // 与GxEPD2_BW::setPartialWindow()相同的裁剪和x方向字节对齐
+  DirtyRect p = _toPhysical(x, y, w, h);
+  if (p.x < 0) { p.w += p.x; p.x = 0; }
+  if (p.y < 0) { p.h += p.y; p.y = 0; }
+  if (p.x > WIDTH) p.x = WIDTH;
+  if (p.y > HEIGHT) p.y = HEIGHT;
+  if (p.w > WIDTH - p.x) p.w = WIDTH - p.x;
+  if (p.h > HEIGHT - p.y) p.h = HEIGHT - p.y;
+  p.w += p.x % 8;
+  if (p.w % 8 > 0) p.w += 8 - p.w % 8;
+  p.x -= p.x % 8;
+  _window = p;
+  _page_clip_valid = false;
+  EPD_TRACE_MARK(EPD_TRACE_WINDOW, p.x, p.y, p.w, p.h);
+  DisplayBase::setPartialWindow(x, y, w, h);
+}
+
+DirtyRect EpdDisplay::pageRect()
+{
+  if (_page_clip_valid) return _page_clip;
+  DirtyRect p;
+  if (_target)
+  {
+    DirtyRect t = { 0, _target_y, int16_t(WIDTH), _target_h };
+    p = t;
+  }
+  else
+  {
+    // 第k页对应窗口内的物理行[k * pageHeight(), (k + 1) * pageHeight())
+    p = _window;
+    int16_t ph = pageHeight();
+    p.y = _window.y + _page * ph;
+    p.h = _window.bottom() - p.y;
+    if (p.h > ph) p.h = ph;
+  }
+  _page_clip = _toLogical(p);
+  _page_clip_valid = true;
+  return _page_clip;
+}
+
+bool EpdDisplay::clipToPage(int16_t& x, int16_t& y, int16_t& w, int16_t& h)
+{
+  const DirtyRect& c = pageRect();
+  if (x < c.x) { w -= c.x - x; x = c.x; }
+  if (y < c.y) { h -= c.y - y; y = c.y; }
+  if (w > c.right() - x) w = c.right() - x;
+  if (h > c.bottom() - y) h = c.bottom() - y;
+  if ((w > 0) && (h > 0)) return true;
+  _culled++;
+  return false;
+}
+
+void EpdDisplay::clearScreen(uint8_t value)
+{
+  _previous_valid = false;
+  DisplayBase::clearScreen(value);
+}
+
+bool EpdDisplay::retain(EpdRetainedFrame& r)
+{
+  if (!epd2.saveFrame(r.frame)) return false;
+  r.rotation = getRotation();
+  r.previous_valid = _previous_valid;
+  r.previous = _previous;
+  r.last_window = _lastWindow;
+  EpdGhostTracker* ghost = epd2.ghostTracker();
+  r.has_ghost = ghost != 0;
+  if (ghost) ghost->saveState(r.ghost);
+  epdRetainedSeal(r);
+  return true;
+}
+
+bool EpdDisplay::restore(const EpdRetainedFrame& r, bool rewrite)
+{
+  if (!epdRetainedValid(r)) return false;
+  if (!(rewrite ? epd2.resumeFrame(r.frame) : epd2.restoreFrame(r.frame))) return false;
+  setRotation(r.rotation);
+  _previous_valid = r.previous_valid;
+  _previous = r.previous;
+  _lastWindow = r.last_window;
+  EpdGhostTracker* ghost = epd2.ghostTracker();
+  if (ghost && r.has_ghost) ghost->restoreState(r.ghost);
+  return true;
+}
+
+void EpdDisplay::markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  // 裁剪到屏幕范围（逻辑坐标）
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width()) w = width() - x;
+  if (y + h > height()) h = height() - y;
+  _dirty.add(x, y, w, h);
+}
+
+DirtyRect EpdDisplay::recordBounds(void (*drawCallback)(const void*), const void* pv)
+{
+  _dirty.clear();
+  _recording = true;
+  drawCallback(pv);
+  _recording = false;
+  return _dirty.isEmpty() ? _dirty.bounds() : _toPhysical(_dirty.bounds().x, _dirty.bounds().y, _dirty.bounds().w, _dirty.bounds().h);
+}
+
+bool EpdDisplay::updateDirty(void (*drawCallback)(const void*), const void* pv)
+{
+  // 1. 只记录模式执行一遍回调，得到本次绘制内容的外接矩形（记录遍计入这次更新的渲染时间）
+  _beginUpdate();
+  DirtyRect current = recordBounds(drawCallback, pv);
+
+  // 2. 与上一次内容区域取并集，使旧内容被擦除
+  DirtyRegion region;
+  region.add(current);
+  if (_previous_valid) region.add(_previous);
+  _previous = current;
+  _previous_valid = true;
+  bool updated = updateWindow(drawCallback, pv, region.bounds());
+  _endUpdate();
+  return updated;
+}
+
+bool EpdDisplay::updateWindow(void (*drawCallback)(const void*), const void* pv, const DirtyRect& window)
+{
+  if (window.isEmpty())
+  {
+    _lastWindow = window;
+    return false;
+  }
+
+  // 3. 按字节对齐扩展后换算回逻辑坐标，只刷新该区域
+  DirtyRect snapped = DirtyRegion::snapToByteAlignment(window, WIDTH, HEIGHT);
+  _lastWindow = _toLogical(snapped);
+  setPartialWindow(_lastWindow.x, _lastWindow.y, _lastWindow.w, _lastWindow.h);
+  _page = 0;
+  _page_clip_valid = false;
+  _beginUpdate();
+  DisplayBase::firstPage();
+  EPD_TRACE_BEGIN(EPD_TRACE_PAGE, 0);
+  do
+  {
+    drawCallback(pv);
+  }
+  while (nextPage());
+  return true;
+}
+
+bool bitmapRowSource(uint8_t* row, int16_t y, void* ctx)
+{
+  const BitmapRowSource* src = (const BitmapRowSource*)ctx;
+  int16_t wb = (display.width() + 7) / 8;
+  int16_t bwb = (src->w + 7) / 8;
+  memset(row, 0, wb);
+  if (y >= src->h) return true;
+  int16_t n = bwb < wb ? bwb : wb;
+  const uint8_t* p = src->bitmap + int32_t(y) * bwb;
+  if (src->pgm) memcpy_P(row, p, n);
+  else memcpy(row, p, n);
+  if ((src->w & 7) && (bwb <= wb)) row[bwb - 1] &= 0xFF << (8 - (src->w & 7)); // 行尾填充位不画
+  return true;
+}
+
+bool EpdDisplay::streamFrame(EpdRowSource source, void* ctx, bool partial_update_mode)
+{
+  uint8_t band[EPD_STREAM_BAND_ROWS * EPD_STREAM_MAX_ROW_BYTES];
+  int16_t wb = (width() + 7) / 8;
+  if (wb > EPD_STREAM_MAX_ROW_BYTES) return false;
+  _previous_valid = false; // 屏幕内容被整体替换
+  _beginUpdate();
+  // 与GxEPD2_BW::display()相同：写入、刷新，支持快速局部刷新的控制器刷新后再写一遍
+  for (uint8_t pass = 0; pass < 2; pass++)
+  {
+    bool again = pass > 0;
+    epd2.beginStream(again);
+    for (int16_t y0 = 0; y0 < height(); y0 += EPD_STREAM_BAND_ROWS)
+    {
+      for (int16_t r = 0; r < EPD_STREAM_BAND_ROWS; r++)
+      {
+        uint8_t* row = band + r * wb;
+        if (y0 + r >= height()) memset(row, 0, wb);
+        else if (!source(row, y0 + r, ctx))
+        {
+          epd2.endStream(again, false);
+          _endUpdate();
+          return false;
+        }
+      }
+      _streamBand(band, y0, wb);
+    }
+    epd2.endStream(again, true);
+    if (!again) epd2.refresh(partial_update_mode);
+    if (!epd2.hasFastPartialUpdate) break;
+  }
+  _endUpdate();
+  return true;
+}
+
+// 把逻辑坐标[y0, y0 + 8)行换算为物理坐标写入控制器RAM（RAM中1为白，行源中1为黑，发送时取反）
+void EpdDisplay::_streamBand(const uint8_t* band, int16_t y0, int16_t wb)
+{
+  switch (getRotation())
+  {
+    case 0:
+      // 逻辑行即物理行
+      epd2.streamArea(0, y0, WIDTH, EPD_STREAM_BAND_ROWS);
+      for (int16_t r = 0; r < EPD_STREAM_BAND_ROWS; r++)
+        for (int16_t b = 0; b < int16_t(WIDTH / 8); b++) epd2.streamByte(~band[r * wb + b]);
+      break;
+    case 2:
+      // 逻辑第y行是物理第HEIGHT - 1 - y行，左右翻转：按物理行递增顺序倒序取行，字节倒序、位反转
+      epd2.streamArea(0, HEIGHT - y0 - EPD_STREAM_BAND_ROWS, WIDTH, EPD_STREAM_BAND_ROWS);
+      for (int16_t r = EPD_STREAM_BAND_ROWS - 1; r >= 0; r--)
+      {
+        for (int16_t b = int16_t(WIDTH / 8) - 1; b >= 0; b--)
+        {
+          uint8_t v = band[r * wb + b], m = 0;
+          for (uint8_t k = 0; k < 8; k++) if (v & (1 << k)) m |= 0x80 >> k;
+          epd2.streamByte(~m);
+        }
+      }
+      break;
+    case 1:
+    case 3:
+    {
+      // 逻辑8行对应物理的一个字节列，窗口只有1字节宽，按物理行递增逐字节写入
+      // 旋转1：物理x = WIDTH - 1 - 逻辑y，物理y = 逻辑x；旋转3：物理x = 逻辑y，物理y = HEIGHT - 1 - 逻辑x
+      bool rot1 = getRotation() == 1;
+      int16_t px = rot1 ? WIDTH - y0 - EPD_STREAM_BAND_ROWS : y0;
+      epd2.streamArea(px, 0, 8, HEIGHT);
+      for (int16_t py = 0; py < int16_t(HEIGHT); py++)
+      {
+        int16_t lx = rot1 ? py : HEIGHT - 1 - py;
+        const uint8_t* col = band + lx / 8;
+        uint8_t mask = 0x80 >> (lx & 7);
+        uint8_t v = 0;
+        for (uint8_t k = 0; k < 8; k++)
+        {
+          // 物理字节的第k位（MSB为0）：旋转1对应逻辑行y0 + 7 - k，旋转3对应逻辑行y0 + k
+          uint8_t r = rot1 ? EPD_STREAM_BAND_ROWS - 1 - k : k;
+          if (col[r * wb] & mask) v |= 0x80 >> k;
+        }
+        epd2.streamByte(~v);
+      }
+      break;
+    }
+  }
+  epd2.endStreamArea();
+}
+
+// 逻辑坐标 -> 物理坐标（与GxEPD2_BW::_rotate()一致；WIDTH/HEIGHT为未旋转的面板尺寸）
+DirtyRect EpdDisplay::_toPhysical(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  DirtyRect p = { x, y, w, h };
+  switch (getRotation())
+  {
+    case 1:
+      p.x = WIDTH - y - h;
+      p.y = x;
+      p.w = h;
+      p.h = w;
+      break;
+    case 2:
+      p.x = WIDTH - x - w;
+      p.y = HEIGHT - y - h;
+      break;
+    case 3:
+      p.x = y;
+      p.y = HEIGHT - x - w;
+      p.w = h;
+      p.h = w;
+      break;
+  }
+  return p;
+}
+
+// 物理坐标 -> 逻辑坐标（_toPhysical()的逆变换）
+DirtyRect EpdDisplay::_toLogical(const DirtyRect& p)
+{
+  DirtyRect r = p;
+  switch (getRotation())
+  {
+    case 1:
+      r.x = p.y;
+      r.y = WIDTH - p.x - p.w;
+      r.w = p.h;
+      r.h = p.w;
+      break;
+    case 2:
+      r.x = WIDTH - p.x - p.w;
+      r.y = HEIGHT - p.y - p.h;
+      break;
+    case 3:
+      r.x = HEIGHT - p.y - p.h;
+      r.y = p.x;
+      r.w = p.h;
+      r.h = p.w;
+      break;
+  }
+  return r;
+}
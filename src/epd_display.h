@@ -0,0 +1,209 @@
+// epd_display.h
+// 显示类型的公共定义：各源文件（main.cpp、epaper_bitmaps.h及功能模块）共用同一个display对象
+#ifndef EPD_DISPLAY_H
+#define EPD_DISPLAY_H
+
+// 基类GxEPD2_GFX可用于传递显示实例的引用或指针作为参数，会多使用约1.2k代码
+// 启用或禁用GxEPD2_GFX基类（各编译单元必须一致）
+#ifndef ENABLE_GxEPD2_GFX
+#define ENABLE_GxEPD2_GFX 0
+#endif
+
+#include <Arduino.h>
+#include <GxEPD2_BW.h>
+#include "dirty_region.h"
+#include "epd_driver.h"
+#include "epd_retain.h"
+#include "epd_trace.h"
+
+// 选择显示类（仅一个），需与电子纸面板类型匹配
+#define GxEPD2_DISPLAY_CLASS GxEPD2_BW
+
+// 选择显示驱动类（仅一个），需与你的面板匹配
+// GxEPD2_290_Ext在GxEPD2_290基础上增加行级差分传输等优化（见epd_driver.h）
+#define GxEPD2_DRIVER_CLASS GxEPD2_290_Ext // GDEH029A1   128x296, SSD1608 (IL3820), (E029A01-FPC-A1 SYX1553)
+
+// 定义显示类型相关的宏
+#define GxEPD2_BW_IS_GxEPD2_BW true
+#define IS_GxEPD(c, x) (c##x)
+#define IS_GxEPD2_BW(x) IS_GxEPD(GxEPD2_BW_IS_, x)
+
+#if defined(ESP32)
+    // 最大显示缓冲区大小；整屏图片走streamFrame()时可在构建参数中调小（如-DMAX_DISPLAY_BUFFER_SIZE=1024），
+    // 其余绘制自动改为分页，把RAM留给其它任务
+    #ifndef MAX_DISPLAY_BUFFER_SIZE
+    #define MAX_DISPLAY_BUFFER_SIZE 65536ul
+    #endif
+    #if IS_GxEPD2_BW(GxEPD2_DISPLAY_CLASS)
+    // 计算最大高度，确保不超过缓冲区大小
+    #define MAX_HEIGHT(EPD) (EPD::HEIGHT <= MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8) ? EPD::HEIGHT : MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8))
+    #endif
+
+    // GxEPD2原始显示类型
+    typedef GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> DisplayBase;
+
+/**
+ * 流式绘制的行源：把逻辑坐标（当前旋转下）第y行写入row（width()像素，(width() + 7) / 8字节，MSB在左，1为黑）。
+ * 行按y递增的顺序请求，一帧请求两遍（刷新前后各一遍，y == 0表示从头开始）；返回false中止本次绘制
+ */
+typedef bool (*EpdRowSource)(uint8_t* row, int16_t y, void* ctx);
+
+// 行源：位图（1为黑）放在左上角，其余部分为白
+struct BitmapRowSource
+{
+  const uint8_t* bitmap;
+  int16_t w, h;
+  bool pgm;
+};
+bool bitmapRowSource(uint8_t* row, int16_t y, void* ctx);
+
+#define EPD_STREAM_BAND_ROWS 8       // 一次取8行：旋转90°时正好拼成控制器RAM的一列字节
+#define EPD_STREAM_MAX_ROW_BYTES 37  // 逻辑宽度最大296像素
+
+// 流水线分页绘制（drawPipelined()）：每页的物理行数（两块页缓冲各WIDTH / 8 * 行数字节），
+// 默认74行即整屏4页、每块1184字节
+#ifndef EPD_PIPELINE_PAGE_ROWS
+#define EPD_PIPELINE_PAGE_ROWS 74
+#endif
+// 渲染任务所在的核（Arduino的loop()运行在核1）与栈大小（CJK排版在栈上有暂存区）
+#ifndef EPD_PIPELINE_CORE
+#define EPD_PIPELINE_CORE 0
+#endif
+#define EPD_PIPELINE_STACK 8192
+
+/**
+ * 带脏矩形跟踪的显示类
+ * 在GxEPD2显示类之上拦截fillRect、drawFastHLine/VLine、drawPixel、drawBitmap等图元，
+ * updateDirty()先以“只记录”方式执行一遍绘图回调得到本次绘制的外接矩形，
+ * 与上一次跟踪更新的区域取并集（用于擦除旧内容），按SSD1608字节对齐后只刷新该区域。
+ * 分页绘制时回调每页执行一遍，图元先与当前页（窗口内）求交：不相交的直接返回，
+ * 部分相交的裁剪后再光栅化，而不是逐像素画完再由drawPixel()丢弃。
+ * 驱动挂接了能耗记账（epd2.setEnergyMeter()）时，每次更新记一条记录（见epd_energy.h）；
+ * 更新、页、窗口与位图绘制同时记入事件跟踪（见epd_trace.h）。
+ */
+class EpdDisplay : public DisplayBase
+{
+  public:
+    EpdDisplay(GxEPD2_DRIVER_CLASS epd2_instance);
+
+    // Adafruit_GFX虚函数图元：记录模式下只合并外接矩形，不写缓冲区
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color);
+
+    // drawBitmap在Adafruit_GFX中不是虚函数，这里隐藏同名函数以便记录模式下整块记录
+    using DisplayBase::drawBitmap;
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg);
+
+    // 旋转改变时当前页区域随之改变
+    void setRotation(uint8_t r);
+
+    // 非跟踪的绘图会使“上一次内容区域”失效
+    void firstPage();
+    void clearScreen(uint8_t value = 0xFF);
+
+    // 窗口与分页：GxEPD2_BW的窗口和当前页是私有状态，这里同步维护一份，
+    // 供按页解码的图元（如压缩位图）只处理当前页能写入的部分
+    void setFullWindow();
+    void setPartialFullWindow();
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    bool nextPage();
+    // 当前页能写入的区域（逻辑坐标），区域外的绘制都会被丢弃
+    DirtyRect pageRect();
+    // 把矩形（逻辑坐标）裁剪到当前页，完全在页外时返回false
+    bool clipToPage(int16_t& x, int16_t& y, int16_t& w, int16_t& h);
+    // 统计：因与当前页不相交而直接返回的图元调用数
+    uint32_t culledCalls() const { return _culled; }
+
+    // 自动求脏矩形并局部刷新；回调签名与GxEPD2的drawPaged()一致
+    // 回调应绘制完整的画面内容（窗口外的绘制会被裁剪），返回false表示没有需要刷新的区域
+    bool updateDirty(void (*drawCallback)(const void*), const void* pv = 0);
+
+    // updateDirty()的两步，供自行决定刷新窗口的调用者（如EpdUpdateQueue）分别使用：
+    // 以只记录方式执行回调，返回绘制内容的外接矩形（物理坐标）
+    DirtyRect recordBounds(void (*drawCallback)(const void*), const void* pv = 0);
+    // 局部刷新window（物理坐标，按字节对齐扩展）并用回调绘制，window为空时返回false
+    bool updateWindow(void (*drawCallback)(const void*), const void* pv, const DirtyRect& window);
+
+    // 逻辑坐标与物理坐标互换（当前旋转）
+    DirtyRect toPhysical(const DirtyRect& r) { return _toPhysical(r.x, r.y, r.w, r.h); }
+    DirtyRect toLogical(const DirtyRect& p) { return _toLogical(p); }
+
+    // 手动标记脏区域（逻辑坐标，即当前旋转下的坐标）
+    void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+    bool isRecording() const { return _recording; }
+
+    // 保留背景：fillScreen(GxEPD_WHITE)不再清除页缓冲。
+    // 多个回调（各自以白色清屏开头）画进同一页时，由调用者先清屏一次，再在此模式下依次调用
+    void setKeepBackground(bool keep) { _keep_background = keep; }
+
+    // Adafruit_GFX未公开的文本状态（文本测量缓存以此为键）
+    const GFXfont* getFont() const { return gfxFont; }
+    uint8_t getTextSizeX() const { return textsize_x; }
+    uint8_t getTextSizeY() const { return textsize_y; }
+    bool getTextWrap() const { return wrap; }
+
+    // 流式绘制整屏：行源的数据按8行一组直接写入控制器RAM，不使用显示缓冲区（只需8行的暂存区），
+    // 刷新方式与display(partial_update_mode)相同；返回false表示行源中止
+    bool streamFrame(EpdRowSource source, void* ctx, bool partial_update_mode = false);
+
+    // 双核流水线分页绘制整屏：渲染任务在EPD_PIPELINE_CORE上把第N + 1页画进一块页缓冲，
+    // 调用者所在的核同时把第N页写入控制器，两块缓冲轮流使用，任一方领先时等待另一方。
+    // 回调签名与drawPaged()相同，每页调用一次（在渲染任务中执行，期间调用者不能绘图）；
+    // 刷新方式与display(partial_update_mode)相同。缓冲区或任务创建失败时退回单核分页绘制并返回false
+    bool drawPipelined(void (*drawCallback)(const void*), const void* pv = 0, bool partial_update_mode = false);
+
+    // 最近一次updateDirty()实际刷新的窗口（逻辑坐标）
+    DirtyRect lastRefreshWindow() const { return _lastWindow; }
+
+    // 深睡眠保留（见epd_retain.h）：保存面板上的一帧、旋转、跟踪区域与重影预算，在hibernate()之前调用；
+    // 需要开启差分传输，最后一次更新没有完成两遍写入时返回false
+    bool retain(EpdRetainedFrame& r);
+    // 唤醒后init(0, false)并开启差分传输之后调用，数据无效时返回false（应改为全刷）；
+    // rewrite为true用于断电重启（控制器RAM已丢失，数据来自闪存快照），先把这一帧写回控制器（见resumeFrame()）
+    bool restore(const EpdRetainedFrame& r, bool rewrite = false);
+
+  private:
+    DirtyRect _toPhysical(int16_t x, int16_t y, int16_t w, int16_t h);
+    DirtyRect _toLogical(const DirtyRect& p);
+    void _drawBitmapRuns(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg, bool opaque);
+    void _streamBand(const uint8_t* band, int16_t y0, int16_t wb);
+    // 能耗记账与事件跟踪的一次更新（可嵌套，能耗记账只在最外层记一条）
+    void _beginUpdate() { EPD_TRACE_BEGIN(EPD_TRACE_UPDATE); if (epd2.energyMeter()) epd2.energyMeter()->beginUpdate(); }
+    void _endUpdate() { if (epd2.energyMeter()) epd2.energyMeter()->endUpdate(); EPD_TRACE_END(EPD_TRACE_UPDATE); }
+    bool _startPipeline();
+    void _renderPage(uint8_t buf, uint16_t page);
+    static void _renderTask(void* arg);
+
+  private:
+    DirtyRegion _dirty;       // 本次记录的区域（逻辑坐标，记录期间旋转不变）
+    DirtyRect _previous;      // 上一次跟踪更新绘制的内容区域（物理坐标）
+    bool _previous_valid;     // 上一次内容区域是否可信
+    bool _recording;          // 只记录模式
+    bool _keep_background;    // 忽略白色清屏
+    DirtyRect _lastWindow;
+    DirtyRect _window;        // 当前窗口（物理坐标，x与GxEPD2_BW一样按8对齐）
+    uint16_t _page;           // 当前页序号
+    DirtyRect _page_clip;     // pageRect()的缓存，页、窗口、旋转或流水线目标改变时失效
+    bool _page_clip_valid;
+    uint32_t _culled;
+    // 流水线绘制：_target非空时图元画进该页缓冲（物理行[_target_y, _target_y + _target_h)，1为白）
+    uint8_t* volatile _target;
+    int16_t _target_y, _target_h;
+    uint8_t* _page_buf[2];
+    TaskHandle_t _render_task;
+    QueueHandle_t _free_q, _ready_q;    // 空闲的页缓冲、已渲染待发送的页缓冲（元素为缓冲序号）
+    void (*_job_cb)(const void*);
+    const void* _job_pv;
+    uint8_t _job_passes;
+};
+
+    typedef EpdDisplay DisplayType;
+
+    extern DisplayType display;
+#endif
+
+#endif
@@ -0,0 +1,573 @@
+// epd_driver.cpp
+// GxEPD2_290驱动扩展实现
+#include "epd_driver.h"
+
+GxEPD2_290_Ext::GxEPD2_290_Ext(int16_t cs, int16_t dc, int16_t rst, int16_t busy) :
+  GxEPD2_290(cs, dc, rst, busy),
+  _shadow(0), _shadow_valid(false), _rows_sent(0), _rows_skipped(0),
+  _stream_x0(0), _stream_x1(0), _stream_x(0), _stream_y(0),
+  _transfer_us(0), _refresh_us(0), _lut_profile(EPD_LUT_STANDARD), _lut_custom(false), _ghost(0), _meter(0),
+  _busy_wait(0), _bus(0), _transport(0), _page_cb(0), _page_ctx(0)
+{
+  memset(_pending_rows, 0, sizeof(_pending_rows));
+  memset(_lut_us, 0, sizeof(_lut_us));
+}
+
+bool GxEPD2_290_Ext::setDeltaTransfer(bool enable)
+{
+  if (enable && !_shadow)
+  {
+    _shadow = (uint8_t*)malloc(SHADOW_SIZE);
+    _shadow_valid = false; // 面板当前内容未知，第一次写入整窗发送
+    memset(_pending_rows, 0, sizeof(_pending_rows));
+  }
+  else if (!enable && _shadow)
+  {
+    free(_shadow);
+    _shadow = 0;
+  }
+  return _shadow != 0;
+}
+
+bool GxEPD2_290_Ext::saveFrame(uint8_t* frame) const
+{
+  if (!_shadow || !_shadow_valid) return false;
+  // 还有行只写了第一遍：两块RAM不一致，唤醒后的差分没有可靠的基准
+  for (uint16_t i = 0; i < sizeof(_pending_rows); i++)
+    if (_pending_rows[i]) return false;
+  memcpy(frame, _shadow, SHADOW_SIZE);
+  return true;
+}
+
+bool GxEPD2_290_Ext::restoreFrame(const uint8_t* frame)
+{
+  if (!_shadow) return false;
+  memcpy(_shadow, frame, SHADOW_SIZE);
+  memset(_pending_rows, 0, sizeof(_pending_rows));
+  _shadow_valid = true;
+  return true;
+}
+
+bool GxEPD2_290_Ext::resumeFrame(const uint8_t* frame)
+{
+  if (!_shadow || _initial_refresh) return false;
+  // 不计入重影预算：各像素都是驱动到它已经显示的颜色
+  EpdGhostTracker* ghost = _ghost;
+  EpdLutProfile profile = _lut_profile;
+  _ghost = 0;
+  _lut_profile = EPD_LUT_TURBO;
+  _shadow_valid = false;
+  memset(_pending_rows, 0, sizeof(_pending_rows));
+  writeImage(frame, 0, 0, WIDTH, HEIGHT);
+  refresh(0, 0, WIDTH, HEIGHT);
+  writeImageAgain(frame, 0, 0, WIDTH, HEIGHT);
+  _lut_profile = profile;
+  _ghost = ghost;
+  return _shadow_valid;
+}
+
+void GxEPD2_290_Ext::setEnergyMeter(EpdEnergyMeter* meter)
+{
+  _meter = meter;
+  _meterLeave();
+}
+
+void GxEPD2_290_Ext::setTransport(EpdTransport* transport)
+{
+  if (_transport) _transport->wait();
+  _transport = transport;
+}
+
+bool GxEPD2_290_Ext::setBusyWait(EpdBusyWait* wait, EpdBusyMode mode)
+{
+  _busy_wait = wait && wait->begin(_busy, _busy_level, mode) ? wait : 0;
+  _hookBusy();
+  return _busy_wait != 0;
+}
+
+void GxEPD2_290_Ext::setSharedBus(SemaphoreHandle_t bus)
+{
+  _bus = bus;
+  _hookBusy();
+}
+
+void GxEPD2_290_Ext::_hookBusy()
+{
+  if (_bus) setBusyCallback(_busyCallback, this);
+  else if (_busy_wait) setBusyCallback(EpdBusyWait::callback, _busy_wait);
+  else setBusyCallback(0, 0);
+}
+
+// 原驱动在每次回调之后才读BUSY，所以回调返回前总是取回总线，即使这次等待没有结束
+void GxEPD2_290_Ext::_busyCallback(const void* ctx)
+{
+  GxEPD2_290_Ext* d = (GxEPD2_290_Ext*)ctx;
+  xSemaphoreGive(d->_bus);
+  if (d->_busy_wait) EpdBusyWait::callback(d->_busy_wait);
+  else delay(1);
+  xSemaphoreTake(d->_bus, portMAX_DELAY);
+}
+
+void GxEPD2_290_Ext::clearScreen(uint8_t value)
+{
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _lend();
+  GxEPD2_290::clearScreen(value);
+  _reclaim();
+  _meterLeave(outer);
+  if (_shadow)
+  {
+    memset(_shadow, value, SHADOW_SIZE);
+    memset(_pending_rows, 0, sizeof(_pending_rows));
+    _shadow_valid = true;
+  }
+}
+
+void GxEPD2_290_Ext::writeScreenBuffer(uint8_t value)
+{
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _lend();
+  GxEPD2_290::writeScreenBuffer(value);
+  _reclaim();
+  _meterLeave(outer);
+  if (_shadow)
+  {
+    memset(_shadow, value, SHADOW_SIZE);
+    memset(_pending_rows, 0, sizeof(_pending_rows));
+    _shadow_valid = true;
+  }
+}
+
+void GxEPD2_290_Ext::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  uint32_t t0 = micros();
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  if ((!_shadow && !_dma()) || mirror_y)
+  {
+    _shadow_valid = false;
+    if (_ghost) _ghost->addArea(x, y, w, h);
+    _lend();
+    EPD_TRACE_BEGIN(EPD_TRACE_SPI, y, h, w / 8 * h);
+    GxEPD2_290::writeImage(bitmap, x, y, w, h, invert, mirror_y, pgm);
+    EPD_TRACE_END(EPD_TRACE_SPI);
+    _reclaim();
+  }
+  else
+  {
+    if (_initial_write) writeScreenBuffer(); // 与原驱动相同：首次写入前清空控制器RAM（同时初始化影子副本）
+    _writeDelta(bitmap, x, y, w, h, invert, pgm, false);
+    _flushPage();
+  }
+  _transfer_us += micros() - t0;
+  _meterLeave(outer);
+}
+
+void GxEPD2_290_Ext::writeImageForFullRefresh(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  uint32_t t0 = micros();
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _shadow_valid = false; // 全刷前的写入不经过差分
+  _lend();
+  EPD_TRACE_BEGIN(EPD_TRACE_SPI, y, h, w / 8 * h);
+  GxEPD2_290::writeImageForFullRefresh(bitmap, x, y, w, h, invert, mirror_y, pgm);
+  EPD_TRACE_END(EPD_TRACE_SPI);
+  _reclaim();
+  _transfer_us += micros() - t0;
+  _meterLeave(outer);
+}
+
+void GxEPD2_290_Ext::writeImageAgain(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  uint32_t t0 = micros();
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  if ((!_shadow && !_dma()) || mirror_y)
+  {
+    _shadow_valid = false;
+    _lend();
+    EPD_TRACE_BEGIN(EPD_TRACE_SPI, y, h, w / 8 * h);
+    GxEPD2_290::writeImageAgain(bitmap, x, y, w, h, invert, mirror_y, pgm);
+    EPD_TRACE_END(EPD_TRACE_SPI);
+    _reclaim();
+  }
+  else
+  {
+    _writeDelta(bitmap, x, y, w, h, invert, pgm, true);
+    _flushPage();
+  }
+  _transfer_us += micros() - t0;
+  _meterLeave(outer);
+}
+
+void GxEPD2_290_Ext::writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                                    int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  _shadow_valid = false; // 位图子区域写入不做差分，影子副本失效
+  if (_ghost) _ghost->addArea(x, y, w, h);
+  _lend();
+  GxEPD2_290::writeImagePart(bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
+  _reclaim();
+}
+
+void GxEPD2_290_Ext::writeImagePartAgain(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                                         int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  _shadow_valid = false;
+  _lend();
+  GxEPD2_290::writeImagePartAgain(bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
+  _reclaim();
+}
+
+// 刷新前等待排队的数据发完（release()内完成，计入传输时间），刷新期间总线归SPIClass
+void GxEPD2_290_Ext::refresh(bool partial_update_mode)
+{
+  // 原驱动的refresh(true)只是转到虚函数refresh(0, 0, WIDTH, HEIGHT)，直接交给下面的重载，
+  // 免得残影计数、LUT装入与计时在两层里各做一次
+  if (partial_update_mode) return refresh(0, 0, WIDTH, HEIGHT);
+  uint32_t t0 = micros();
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _lend();
+  uint32_t t1 = micros();
+  _meterEnter(EPD_ENERGY_BUSY);
+  EPD_TRACE_BEGIN(EPD_TRACE_BUSY, EPD_TRACE_BUSY_FULL);
+  GxEPD2_290::refresh(false);
+  EPD_TRACE_END(EPD_TRACE_BUSY);
+  _reclaim();
+  uint32_t t2 = micros();
+  _meterLeave(outer);
+  _transfer_us += t1 - t0;
+  _refresh_us += t2 - t1;
+  _lut_custom = false; // 全刷之后原驱动重新进入局部模式时装入默认LUT
+  if (_ghost) _ghost->fullRefresh();
+}
+
+void GxEPD2_290_Ext::refresh(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  uint32_t t0 = micros();
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _lend();
+  bool partial = !_initial_refresh && !_ghostPromote(x, y, w, h);
+  EpdLutProfile lut = partial ? _applyLut() : EPD_LUT_STANDARD;
+  uint32_t t1 = micros();
+  _meterEnter(EPD_ENERGY_BUSY);
+  EPD_TRACE_BEGIN(EPD_TRACE_BUSY, partial ? EPD_TRACE_BUSY_PARTIAL : EPD_TRACE_BUSY_FULL);
+  // 改为全刷时刷新整个控制器RAM：窗口外就是屏幕上现有的内容
+  if (partial) GxEPD2_290::refresh(x, y, w, h);
+  else GxEPD2_290::refresh(false);
+  EPD_TRACE_END(EPD_TRACE_BUSY);
+  _reclaim();
+  uint32_t t2 = micros();
+  _meterLeave(outer);
+  _transfer_us += t1 - t0;
+  _refresh_us += t2 - t1;
+  if (partial) _recordLut(lut, t2 - t1);
+  else
+  {
+    _lut_custom = false;
+    if (_ghost) _ghost->fullRefresh();
+  }
+}
+
+bool GxEPD2_290_Ext::refreshIfGhosted()
+{
+  if (!_ghost || !_ghost->due() || _initial_refresh || _hibernating) return false;
+  _ghost->countIdleRefresh();
+  // 关电（_PowerOff()）会清除局部模式标志而控制器里仍是局部LUT，原驱动据此判断是否重装全刷LUT；
+  // 这里不经过写入直接刷新，置上标志让refresh(false)先_Init_Full()
+  _using_partial_mode = true;
+  refresh(false);
+  return true;
+}
+
+bool GxEPD2_290_Ext::_ghostPromote(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if (!_ghost) return false;
+  // 波形权重与帧数成反比：标准档计4，快速档约6，极速档10
+  uint8_t frames = epdLutInfo(_lut_profile).frames;
+  uint8_t std_frames = epdLutInfo(EPD_LUT_STANDARD).frames;
+  _ghost->partialRefresh(x, y, w, h, (EpdGhostTracker::WEIGHT_STANDARD * std_frames + frames / 2) / frames);
+  if (!_ghost->urgent()) return false;
+  _ghost->countPromotion();
+  return true;
+}
+
+// 调用时总线已交给原驱动
+EpdLutProfile GxEPD2_290_Ext::_applyLut()
+{
+  // 不在局部模式时原驱动刷新前会先装入默认局部LUT，这次只能用标准档
+  if (!_using_partial_mode || _hibernating)
+  {
+    _lut_custom = false;
+    return EPD_LUT_STANDARD;
+  }
+  if ((_lut_profile == EPD_LUT_STANDARD) && !_lut_custom) return EPD_LUT_STANDARD;
+  _writeCommand(0x32);
+  _writeDataPGM(epdLutInfo(_lut_profile).lut, EPD_LUT_SIZE);
+  _lut_custom = _lut_profile != EPD_LUT_STANDARD;
+  return _lut_profile;
+}
+
+void GxEPD2_290_Ext::_recordLut(EpdLutProfile profile, uint32_t us)
+{
+  uint32_t& avg = _lut_us[profile];
+  avg = avg ? (avg * 7 + us) / 8 : us;
+}
+
+void GxEPD2_290_Ext::powerOff()
+{
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_BUSY);
+  _lend();
+  EPD_TRACE_BEGIN(EPD_TRACE_BUSY, EPD_TRACE_BUSY_POWER_OFF);
+  GxEPD2_290::powerOff();
+  EPD_TRACE_END(EPD_TRACE_BUSY);
+  _reclaim();
+  _meterLeave(outer);
+}
+
+void GxEPD2_290_Ext::hibernate()
+{
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_BUSY);
+  _lend();
+  EPD_TRACE_BEGIN(EPD_TRACE_BUSY, EPD_TRACE_BUSY_HIBERNATE);
+  GxEPD2_290::hibernate();
+  EPD_TRACE_END(EPD_TRACE_BUSY);
+  _reclaim();
+  _meterLeave(outer);
+  _shadow_valid = false; // 面板可能随MCU断电，默认不信任唤醒后的RAM内容；保留了面板供电时见saveFrame()/restoreFrame()
+  _lut_custom = false;
+}
+
+void GxEPD2_290_Ext::beginStream(bool again)
+{
+  // 借原驱动写一个字节来完成初始化（首次写入清空RAM、切换到局部刷新模式等，相关函数为private），
+  // 这个字节随后会被整帧数据覆盖
+  static const uint8_t white = 0xFF;
+  EpdEnergyState outer = _meterEnter(EPD_ENERGY_SPI);
+  _lend();
+  if (again) GxEPD2_290::writeImageAgain(&white, 0, 0, 8, 1, false, false, false);
+  else GxEPD2_290::writeImage(&white, 0, 0, 8, 1, false, false, false);
+  _reclaim();
+  if (_ghost && !again) _ghost->addArea(0, 0, WIDTH, HEIGHT);
+  _shadow_valid = false;
+  memset(_pending_rows, 0, sizeof(_pending_rows));
+  _meterLeave(outer);
+}
+
+// 到endStreamArea()为止计为传输（行源在两个窗口之间准备下一组行）
+void GxEPD2_290_Ext::streamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  _meterEnter(EPD_ENERGY_SPI);
+  EPD_TRACE_BEGIN(EPD_TRACE_SPI, y, h, ((x + w + 7) / 8 - x / 8) * h);
+  _setRamArea(x, y, w, h);
+  _stream_x0 = _stream_x = x / 8;
+  _stream_x1 = (x + w - 1) / 8;
+  _stream_y = y;
+  _command(0x24);
+  _beginData();
+}
+
+void GxEPD2_290_Ext::streamByte(uint8_t data)
+{
+  _byte(data);
+  // 同步更新影子副本，流式写入之后差分传输仍然可用
+  if (_shadow && (_stream_y < HEIGHT)) _shadow[uint32_t(_stream_y) * (WIDTH / 8) + _stream_x] = data;
+  if (++_stream_x > _stream_x1)
+  {
+    _stream_x = _stream_x0;
+    _stream_y++;
+  }
+}
+
+void GxEPD2_290_Ext::endStream(bool again, bool complete)
+{
+  _flushPage();
+  if (_shadow && again && complete) _shadow_valid = true;
+  _rows_sent += complete ? HEIGHT : 0;
+}
+
+/**
+ * 差分写入（两遍共用）
+ * 第一遍（again=false）：与影子副本比较，只发送变化的行，影子副本暂不更新；
+ * 第二遍（again=true）：同一位图再比较一次（结果与第一遍相同），发送后提交到影子副本。
+ * 若某行第一遍写入后未等到第二遍就再次写入，说明两块RAM已不一致，影子副本作废。
+ */
+void GxEPD2_290_Ext::_writeDelta(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool pgm, bool again)
+{
+  // 与GxEPD2_290::writeImage()相同的字节对齐与裁剪
+  int16_t wb = (w + 7) / 8; // width bytes, bitmaps are padded
+  x -= x % 8; // byte boundary
+  w = wb * 8; // byte boundary
+  int16_t x1 = x < 0 ? 0 : x; // limit
+  int16_t y1 = y < 0 ? 0 : y; // limit
+  int16_t w1 = x + w < int16_t(WIDTH) ? w : int16_t(WIDTH) - x; // limit
+  int16_t h1 = y + h < int16_t(HEIGHT) ? h : int16_t(HEIGHT) - y; // limit
+  int16_t dx = x1 - x;
+  int16_t dy = y1 - y;
+  w1 -= dx;
+  h1 -= dy;
+  if ((w1 <= 0) || (h1 <= 0)) return;
+
+  // 1. 维护“等待第二遍”的行标记
+  for (int16_t i = 0; i < h1; i++)
+  {
+    if (!again && _isPending(y1 + i)) _shadow_valid = false;
+    _setPending(y1 + i, !again);
+  }
+
+  // 重影统计只算第一遍（第二遍是同一数据）
+  if (_ghost && !again)
+  {
+    if (_shadow && _shadow_valid) _countFlips(bitmap, wb, dx, dy, x1, y1, w1, h1, invert, pgm);
+    else _ghost->addArea(x1, y1, w1, h1);
+  }
+
+  // 2. 影子副本不可用：整窗发送（控制器未处于局部刷新模式时先借原驱动完成初始化）
+  bool init = !_using_partial_mode || _hibernating;
+  if (!_shadow || !_shadow_valid)
+  {
+    if (_dma())
+    {
+      if (init) _initByBase(bitmap, wb, dx, dy, x1, y1, invert, pgm, again);
+      _writeRows(bitmap, wb, dx, dy, x1, y1, w1, 0, h1, invert, pgm);
+    }
+    // 两遍都直接调用原驱动的writeImage()：原驱动的writeImageAgain()经虚函数回到本类的writeImage()，
+    // 会把第二遍当成第一遍记下等待标记，下一次写入时影子副本被误判作废
+    else GxEPD2_290::writeImage(bitmap, x, y, w, h, invert, false, pgm);
+    _rows_sent += h1;
+    if (again && _shadow)
+    {
+      _copyToShadow(bitmap, wb, dx, dy, x1, y1, w1, h1, invert, pgm);
+      if ((x1 == 0) && (y1 == 0) && (w1 == int16_t(WIDTH)) && (h1 == int16_t(HEIGHT))) _shadow_valid = true;
+    }
+    return;
+  }
+
+  // 关电或唤醒之后控制器RAM内容保留，初始化后仍与影子副本比较
+  if (init) _initByBase(bitmap, wb, dx, dy, x1, y1, invert, pgm, again);
+
+  // 3. 逐行比较，连续（允许MERGE_GAP_ROWS行间隔）的变化行合并为一次写入
+  const uint16_t shadow_wb = WIDTH / 8;
+  int16_t run_start = -1, run_end = -1;
+  for (int16_t i = 0; i <= h1; i++)
+  {
+    bool changed = false;
+    if (i < h1)
+    {
+      const uint8_t* shadow_row = _shadow + uint32_t(y1 + i) * shadow_wb + x1 / 8;
+      for (int16_t j = 0; j < w1 / 8; j++)
+      {
+        int16_t idx = j + dx / 8 + (i + dy) * wb;
+        uint8_t data = pgm ? pgm_read_byte(&bitmap[idx]) : bitmap[idx];
+        if (invert) data = ~data;
+        if (data != shadow_row[j])
+        {
+          changed = true;
+          break;
+        }
+      }
+    }
+    if (changed)
+    {
+      if (run_start < 0) run_start = i;
+      run_end = i + 1;
+    }
+    else if ((run_start >= 0) && ((i - run_end >= MERGE_GAP_ROWS) || (i == h1)))
+    {
+      _writeRows(bitmap, wb, dx, dy, x1, y1, w1, run_start, run_end - run_start, invert, pgm);
+      _rows_sent += run_end - run_start;
+      run_start = -1;
+    }
+    if (!changed && (i < h1)) _rows_skipped++;
+  }
+  if (again) _copyToShadow(bitmap, wb, dx, dy, x1, y1, w1, h1, invert, pgm);
+}
+
+void GxEPD2_290_Ext::_writeRows(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t row, int16_t rows,
+                                bool invert, bool pgm)
+{
+  EPD_TRACE_BEGIN(EPD_TRACE_SPI, y + row, rows, w / 8 * rows);
+  _setRamArea(x, y + row, w, rows);
+  _command(0x24);
+  _beginData();
+  for (int16_t i = row; i < row + rows; i++)
+  {
+    for (int16_t j = 0; j < w / 8; j++)
+    {
+      int16_t idx = j + dx / 8 + (i + dy) * wb;
+      uint8_t data = pgm ? pgm_read_byte(&bitmap[idx]) : bitmap[idx];
+      if (invert) data = ~data;
+      _byte(data);
+    }
+  }
+  _endData();
+  EPD_TRACE_END(EPD_TRACE_SPI);
+}
+
+void GxEPD2_290_Ext::_flushPage()
+{
+  if (_dma()) _transport->flush(_page_cb, _page_ctx);
+  else if (_page_cb) _page_cb(_page_ctx);
+}
+
+void GxEPD2_290_Ext::_initByBase(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, bool invert, bool pgm, bool again)
+{
+  // 写入的就是该位置的真实数据，该行随后整窗发送或按差分重发；
+  // 两遍都用原驱动的writeImage()，原因见_writeDelta()
+  uint8_t first = pgm ? pgm_read_byte(&bitmap[dx / 8 + dy * wb]) : bitmap[dx / 8 + dy * wb];
+  (void)again;
+  _lend();
+  GxEPD2_290::writeImage(&first, x, y, 8, 1, invert, false, false);
+  _reclaim();
+}
+
+void GxEPD2_290_Ext::_copyToShadow(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t h,
+                                   bool invert, bool pgm)
+{
+  const uint16_t shadow_wb = WIDTH / 8;
+  for (int16_t i = 0; i < h; i++)
+  {
+    uint8_t* shadow_row = _shadow + uint32_t(y + i) * shadow_wb + x / 8;
+    for (int16_t j = 0; j < w / 8; j++)
+    {
+      int16_t idx = j + dx / 8 + (i + dy) * wb;
+      uint8_t data = pgm ? pgm_read_byte(&bitmap[idx]) : bitmap[idx];
+      shadow_row[j] = invert ? ~data : data;
+    }
+  }
+}
+
+void GxEPD2_290_Ext::_countFlips(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t h,
+                                 bool invert, bool pgm)
+{
+  const uint16_t shadow_wb = WIDTH / 8;
+  for (int16_t i = 0; i < h; i++)
+  {
+    const uint8_t* shadow_row = _shadow + uint32_t(y + i) * shadow_wb + x / 8;
+    for (int16_t j = 0; j < w / 8; j++)
+    {
+      int16_t idx = j + dx / 8 + (i + dy) * wb;
+      uint8_t data = pgm ? pgm_read_byte(&bitmap[idx]) : bitmap[idx];
+      if (invert) data = ~data;
+      uint8_t diff = data ^ shadow_row[j];
+      if (diff) _ghost->addFlips(x + j * 8, y + i, __builtin_popcount(diff));
+    }
+  }
+}
+
+void GxEPD2_290_Ext::_setRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  _command(0x11); // set ram entry mode
+  _data(0x03);    // x increase, y increase : normal mode
+  _command(0x44);
+  _data(x / 8);
+  _data((x + w - 1) / 8);
+  _command(0x45);
+  _data(y % 256);
+  _data(y / 256);
+  _data((y + h - 1) % 256);
+  _data((y + h - 1) / 256);
+  _command(0x4e);
+  _data(x / 8);
+  _command(0x4f);
+  _data(y % 256);
+  _data(y / 256);
+}
@@ -0,0 +1,189 @@
+// epd_driver.h
+// GxEPD2_290（GDEH029A1, SSD1608）驱动扩展：在GxEPD2原驱动之上增加传输层优化
+#ifndef EPD_DRIVER_H
+#define EPD_DRIVER_H
+
+#include <Arduino.h>
+#include <GxEPD2_BW.h>
+#include "epd_transport.h"
+#include "epd_busy.h"
+#include "epd_lut.h"
+#include "epd_ghost.h"
+#include "epd_energy.h"
+#include "epd_trace.h"
+
+/**
+ * GxEPD2_BW::nextPage()通过epd2.writeImage()/writeImageAgain()把页缓冲写入控制器RAM，
+ * 显示类以本类作为驱动模板参数，这两个调用就会静态绑定到这里的实现。
+ *
+ * 行级差分传输：保存面板RAM中最后一帧的影子副本（WIDTH/8*HEIGHT = 4736字节），
+ * 写入时逐行比较新帧与影子副本，只发送有变化的行（相邻变化行合并为一次RAM窗口写入）。
+ * SSD1608快速局部刷新需要同一数据写两遍（刷新前后各一次），第二遍只重发第一遍标记的行。
+ *
+ * DMA异步传输（setTransport()）：本类发出的RAM窗口设置与图像数据改经EpdTransport排队，
+ * writeImage()/writeImageAgain()复制完数据即返回，GxEPD2_BW::nextPage()不再等字节发完就去渲染下一页；
+ * 需要原驱动完成的操作（控制器初始化、刷新、关电等）先等队列发完，再临时把总线交回SPIClass。
+ * 启用后不要直接调用这里没有覆盖的原驱动接口（drawImage()、writeNative()等）。
+ *
+ * 局部刷新波形（setLutProfile()）：原驱动在进入局部模式时装入默认局部LUT，
+ * 选了其它档位时每次局部刷新前重新写入该档的LUT（31字节，相对刷新时间可忽略）。
+ * 控制器此时还不在局部模式的那一次刷新（如全刷后直接refresh(x, y, w, h)）仍使用默认LUT。
+ *
+ * 控制器不在局部模式时（关电或深睡眠唤醒之后）先借原驱动完成初始化，控制器RAM在此期间保留，
+ * 影子副本有效就照常差分，唤醒后的第一次更新也只发送变化的行（见saveFrame()/restoreFrame()）。
+ *
+ * 共用SPI总线（setSharedBus()，见epd_panels.h）：多块面板各有CS与BUSY，调用本驱动的任务持有总线互斥量，
+ * BUSY等待期间把它交出去，让其它面板在这次刷新进行时传输数据，等待结束前再取回。
+ *
+ * 重影预算（setGhostTracker()）：第一遍写入时与影子副本比较，按块统计翻转的像素（没有影子副本时按整窗计），
+ * 每次局部刷新按窗口与波形累计次数。超出预算较多时当次局部刷新直接改为全刷——
+ * 控制器RAM中就是完整的新画面，不需要重新绘制；只是超出预算时由refreshIfGhosted()在空闲时补做。
+ *
+ * 能耗记账（setEnergyMeter()）：写入与刷新的计时点同时切换EpdEnergyMeter的状态（传输、BUSY等待），
+ * 关电与深睡眠的等待计为BUSY，每次操作结束按面板的供电状态（升压开启、待机、深睡眠）交回。
+ * 每段RAM写入与每次BUSY等待同时记入事件跟踪（见epd_trace.h）。
+ */
+class GxEPD2_290_Ext : public GxEPD2_290
+{
+  public:
+    GxEPD2_290_Ext(int16_t cs, int16_t dc, int16_t rst, int16_t busy);
+
+    // 启用/禁用行级差分传输（启用时分配影子缓冲区，禁用时释放）
+    bool setDeltaTransfer(bool enable);
+    bool deltaTransferEnabled() const { return _shadow != 0; }
+    // 影子副本失效，下一次写入整窗发送
+    void invalidateShadow() { _shadow_valid = false; }
+    // 深睡眠保留（见epd_retain.h）：复制影子副本（SHADOW_SIZE字节），两块RAM一致时才能保存，须在hibernate()之前；
+    // 唤醒后init(0, false)并开启差分传输，再把保存的一帧作为影子副本，控制器RAM里仍是这一帧
+    bool saveFrame(uint8_t* frame) const;
+    bool restoreFrame(const uint8_t* frame);
+    // 断电重启后（控制器RAM已丢失，屏幕上仍是frame，见epd_snapshot.h）：把frame写回控制器RAM，
+    // 以极速波形局部刷新一次使刷新前后两块RAM都是这一帧（屏幕内容不变），之后即可差分局部刷新。
+    // 须以init(0, false)初始化并开启差分传输
+    bool resumeFrame(const uint8_t* frame);
+
+    // 统计：发送的行数、因未变化而跳过的行数
+    uint32_t rowsSent() const { return _rows_sent; }
+    uint32_t rowsSkipped() const { return _rows_skipped; }
+    void resetTransferStats() { _rows_sent = _rows_skipped = 0; }
+    // 分阶段计时：写入控制器RAM（含刷新前等待DMA队列发完）与刷新（基本是BUSY等待）的累计时间
+    uint32_t transferMicros() const { return _transfer_us; }
+    uint32_t refreshMicros() const { return _refresh_us; }
+    void resetPhaseTimes() { _transfer_us = _refresh_us = 0; }
+
+    // 之后的局部刷新使用的波形（见epd_lut.h），全刷不受影响
+    void setLutProfile(EpdLutProfile profile) { _lut_profile = profile; }
+    EpdLutProfile lutProfile() const { return _lut_profile; }
+    // 各档局部刷新实测耗时（指数滑动平均，μs），还没有用过的档位返回0
+    uint32_t lutRefreshMicros(EpdLutProfile profile) const { return profile < EPD_LUT_PROFILE_COUNT ? _lut_us[profile] : 0; }
+
+    // 启用DMA异步传输（transport已begin()），传0恢复SPIClass阻塞传输
+    void setTransport(EpdTransport* transport);
+    EpdTransport* transport() const { return _transport; }
+    // 每次writeImage()/writeImageAgain()（即每一页）的数据发完时调用，调用环境见EpdFlushCallback
+    void setPageCallback(EpdFlushCallback cb, void* ctx) { _page_cb = cb; _page_ctx = ctx; }
+
+    // 挂接重影预算（见epd_ghost.h），传0关闭
+    void setGhostTracker(EpdGhostTracker* ghost) { _ghost = ghost; }
+    EpdGhostTracker* ghostTracker() const { return _ghost; }
+    // 挂接能耗记账（见epd_energy.h），传0关闭
+    void setEnergyMeter(EpdEnergyMeter* meter);
+    EpdEnergyMeter* energyMeter() const { return _meter; }
+    // 空闲时调用：重影超出预算则全刷一次（控制器RAM中的当前画面），返回是否刷新了
+    bool refreshIfGhosted();
+
+    // 以中断/浅睡眠方式等待BUSY（见epd_busy.h），引脚与有效电平使用构造时的参数；传0恢复轮询
+    bool setBusyWait(EpdBusyWait* wait, EpdBusyMode mode = EPD_BUSY_IRQ);
+    // 与其它面板共用总线：bus为互斥量，调用本驱动的任务必须持有它；传0恢复独占总线
+    void setSharedBus(SemaphoreHandle_t bus);
+
+    void clearScreen(uint8_t value = 0xFF);
+    void writeScreenBuffer(uint8_t value = 0xFF);
+    void writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    void writeImageForFullRefresh(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    void writeImageAgain(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    void writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                        int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    void writeImagePartAgain(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                             int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    void refresh(bool partial_update_mode = false);
+    void refresh(int16_t x, int16_t y, int16_t w, int16_t h);
+    void powerOff();
+    void hibernate();
+
+    // 流式写入控制器RAM（不经过显示缓冲区，见EpdDisplay::streamFrame()）
+    // beginStream()完成与writeImage()/writeImageAgain()相同的控制器初始化，
+    // 之后每个streamArea()设置一个RAM窗口，用streamByte()按地址递增顺序发送窗口内的字节
+    void beginStream(bool again);
+    void streamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void streamByte(uint8_t data);
+    void endStreamArea() { _endData(); EPD_TRACE_END(EPD_TRACE_SPI); _meterLeave(); }
+    // again且整帧都已写入时，影子副本即为面板RAM内容
+    void endStream(bool again, bool complete);
+
+  protected:
+    // 传输选择：启用DMA时排队到EpdTransport，否则与原驱动一样经SPIClass阻塞发送
+    bool _dma() const { return _transport && _transport->active(); }
+    void _command(uint8_t c) { if (_dma()) _transport->command(c); else _writeCommand(c); }
+    void _data(uint8_t d) { if (_dma()) _transport->data(d); else _writeData(d); }
+    void _beginData() { if (!_dma()) _startTransfer(); }
+    void _byte(uint8_t d) { if (_dma()) _transport->data(d); else _transfer(d); }
+    void _endData() { if (!_dma()) _endTransfer(); }
+    // 原驱动的调用前后：交回/收回总线
+    void _lend() { if (_transport) _transport->release(); }
+    void _reclaim() { if (_transport) _transport->acquire(); }
+    // 能耗记账的状态切换：_meterEnter()返回之前的状态，操作结束时交给_meterLeave()，
+    // 嵌套调用（如首次写入前的writeScreenBuffer()、clearScreen()中的refresh()）结束后回到外层的状态；
+    // 面板的空闲状态按原驱动的供电标志判断
+    EpdEnergyState _meterEnter(EpdEnergyState state) { return _meter ? _meter->enter(state) : EPD_ENERGY_RENDER; }
+    void _meterLeave(EpdEnergyState outer = EPD_ENERGY_RENDER) { if (_meter) _meter->leave(_restState(), outer); }
+    EpdEnergyState _restState() const { return _hibernating ? EPD_ENERGY_HIBERNATE : _power_is_on ? EPD_ENERGY_IDLE : EPD_ENERGY_STANDBY; }
+    // 一页数据排队完毕：提交并挂上页回调
+    void _flushPage();
+    // 局部刷新前装入所选波形，返回本次刷新实际使用的档位
+    EpdLutProfile _applyLut();
+    void _recordLut(EpdLutProfile profile, uint32_t us);
+    // 局部刷新前的重影记账，返回true表示这次应改为全刷
+    bool _ghostPromote(int16_t x, int16_t y, int16_t w, int16_t h);
+    // GxEPD2的busy回调：共用总线时等待期间交出总线，再按setBusyWait()的方式等待
+    static void _busyCallback(const void* ctx);
+    void _hookBusy();
+    void _countFlips(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool pgm);
+    // 借原驱动写窗口的第一个字节，完成private的控制器初始化（_Init_Part()等）
+    void _initByBase(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, bool invert, bool pgm, bool again);
+
+    // 与GxEPD2_290::_setPartialRamArea()相同的命令序列（原函数为private）
+    void _setRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    // 把位图中[row, row + rows)行写入RAM（x, w已字节对齐且已裁剪）
+    void _writeRows(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t row, int16_t rows,
+                    bool invert, bool pgm);
+    void _copyToShadow(const uint8_t bitmap[], int16_t wb, int16_t dx, int16_t dy, int16_t x, int16_t y, int16_t w, int16_t h,
+                       bool invert, bool pgm);
+    void _writeDelta(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool pgm, bool again);
+
+    bool _isPending(int16_t row) const { return _pending_rows[row >> 3] & (1 << (row & 7)); }
+    void _setPending(int16_t row, bool p) { if (p) _pending_rows[row >> 3] |= (1 << (row & 7)); else _pending_rows[row >> 3] &= ~(1 << (row & 7)); }
+
+  protected:
+    static const uint16_t SHADOW_SIZE = uint16_t(WIDTH / 8) * HEIGHT;
+    static const int16_t MERGE_GAP_ROWS = 1; // 间隔不超过此行数的变化段合并（RAM窗口设置约需11字节）
+    uint8_t* _shadow;                        // 面板RAM内容的影子副本（物理方向，每行WIDTH/8字节）
+    bool _shadow_valid;
+    uint8_t _pending_rows[(HEIGHT + 7) / 8]; // 已写第一遍、等待第二遍的行
+    uint32_t _rows_sent, _rows_skipped;
+    uint8_t _stream_x0, _stream_x1, _stream_x; // 流式写入的当前窗口（字节列）与写入位置
+    uint16_t _stream_y;
+    uint32_t _transfer_us, _refresh_us;
+    EpdLutProfile _lut_profile;
+    bool _lut_custom;                        // 控制器中可能是非默认的局部LUT
+    uint32_t _lut_us[EPD_LUT_PROFILE_COUNT];
+    EpdGhostTracker* _ghost;
+    EpdEnergyMeter* _meter;
+    EpdBusyWait* _busy_wait;
+    SemaphoreHandle_t _bus;
+    EpdTransport* _transport;
+    EpdFlushCallback _page_cb;
+    void* _page_ctx;
+};
+
+#endif
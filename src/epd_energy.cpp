@@ -0,0 +1,170 @@
+// epd_energy.cpp
+// 能耗记账实现
+#include "epd_energy.h"
+
+static const char* const stateNames[EPD_ENERGY_STATE_COUNT] = { "render", "spi", "busy", "idle", "standby", "hibernate" };
+
+const char* epdEnergyStateName(EpdEnergyState state)
+{
+  return state < EPD_ENERGY_STATE_COUNT ? stateNames[state] : "";
+}
+
+EpdEnergyMeter::EpdEnergyMeter() :
+  _updates(0), _since(0), _state(EPD_ENERGY_STANDBY), _rest(EPD_ENERGY_STANDBY), _depth(0), _started(false)
+{
+  static const uint32_t defaults[EPD_ENERGY_STATE_COUNT] =
+  {
+    EPD_ENERGY_UA_RENDER, EPD_ENERGY_UA_SPI, EPD_ENERGY_UA_BUSY, EPD_ENERGY_UA_IDLE, EPD_ENERGY_UA_STANDBY, EPD_ENERGY_UA_HIBERNATE
+  };
+  memcpy(_ua, defaults, sizeof(_ua));
+  memset(_total_us, 0, sizeof(_total_us));
+  memset(_begin_us, 0, sizeof(_begin_us));
+  memset(_last_us, 0, sizeof(_last_us));
+  memset(_updates_us, 0, sizeof(_updates_us));
+}
+
+void EpdEnergyMeter::begin(EpdEnergyState rest)
+{
+  _rest = rest;
+  _state = _depth ? EPD_ENERGY_RENDER : rest;
+  _started = true;
+  reset();
+}
+
+void EpdEnergyMeter::reset()
+{
+  memset(_total_us, 0, sizeof(_total_us));
+  memset(_begin_us, 0, sizeof(_begin_us));
+  memset(_last_us, 0, sizeof(_last_us));
+  memset(_updates_us, 0, sizeof(_updates_us));
+  _updates = 0;
+  _since = micros();
+}
+
+void EpdEnergyMeter::_accrue()
+{
+  uint32_t now = micros();
+  if (!_started)
+  {
+    // 没有begin()：从第一次状态切换开始计时
+    _started = true;
+    _since = now;
+    return;
+  }
+  _total_us[_state] += now - _since;
+  _since = now;
+}
+
+EpdEnergyState EpdEnergyMeter::enter(EpdEnergyState state)
+{
+  EpdEnergyState previous = _state;
+  if (state >= EPD_ENERGY_STATE_COUNT) return previous;
+  _accrue();
+  _state = state;
+  return previous;
+}
+
+void EpdEnergyMeter::leave(EpdEnergyState rest, EpdEnergyState outer)
+{
+  _accrue();
+  _rest = rest;
+  if ((outer == EPD_ENERGY_SPI) || (outer == EPD_ENERGY_BUSY)) _state = outer;
+  else _state = _depth ? EPD_ENERGY_RENDER : rest;
+}
+
+void EpdEnergyMeter::poll()
+{
+  _accrue();
+}
+
+void EpdEnergyMeter::beginUpdate()
+{
+  if (_depth++) return;
+  _accrue();
+  memcpy(_begin_us, _total_us, sizeof(_begin_us));
+  _state = EPD_ENERGY_RENDER;
+}
+
+void EpdEnergyMeter::endUpdate()
+{
+  if (!_depth || --_depth) return;
+  _accrue();
+  for (uint8_t s = 0; s < EPD_ENERGY_STATE_COUNT; s++)
+  {
+    _last_us[s] = _total_us[s] - _begin_us[s];
+    _updates_us[s] += _last_us[s];
+  }
+  _updates++;
+  _state = _rest;
+}
+
+void EpdEnergyMeter::setCurrent(EpdEnergyState state, uint32_t ua)
+{
+  if (state < EPD_ENERGY_STATE_COUNT) _ua[state] = ua;
+}
+
+uint64_t EpdEnergyMeter::_charge(const uint64_t* us) const
+{
+  uint64_t nc = 0;
+  for (uint8_t s = 0; s < EPD_ENERGY_STATE_COUNT; s++) nc += us[s] * _ua[s] / 1000;
+  return nc;
+}
+
+// 1μAh = 3.6mC = 3600000nC
+void EpdEnergyMeter::_reportScope(Print& out, const char* scope, const uint64_t* us, uint32_t div)
+{
+  uint64_t sum_us = 0, sum_nc = 0;
+  for (uint8_t s = 0; s < EPD_ENERGY_STATE_COUNT; s++)
+  {
+    uint64_t t = us[s] / div;
+    uint64_t nc = t * _ua[s] / 1000;
+    sum_us += t;
+    sum_nc += nc;
+    out.printf("energy,%s,%s,%llu,%lu,%llu,%.4f\n", scope, stateNames[s], (unsigned long long)t, (unsigned long)_ua[s],
+               (unsigned long long)nc, nc / 3600000.0);
+  }
+  out.printf("energy,%s,all,%llu,,%llu,%.4f\n", scope, (unsigned long long)sum_us, (unsigned long long)sum_nc, sum_nc / 3600000.0);
+}
+
+void EpdEnergyMeter::report(Print& out)
+{
+  _accrue();
+  out.println("energy,scope,state,us,ua,nc,uah");
+  _reportScope(out, "last", _last_us, 1);
+  _reportScope(out, "updates", _updates_us, 1);
+  _reportScope(out, "avg", _updates_us, _updates ? _updates : 1);
+  _reportScope(out, "total", _total_us, 1);
+  out.printf("energy,count,%lu\n", (unsigned long)_updates);
+}
+
+bool EpdEnergyMeter::command(const char* line, Print& out)
+{
+  while (*line == ' ') line++;
+  if (strncmp(line, "energy", 6) || (line[6] && (line[6] != ' '))) return false;
+  line += 6;
+  while (*line == ' ') line++;
+  if (!*line) report(out);
+  else if (strcmp(line, "reset") == 0)
+  {
+    _accrue();
+    reset();
+    out.println("energy,reset");
+  }
+  else if (strncmp(line, "set ", 4) == 0)
+  {
+    char name[12];
+    unsigned long ua;
+    uint8_t s = EPD_ENERGY_STATE_COUNT;
+    if (sscanf(line + 4, "%11s %lu", name, &ua) == 2)
+      for (s = 0; s < EPD_ENERGY_STATE_COUNT; s++)
+        if (strcmp(name, stateNames[s]) == 0) break;
+    if (s < EPD_ENERGY_STATE_COUNT)
+    {
+      _ua[s] = ua;
+      out.printf("energy,set,%s,%lu\n", stateNames[s], ua);
+    }
+    else out.println("energy,error,usage: energy set <render|spi|busy|idle|standby|hibernate> <uA>");
+  }
+  else out.println("energy,error,usage: energy [reset | set <state> <uA>]");
+  return true;
+}
@@ -0,0 +1,117 @@
+// epd_energy.h
+// 能耗记账：按状态（渲染、SPI传输、BUSY等待、升压开启空闲、关电待机、深睡眠）累计时间，
+// 结合各状态的电流估算每次更新与累计的电荷量，经串口查询
+#ifndef EPD_ENERGY_H
+#define EPD_ENERGY_H
+
+#include <Arduino.h>
+
+enum EpdEnergyState
+{
+  EPD_ENERGY_RENDER,     // 更新中CPU渲染（记录遍、绘制页缓冲、差分比较）
+  EPD_ENERGY_SPI,        // 写入控制器RAM（含刷新前等待DMA队列发完）
+  EPD_ENERGY_BUSY,       // 刷新或开关电时等待BUSY
+  EPD_ENERGY_IDLE,       // 更新之外，面板升压开着（局部刷新之后没有powerOff()）
+  EPD_ENERGY_STANDBY,    // 更新之外，面板已powerOff()，控制器仍在工作
+  EPD_ENERGY_HIBERNATE,  // 更新之外，面板hibernate()
+  EPD_ENERGY_STATE_COUNT
+};
+
+// 各状态的默认电流（μA，整板：MCU、面板与稳压器合计），应按实际的板子实测后在构建参数中覆盖或用setCurrent()修改。
+// BUSY按EPD_BUSY_IRQ等待（MCU浅睡眠，主要是面板驱动电流）估计，轮询等待时接近渲染电流；
+// 三种空闲状态的差别只在面板（升压约4mA，待机与深睡眠只差几十μA），MCU的空闲电流由应用决定
+#ifndef EPD_ENERGY_UA_RENDER
+#define EPD_ENERGY_UA_RENDER 45000ul
+#endif
+#ifndef EPD_ENERGY_UA_SPI
+#define EPD_ENERGY_UA_SPI 48000ul
+#endif
+#ifndef EPD_ENERGY_UA_BUSY
+#define EPD_ENERGY_UA_BUSY 9000ul
+#endif
+#ifndef EPD_ENERGY_UA_IDLE
+#define EPD_ENERGY_UA_IDLE 44000ul
+#endif
+#ifndef EPD_ENERGY_UA_STANDBY
+#define EPD_ENERGY_UA_STANDBY 40050ul
+#endif
+#ifndef EPD_ENERGY_UA_HIBERNATE
+#define EPD_ENERGY_UA_HIBERNATE 40000ul
+#endif
+
+// 状态名（CSV与串口命令中使用）
+const char* epdEnergyStateName(EpdEnergyState state);
+
+/**
+ * 驱动（GxEPD2_290_Ext::setEnergyMeter()）在写入、刷新、关电与深睡眠时切换状态，
+ * 离开时按面板的供电状态回到空闲状态之一；EpdDisplay的更新（updateDirty()、updateWindow()、
+ * firstPage()到nextPage()返回false、streamFrame()、drawPipelined()）以beginUpdate()/endUpdate()括起，
+ * 期间驱动之外的时间都算渲染。嵌套的begin/end只有最外层生效，每次最外层end记下一条更新记录。
+ *
+ * 时间按状态累计（μs，64位），电荷在查询时才按当前的电流值换算（nC = μs × μA / 1000），
+ * 所以实测电流后修改setCurrent()，之前的记录也按新值重新估算。
+ * 时间取micros()（32位，约71分钟回绕）：长时间没有更新时应在loop()中调用poll()。
+ * 只能在调用驱动的同一任务中使用；深睡眠期间MCU停止计时，不在统计之内。
+ *
+ * report()输出CSV：energy,<范围>,<状态>,<μs>,<μA>,<nC>,<μAh>，范围为
+ * last（最近一次更新）、updates（所有更新之和）、avg（每次更新的平均）、total（reset()以来的全部时间），
+ * 每个范围各状态一行再加一行all；最后一行energy,count,<更新次数>
+ */
+class EpdEnergyMeter
+{
+  public:
+    EpdEnergyMeter();
+
+    // 开始计时（复位统计），rest为当前面板的空闲状态
+    void begin(EpdEnergyState rest = EPD_ENERGY_STANDBY);
+    void reset();
+
+    // 切换到state（驱动调用），返回之前的状态
+    EpdEnergyState enter(EpdEnergyState state);
+    // 驱动操作结束：记下面板的空闲状态rest；outer为enter()返回的状态，
+    // 嵌套在另一个驱动操作（传输或BUSY等待）中时回到outer，否则更新中回到渲染、更新之外进入rest
+    void leave(EpdEnergyState rest, EpdEnergyState outer = EPD_ENERGY_RENDER);
+    // 把到目前为止的时间计入当前状态
+    void poll();
+    EpdEnergyState state() const { return _state; }
+
+    void beginUpdate();
+    void endUpdate();
+    bool updating() const { return _depth > 0; }
+
+    void setCurrent(EpdEnergyState state, uint32_t ua);
+    uint32_t current(EpdEnergyState state) const { return state < EPD_ENERGY_STATE_COUNT ? _ua[state] : 0; }
+
+    // 各范围的时间（μs）与电荷（nC）
+    uint64_t totalMicros(EpdEnergyState state) const { return state < EPD_ENERGY_STATE_COUNT ? _total_us[state] : 0; }
+    uint64_t lastMicros(EpdEnergyState state) const { return state < EPD_ENERGY_STATE_COUNT ? _last_us[state] : 0; }
+    uint64_t totalCharge() const { return _charge(_total_us); }
+    uint64_t lastCharge() const { return _charge(_last_us); }
+    uint64_t updatesCharge() const { return _charge(_updates_us); }
+    uint32_t updates() const { return _updates; }
+
+    void report(Print& out);
+    // 串口命令（一行，不含换行）：energy输出报告，energy reset复位统计，
+    // energy set <状态名> <μA>修改电流；不是energy命令时返回false
+    bool command(const char* line, Print& out);
+
+  private:
+    void _accrue();
+    uint64_t _charge(const uint64_t* us) const;
+    void _reportScope(Print& out, const char* scope, const uint64_t* us, uint32_t div);
+
+  private:
+    uint32_t _ua[EPD_ENERGY_STATE_COUNT];
+    uint64_t _total_us[EPD_ENERGY_STATE_COUNT];
+    uint64_t _begin_us[EPD_ENERGY_STATE_COUNT];    // 最外层beginUpdate()时的_total_us
+    uint64_t _last_us[EPD_ENERGY_STATE_COUNT];
+    uint64_t _updates_us[EPD_ENERGY_STATE_COUNT];
+    uint32_t _updates;
+    uint32_t _since;       // 当前状态的计时起点
+    EpdEnergyState _state;
+    EpdEnergyState _rest;  // 面板的空闲状态
+    uint8_t _depth;
+    bool _started;
+};
+
+#endif
@@ -0,0 +1,102 @@
+// epd_ghost.cpp
+// 重影预算实现
+#include "epd_ghost.h"
+
+#define EPD_GHOST_PANEL_W 128
+#define EPD_GHOST_PANEL_H 296
+
+EpdGhostTracker::EpdGhostTracker() :
+  _full(0), _promoted(0), _idle(0), _requested(false)
+{
+  _budget.partials = EPD_GHOST_PARTIALS;
+  _budget.flip_pct = EPD_GHOST_FLIP_PCT;
+  _budget.hard_pct = EPD_GHOST_HARD_PCT;
+  memset(_weight, 0, sizeof(_weight));
+  memset(_flips, 0, sizeof(_flips));
+}
+
+void EpdGhostTracker::addFlips(int16_t x, int16_t y, uint16_t count)
+{
+  if ((x < 0) || (y < 0) || (x >= EPD_GHOST_PANEL_W) || (y >= EPD_GHOST_PANEL_H)) return;
+  uint16_t& f = _flips[(y / EPD_GHOST_TILE) * EPD_GHOST_COLS + x / EPD_GHOST_TILE];
+  f = count > 0xFFFF - f ? 0xFFFF : f + count;
+}
+
+void EpdGhostTracker::addArea(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  // 按块与区域的交集面积累计
+  int16_t x2 = x + w > EPD_GHOST_PANEL_W ? EPD_GHOST_PANEL_W : x + w;
+  int16_t y2 = y + h > EPD_GHOST_PANEL_H ? EPD_GHOST_PANEL_H : y + h;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  for (int16_t ty = y / EPD_GHOST_TILE * EPD_GHOST_TILE; ty < y2; ty += EPD_GHOST_TILE)
+  {
+    for (int16_t tx = x / EPD_GHOST_TILE * EPD_GHOST_TILE; tx < x2; tx += EPD_GHOST_TILE)
+    {
+      int16_t cw = min(x2, int16_t(tx + EPD_GHOST_TILE)) - max(x, tx);
+      int16_t ch = min(y2, int16_t(ty + EPD_GHOST_TILE)) - max(y, ty);
+      if ((cw > 0) && (ch > 0)) addFlips(tx, ty, uint16_t(cw) * ch);
+    }
+  }
+}
+
+void EpdGhostTracker::partialRefresh(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t weight)
+{
+  int16_t x2 = x + w > EPD_GHOST_PANEL_W ? EPD_GHOST_PANEL_W : x + w;
+  int16_t y2 = y + h > EPD_GHOST_PANEL_H ? EPD_GHOST_PANEL_H : y + h;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  for (int16_t ty = y / EPD_GHOST_TILE; ty * EPD_GHOST_TILE < y2; ty++)
+  {
+    for (int16_t tx = x / EPD_GHOST_TILE; tx * EPD_GHOST_TILE < x2; tx++)
+    {
+      uint16_t& wt = _weight[ty * EPD_GHOST_COLS + tx];
+      wt = weight > 0xFFFF - wt ? 0xFFFF : wt + weight;
+    }
+  }
+}
+
+void EpdGhostTracker::fullRefresh()
+{
+  memset(_weight, 0, sizeof(_weight));
+  memset(_flips, 0, sizeof(_flips));
+  _full++;
+  _requested = false;
+}
+
+void EpdGhostTracker::saveState(EpdGhostState& state) const
+{
+  memcpy(state.weight, _weight, sizeof(_weight));
+  memcpy(state.flips, _flips, sizeof(_flips));
+}
+
+void EpdGhostTracker::restoreState(const EpdGhostState& state)
+{
+  memcpy(_weight, state.weight, sizeof(_weight));
+  memcpy(_flips, state.flips, sizeof(_flips));
+}
+
+uint16_t EpdGhostTracker::_score(uint8_t tile) const
+{
+  // 底边一行块只有部分落在面板内，翻转预算按实际面积
+  uint8_t ty = tile / EPD_GHOST_COLS;
+  uint32_t rows = EPD_GHOST_PANEL_H - ty * EPD_GHOST_TILE;
+  if (rows > EPD_GHOST_TILE) rows = EPD_GHOST_TILE;
+  uint32_t flip_budget = rows * EPD_GHOST_TILE * _budget.flip_pct / 100;
+  uint32_t weight_budget = uint32_t(_budget.partials) * WEIGHT_STANDARD;
+  uint32_t a = weight_budget ? uint32_t(_weight[tile]) * 100 / weight_budget : 0;
+  uint32_t b = flip_budget ? uint32_t(_flips[tile]) * 100 / flip_budget : 0;
+  uint32_t s = a > b ? a : b;
+  return s > 0xFFFF ? 0xFFFF : s;
+}
+
+uint16_t EpdGhostTracker::worst() const
+{
+  uint16_t w = 0;
+  for (uint8_t i = 0; i < EPD_GHOST_COLS * EPD_GHOST_ROWS; i++)
+  {
+    uint16_t s = _score(i);
+    if (s > w) w = s;
+  }
+  return w;
+}
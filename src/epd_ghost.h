@@ -0,0 +1,91 @@
+// epd_ghost.h
+// 重影预算：按区域累计局部刷新次数与翻转的像素数，决定何时需要全刷、能否推迟到空闲时
+#ifndef EPD_GHOST_H
+#define EPD_GHOST_H
+
+#include <Arduino.h>
+
+// 统计粒度：面板按物理坐标划成32x32像素的块（128x296为4x10块）
+#define EPD_GHOST_TILE 32
+#define EPD_GHOST_COLS ((128 + EPD_GHOST_TILE - 1) / EPD_GHOST_TILE)
+#define EPD_GHOST_ROWS ((296 + EPD_GHOST_TILE - 1) / EPD_GHOST_TILE)
+
+// 默认预算：任一块累计10次标准波形局部刷新，或平均每个像素翻转3次，即需要全刷；
+// 超出预算一倍时不再等空闲，当次更新直接改为全刷
+#ifndef EPD_GHOST_PARTIALS
+#define EPD_GHOST_PARTIALS 10
+#endif
+#ifndef EPD_GHOST_FLIP_PCT
+#define EPD_GHOST_FLIP_PCT 300
+#endif
+#ifndef EPD_GHOST_HARD_PCT
+#define EPD_GHOST_HARD_PCT 200
+#endif
+
+// 各块的累计值（深睡眠前保存到RTC内存，见epd_retain.h），不含统计计数
+struct EpdGhostState
+{
+  uint16_t weight[EPD_GHOST_COLS * EPD_GHOST_ROWS];
+  uint16_t flips[EPD_GHOST_COLS * EPD_GHOST_ROWS];
+};
+
+struct EpdGhostBudget
+{
+  uint8_t partials;    // 每块允许的标准波形局部刷新次数
+  uint16_t flip_pct;   // 每块允许的翻转像素数（块面积的百分比）
+  uint16_t hard_pct;   // 超过预算的这个百分比时立即全刷（<=100表示从不推迟）
+};
+
+/**
+ * 驱动（GxEPD2_290_Ext::setGhostTracker()）在写入控制器RAM时报告翻转的像素，
+ * 每次局部刷新报告窗口与所用波形的权重，每次全刷清零。
+ * 块的得分为两项中较大的占预算百分比；最高得分达到100即due()，推迟到空闲时
+ * （见GxEPD2_290_Ext::refreshIfGhosted()）；达到hard_pct即urgent()，驱动把当次局部刷新改为全刷。
+ */
+class EpdGhostTracker
+{
+  public:
+    // 局部刷新权重的单位：标准波形一次为4（更快的波形重影更多，权重更大）
+    static const uint8_t WEIGHT_STANDARD = 4;
+
+    EpdGhostTracker();
+
+    void setBudget(const EpdGhostBudget& budget) { _budget = budget; }
+    const EpdGhostBudget& budget() const { return _budget; }
+
+    // 驱动调用（物理坐标）
+    void addFlips(int16_t x, int16_t y, uint16_t count);
+    void addArea(int16_t x, int16_t y, int16_t w, int16_t h);   // 无法逐像素比较时按整个区域都翻转计
+    void partialRefresh(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t weight = WEIGHT_STANDARD);
+    void fullRefresh();
+    // 屏幕内容不完全可信（如断电前的快照可能比屏幕旧）：不论得分，下次空闲时全刷
+    void requestFullRefresh() { _requested = true; }
+
+    // 保存/恢复各块的累计值：唤醒后接着深睡眠前的预算计算，不会每次唤醒都从零开始
+    void saveState(EpdGhostState& state) const;
+    void restoreState(const EpdGhostState& state);
+
+    // 最高的块得分（占预算百分比）
+    uint16_t worst() const;
+    bool due() const { return _requested || (worst() >= 100); }
+    bool urgent() const { return worst() >= _budget.hard_pct; }
+
+    // 统计：全刷次数、其中因超出预算当次改为全刷的次数、空闲时补做的次数
+    uint32_t fullRefreshes() const { return _full; }
+    uint32_t promotions() const { return _promoted; }
+    uint32_t idleRefreshes() const { return _idle; }
+    void countPromotion() { _promoted++; }
+    void countIdleRefresh() { _idle++; }
+
+  private:
+    uint16_t _score(uint8_t tile) const;
+
+  private:
+    EpdGhostBudget _budget;
+    uint16_t _weight[EPD_GHOST_COLS * EPD_GHOST_ROWS];  // 局部刷新权重累计
+    uint16_t _flips[EPD_GHOST_COLS * EPD_GHOST_ROWS];   // 翻转像素累计（饱和）
+    uint32_t _full, _promoted, _idle;
+    bool _requested;
+};
+
+#endif
@@ -0,0 +1,43 @@
+// epd_lut.cpp
+// 局部刷新波形表
+#include "epd_lut.h"
+
+// 电压选择与GxEPD2_290::LUTDefault_part相同，前7个子阶段驱动，其余为0
+#define EPD_LUT_PART_VS 0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+
+static const uint8_t lutStandard[EPD_LUT_SIZE] PROGMEM =
+{
+  EPD_LUT_PART_VS,
+  0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t lutFast[EPD_LUT_SIZE] PROGMEM =
+{
+  EPD_LUT_PART_VS,
+  0x22, 0x22, 0x22, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t lutTurbo[EPD_LUT_SIZE] PROGMEM =
+{
+  EPD_LUT_PART_VS,
+  0x11, 0x11, 0x11, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t lutQuality[EPD_LUT_SIZE] PROGMEM =
+{
+  EPD_LUT_PART_VS,
+  0x66, 0x44, 0x66, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const EpdLutInfo lutProfiles[EPD_LUT_PROFILE_COUNT] =
+{
+  { "standard", lutStandard, 20, 300 },
+  { "fast", lutFast, 14, 210 },
+  { "turbo", lutTurbo, 8, 120 },
+  { "quality", lutQuality, 36, 540 }
+};
+
+const EpdLutInfo& epdLutInfo(EpdLutProfile profile)
+{
+  return lutProfiles[profile < EPD_LUT_PROFILE_COUNT ? profile : EPD_LUT_STANDARD];
+}
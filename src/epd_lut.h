@@ -0,0 +1,42 @@
+// epd_lut.h
+// GDEH029A1（SSD1608）局部刷新波形表（LUT）：在原驱动默认局部LUT之外提供更快/更清晰的几档，每次更新前可选
+#ifndef EPD_LUT_H
+#define EPD_LUT_H
+
+#include <Arduino.h>
+
+/**
+ * SSD1608的LUT共30字节：前20字节为20个子阶段的电压选择（每字节4种像素跳变各2位），
+ * 后10字节为各子阶段的帧数（每字节两个子阶段各占半字节）。刷新时间基本与总帧数成正比，
+ * 帧数越少越快，但每次残留的对比度差越大（重影累积越快，需要更频繁的全刷清除）。
+ *
+ * 各档使用同一组电压序列，只改帧数：
+ *   标准   20帧  GxEPD2_290的默认局部LUT
+ *   快速   14帧  数字/计数器等频繁更新的小区域
+ *   极速    8帧  延迟优先，对比度明显下降
+ *   清晰   36帧  静态文本、图片的局部更新，重影最少
+ * refresh_ms为按帧数折算的标称刷新时间（以标准档300ms为基准）；实测值见
+ * GxEPD2_290_Ext::lutRefreshMicros()，runRefreshBenchmark()可按档位扫描并输出（见epd_benchmark.h）
+ */
+enum EpdLutProfile
+{
+  EPD_LUT_STANDARD,
+  EPD_LUT_FAST,
+  EPD_LUT_TURBO,
+  EPD_LUT_QUALITY,
+  EPD_LUT_PROFILE_COUNT
+};
+
+#define EPD_LUT_SIZE 30
+
+struct EpdLutInfo
+{
+  const char* name;
+  const uint8_t* lut;   // EPD_LUT_SIZE字节，PROGMEM
+  uint8_t frames;
+  uint16_t refresh_ms;  // 标称刷新时间
+};
+
+const EpdLutInfo& epdLutInfo(EpdLutProfile profile);
+
+#endif
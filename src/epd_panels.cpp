@@ -0,0 +1,162 @@
+// epd_panels.cpp
+// 多面板管理实现
+#include "epd_panels.h"
+
+EpdPanelSet::EpdPanelSet(SPIClass& spi, SPISettings settings) :
+  _spi(spi), _settings(settings), _bus(0), _count(0),
+  _start_us(0), _last_us(0), _last_refresh_us(0), _refresh_base(0)
+{
+  memset(_slots, 0, sizeof(_slots));
+}
+
+int8_t EpdPanelSet::add(EpdDisplay& panel, EpdBusyWait* busy)
+{
+  if (_count >= EPD_MAX_PANELS) return -1;
+  Slot& s = _slots[_count];
+  s.owner = this;
+  s.display = &panel;
+  s.busy_wait = busy;
+  return _count++;
+}
+
+bool EpdPanelSet::begin(bool init)
+{
+  if (!_bus) _bus = xSemaphoreCreateMutex();
+  if (!_bus) return false;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    Slot& s = _slots[i];
+    if (s.task) continue;
+    EpdDisplay& d = *s.display;
+    d.epd2.selectSPI(_spi, _settings);
+    if (init) d.init();
+    if (s.busy_wait) d.epd2.setBusyWait(s.busy_wait, EPD_BUSY_IRQ);
+    d.epd2.setSharedBus(_bus);
+    if (!s.jobs) s.jobs = xQueueCreate(1, sizeof(Job));
+    if (!s.done) s.done = xSemaphoreCreateBinary();
+    if (!s.jobs || !s.done) return false;
+    if (xTaskCreate(_task, "epd_panel", EPD_PANEL_STACK, &s, 1, &s.task) != pdPASS)
+    {
+      s.task = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+void EpdPanelSet::end()
+{
+  // 回调与关电标志都为空的请求让工作任务退出
+  Job job = { 0, 0, false, false };
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    Slot& s = _slots[i];
+    if (!_submit(i, job)) continue;
+    xSemaphoreTake(s.done, portMAX_DELAY);
+    s.pending = false;
+    s.task = 0;
+    s.display->epd2.setSharedBus(0);
+  }
+}
+
+bool EpdPanelSet::draw(uint8_t i, EpdPanelDraw cb, const void* pv, bool partial_update_mode)
+{
+  if ((i >= _count) || !cb) return false;
+  Job job = { cb, pv, partial_update_mode, false };
+  return _submit(i, job);
+}
+
+void EpdPanelSet::powerOff()
+{
+  Job job = { 0, 0, false, true };
+  for (uint8_t i = 0; i < _count; i++) _submit(i, job);
+  wait();
+}
+
+bool EpdPanelSet::_submit(uint8_t i, const Job& job)
+{
+  Slot& s = _slots[i];
+  if (!s.task) return false;
+  if (s.pending)
+  {
+    xSemaphoreTake(s.done, portMAX_DELAY);
+    s.pending = false;
+  }
+  // 新一轮的起点：此前的请求都已完成
+  if (!busy())
+  {
+    _start_us = micros();
+    _refresh_base = _refreshSum();
+  }
+  s.pending = true;
+  xQueueSend(s.jobs, &job, portMAX_DELAY);
+  return true;
+}
+
+void EpdPanelSet::wait()
+{
+  bool any = false;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    Slot& s = _slots[i];
+    if (!s.pending) continue;
+    xSemaphoreTake(s.done, portMAX_DELAY);
+    s.pending = false;
+    any = true;
+  }
+  if (!any) return;
+  _last_us = micros() - _start_us;
+  _last_refresh_us = _refreshSum() - _refresh_base;
+}
+
+bool EpdPanelSet::busy() const
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_slots[i].pending) return true;
+  }
+  return false;
+}
+
+uint32_t EpdPanelSet::_refreshSum()
+{
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < _count; i++) sum += _slots[i].display->epd2.refreshMicros();
+  return sum;
+}
+
+// 在工作任务中、持有总线时执行；驱动等待BUSY时总线交给其它面板
+void EpdPanelSet::_run(Slot& s, const Job& job)
+{
+  EpdDisplay& d = *s.display;
+  if (job.power_off)
+  {
+    d.powerOff();
+    return;
+  }
+  if (job.partial) d.setPartialWindow(0, 0, d.width(), d.height());
+  else d.setFullWindow();
+  d.firstPage();
+  do
+  {
+    job.cb(d, job.pv);
+  }
+  while (d.nextPage());
+}
+
+void EpdPanelSet::_task(void* arg)
+{
+  Slot& s = *(Slot*)arg;
+  Job job;
+  for (;;)
+  {
+    if (xQueueReceive(s.jobs, &job, portMAX_DELAY) != pdTRUE) continue;
+    if (!job.cb && !job.power_off) break;
+    xSemaphoreTake(s.owner->_bus, portMAX_DELAY);
+    s.owner->_run(s, job);
+    xSemaphoreGive(s.owner->_bus);
+    xSemaphoreGive(s.done);
+  }
+  xSemaphoreGive(s.done);
+  vTaskDelete(0);
+}
@@ -0,0 +1,87 @@
+// epd_panels.h
+// 多面板管理：同一条SPI总线上的几块GDEH029A1各有CS与BUSY（DC可以共用），每块一个显示缓冲区与工作任务，
+// 一块面板刷新（BUSY）期间向另一块传输数据，N块面板的更新时间接近一次刷新加N次传输
+#ifndef EPD_PANELS_H
+#define EPD_PANELS_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "epd_display.h"
+
+#define EPD_MAX_PANELS 4
+#define EPD_PANEL_STACK 8192    // 工作任务的栈（回调在其中绘制，CJK排版在栈上有暂存区）
+
+// 面板绘图回调：每页调用一次，在gfx上绘制完整画面（多块面板不能再用全局display）
+typedef void (*EpdPanelDraw)(EpdDisplay& gfx, const void* pv);
+
+/**
+ * 总线互斥量串行化所有面板的绘制与传输：工作任务持有它执行firstPage()/nextPage()循环，
+ * 只在驱动等待BUSY时交出（GxEPD2_290_Ext::setSharedBus()），所以任一时刻只有一个任务在绘图，
+ * 字形缓存等共享状态不需要另外加锁。各面板的刷新在时间上重叠，总线上的传输仍是先后进行的。
+ *
+ * 面板加入后只能经本类驱动：调用者在draw()与wait()之间不能直接操作这些显示对象。
+ * 共用总线的面板不能启用DMA传输（EpdTransport独占HSPI），加入前先setTransport(0)。
+ * 所有面板的CS要在任何一块面板通信之前拉高，未初始化的面板CS悬空时会收到别的面板的数据。
+ */
+class EpdPanelSet
+{
+  public:
+    EpdPanelSet(SPIClass& spi, SPISettings settings);
+
+    // 加入一块面板（显示对象已用各自的引脚构造），busy非0时以中断方式等待BUSY；返回序号，满了返回-1
+    int8_t add(EpdDisplay& panel, EpdBusyWait* busy = 0);
+    // 初始化所有面板（init()）并创建工作任务；init为false时面板已经初始化过
+    bool begin(bool init = true);
+    // 等待完成后结束工作任务，面板恢复独占总线，可以再直接使用
+    void end();
+    uint8_t count() const { return _count; }
+    EpdDisplay& panel(uint8_t i) { return *_slots[i].display; }
+
+    // 请求整屏重画第i块面板，刷新方式与display(partial_update_mode)相同；排队后立即返回，
+    // 回调与参数在更新完成前都要保持有效。上一次请求还没完成时先等它完成
+    bool draw(uint8_t i, EpdPanelDraw cb, const void* pv, bool partial_update_mode = true);
+    // 所有面板关电（同样并行等待BUSY），完成后返回
+    void powerOff();
+    // 等待所有已请求的更新完成
+    void wait();
+    bool busy() const;
+
+    // 统计：最近一次wait()从最早的请求到全部完成的时间、期间各面板刷新（BUSY）时间之和
+    uint32_t lastMicros() const { return _last_us; }
+    uint32_t lastRefreshMicros() const { return _last_refresh_us; }
+
+  private:
+    struct Job
+    {
+      EpdPanelDraw cb;
+      const void* pv;
+      bool partial;
+      bool power_off;
+    };
+    struct Slot
+    {
+      EpdPanelSet* owner;
+      EpdDisplay* display;
+      EpdBusyWait* busy_wait;
+      TaskHandle_t task;
+      QueueHandle_t jobs;
+      SemaphoreHandle_t done;
+      bool pending;           // 已请求，wait()尚未确认完成
+    };
+
+    bool _submit(uint8_t i, const Job& job);
+    void _run(Slot& s, const Job& job);
+    uint32_t _refreshSum();
+    static void _task(void* arg);
+
+  private:
+    SPIClass& _spi;
+    SPISettings _settings;
+    SemaphoreHandle_t _bus;
+    Slot _slots[EPD_MAX_PANELS];
+    uint8_t _count;
+    uint32_t _start_us, _last_us, _last_refresh_us;
+    uint32_t _refresh_base;   // 本轮开始时各面板refreshMicros()之和
+};
+
+#endif
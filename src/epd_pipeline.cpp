@@ -0,0 +1,103 @@
+// epd_pipeline.cpp
+// EpdDisplay::drawPipelined()：渲染与传输分在两个核上的流水线分页绘制
+#include "epd_display.h"
+
+#define EPD_PIPELINE_PAGES ((GxEPD2_DRIVER_CLASS::HEIGHT + EPD_PIPELINE_PAGE_ROWS - 1) / EPD_PIPELINE_PAGE_ROWS)
+
+bool EpdDisplay::drawPipelined(void (*drawCallback)(const void*), const void* pv, bool partial_update_mode)
+{
+  if (!_startPipeline())
+  {
+    if (partial_update_mode) setPartialFullWindow();
+    else setFullWindow();
+    firstPage();
+    do
+    {
+      drawCallback(pv);
+    }
+    while (nextPage());
+    return false;
+  }
+  _previous_valid = false; // 屏幕内容被整体替换
+  _beginUpdate();
+
+  // 与GxEPD2_BW::display()相同：写入、刷新，支持快速局部刷新的控制器刷新后再写一遍；
+  // 第二遍的前两页在刷新期间就已渲染好
+  _job_cb = drawCallback;
+  _job_pv = pv;
+  _job_passes = epd2.hasFastPartialUpdate ? 2 : 1;
+  xTaskNotifyGive(_render_task);
+  for (uint8_t pass = 0; pass < _job_passes; pass++)
+  {
+    for (uint16_t k = 0; k < EPD_PIPELINE_PAGES; k++)
+    {
+      uint8_t b;
+      xQueueReceive(_ready_q, &b, portMAX_DELAY);
+      int16_t y = k * EPD_PIPELINE_PAGE_ROWS;
+      int16_t h = HEIGHT - y < EPD_PIPELINE_PAGE_ROWS ? HEIGHT - y : EPD_PIPELINE_PAGE_ROWS;
+      // 启用DMA传输时数据已复制到DMA暂存区，缓冲可以立即交还渲染任务
+      if (pass) epd2.writeImageAgain(_page_buf[b], 0, y, WIDTH, h);
+      else epd2.writeImage(_page_buf[b], 0, y, WIDTH, h);
+      xQueueSend(_free_q, &b, portMAX_DELAY);
+    }
+    if (!pass) epd2.refresh(partial_update_mode);
+  }
+  _endUpdate();
+  return true;
+}
+
+bool EpdDisplay::_startPipeline()
+{
+  if (_render_task) return true;
+  const size_t size = (WIDTH / 8) * EPD_PIPELINE_PAGE_ROWS;
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (!_page_buf[i]) _page_buf[i] = (uint8_t*)malloc(size);
+    if (!_page_buf[i]) return false;
+  }
+  if (!_free_q) _free_q = xQueueCreate(2, sizeof(uint8_t));
+  if (!_ready_q) _ready_q = xQueueCreate(2, sizeof(uint8_t));
+  if (!_free_q || !_ready_q) return false;
+  for (uint8_t i = 0; i < 2; i++) xQueueSend(_free_q, &i, 0);
+  if (xTaskCreatePinnedToCore(_renderTask, "epd_render", EPD_PIPELINE_STACK, this, 1, &_render_task, EPD_PIPELINE_CORE) != pdPASS)
+  {
+    _render_task = 0;
+    return false;
+  }
+  return true;
+}
+
+void EpdDisplay::_renderPage(uint8_t buf, uint16_t page)
+{
+  _target_y = page * EPD_PIPELINE_PAGE_ROWS;
+  _target_h = HEIGHT - _target_y < EPD_PIPELINE_PAGE_ROWS ? HEIGHT - _target_y : EPD_PIPELINE_PAGE_ROWS;
+  _target = _page_buf[buf];
+  _page_clip_valid = false;
+  EPD_TRACE_BEGIN(EPD_TRACE_PAGE, page);
+  fillScreen(GxEPD_WHITE); // 与GxEPD2_BW一样，每页从白底开始
+  _job_cb(_job_pv);
+  EPD_TRACE_END(EPD_TRACE_PAGE, page);
+  // 交出缓冲之前恢复普通绘制，最后一页交出后调用者可能马上就要绘图
+  _target = 0;
+  _page_clip_valid = false;
+}
+
+// 渲染任务：等待drawPipelined()的通知，按页渲染，没有空闲缓冲时阻塞（背压）
+void EpdDisplay::_renderTask(void* arg)
+{
+  EpdDisplay* d = (EpdDisplay*)arg;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    for (uint8_t pass = 0; pass < d->_job_passes; pass++)
+    {
+      for (uint16_t k = 0; k < EPD_PIPELINE_PAGES; k++)
+      {
+        uint8_t b;
+        xQueueReceive(d->_free_q, &b, portMAX_DELAY);
+        d->_renderPage(b, k);
+        xQueueSend(d->_ready_q, &b, portMAX_DELAY);
+      }
+    }
+  }
+}
@@ -0,0 +1,29 @@
+// epd_retain.cpp
+// 深睡眠保留数据的校验
+#include "epd_retain.h"
+
+// FNV-1a，从checksum之后的字段算起
+static uint32_t retainedChecksum(const EpdRetainedFrame& r)
+{
+  const uint8_t* p = (const uint8_t*)&r.rotation;
+  const uint8_t* end = (const uint8_t*)&r + sizeof(r);
+  uint32_t h = 2166136261ul;
+  while (p < end) h = (h ^ *p++) * 16777619ul;
+  return h;
+}
+
+void epdRetainedSeal(EpdRetainedFrame& r)
+{
+  r.magic = EPD_RETAIN_MAGIC;
+  r.checksum = retainedChecksum(r);
+}
+
+bool epdRetainedValid(const EpdRetainedFrame& r)
+{
+  return (r.magic == EPD_RETAIN_MAGIC) && (r.checksum == retainedChecksum(r));
+}
+
+void epdRetainedClear(EpdRetainedFrame& r)
+{
+  r.magic = 0;
+}
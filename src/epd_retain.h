@@ -0,0 +1,42 @@
+// epd_retain.h
+// 深睡眠保留：最后显示的一帧与窗口状态放在RTC慢速内存中，唤醒后第一次更新仍是差分局部刷新
+#ifndef EPD_RETAIN_H
+#define EPD_RETAIN_H
+
+#include <Arduino.h>
+#include "dirty_region.h"
+#include "epd_ghost.h"
+
+#define EPD_RETAIN_MAGIC 0x45505231ul  // "EPR1"，结构改变时修改
+#define EPD_RETAIN_FRAME_SIZE (128 / 8 * 296)
+
+/**
+ * 只含POD成员，可用RTC_DATA_ATTR定义（带构造函数的对象每次启动都会重新构造，唤醒后的内容就丢了）。
+ * 约4.9KB，ESP32的RTC慢速内存共8KB。
+ *
+ * 用法：深睡眠前EpdDisplay::retain()保存，再hibernate()；唤醒后先用epdRetainedValid()判断，
+ * 有效时以init(0, false)初始化（不清屏、第一次刷新不强制全刷），开启差分传输后EpdDisplay::restore()。
+ * 前提是深睡眠期间面板保持供电：SSD1608的RAM在深睡眠与硬件复位后保留，控制器里仍是这一帧；
+ * 面板断电的接法不能这样恢复，照常init()全刷。
+ */
+struct EpdRetainedFrame
+{
+  uint32_t magic;
+  uint32_t checksum;            // 其余字段的校验和（epdRetainedSeal()计算）
+  uint8_t rotation;
+  bool previous_valid;
+  DirtyRect previous;           // 上一次跟踪更新的内容区域（物理坐标），唤醒后第一次updateDirty()据此擦除
+  DirtyRect last_window;        // 最近一次updateDirty()刷新的窗口（逻辑坐标）
+  bool has_ghost;
+  EpdGhostState ghost;          // 重影预算的累计值
+  uint8_t frame[EPD_RETAIN_FRAME_SIZE];  // 面板RAM内容（物理方向，每行16字节）
+};
+
+// 计算校验和并写入magic
+void epdRetainedSeal(EpdRetainedFrame& r);
+// magic与校验和都对得上（冷启动时RTC内存是随机内容）
+bool epdRetainedValid(const EpdRetainedFrame& r);
+// 作废（如改为全刷启动之后）
+void epdRetainedClear(EpdRetainedFrame& r);
+
+#endif
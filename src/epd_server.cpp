@@ -0,0 +1,307 @@
+// epd_server.cpp
+// 串口显示服务实现
+#include "epd_server.h"
+
+static uint16_t readU16(const uint8_t* p)
+{
+  return p[0] | (uint16_t(p[1]) << 8);
+}
+
+EpdServer::EpdServer(EpdDisplay& display) :
+  _display(display), _port(0), _width(0), _height(0), _pending_full(false),
+  _rx_state(RX_SYNC), _rx_count(0), _rx_len(0), _rx_ms(0), _last_valid(false), _last_seq(0), _last_crc(0),
+  _line_handler(0), _line_ctx(0), _line_len(0),
+  _frames(0), _errors(0), _refreshes(0), _payload_bytes(0)
+{
+  memset(_header, 0, sizeof(_header));
+}
+
+void EpdServer::begin(Stream& port)
+{
+  _port = &port;
+  _width = _display.width();
+  _height = _display.height();
+  memset(_frame, 0, sizeof(_frame));
+  _pending.clear();
+  _pending_full = false;
+  _rx_state = RX_SYNC;
+  _last_valid = false;
+  _line_len = 0;
+}
+
+uint32_t EpdServer::frameHash() const
+{
+  uint32_t h = 2166136261ul;
+  for (uint16_t i = 0; i < sizeof(_frame); i++) h = (h ^ _frame[i]) * 16777619ul;
+  return h;
+}
+
+bool EpdServer::poll()
+{
+  if (!_port) return false;
+  if ((_rx_state != RX_SYNC) && (millis() - _rx_ms > EPD_SERVER_BYTE_TIMEOUT_MS))
+  {
+    // 只收到了一部分：seq已收到时带回，否则为0
+    _reply(EPD_SERVER_NAK, _rx_state > RX_HEADER || _rx_count > 1 ? _header[1] : 0, EPD_SERVER_ERR_TIMEOUT);
+    _errors++;
+    _rx_state = RX_SYNC;
+  }
+  while (_port->available())
+  {
+    int c = _port->read();
+    if (c < 0) break;
+    _rx_ms = millis();
+    switch (_rx_state)
+    {
+      case RX_SYNC:
+        if (c == EPD_SERVER_SYNC)
+        {
+          _rx_state = RX_HEADER;
+          _rx_count = 0;
+        }
+        else _lineByte(c);
+        break;
+      case RX_HEADER:
+        _header[_rx_count++] = c;
+        if (_rx_count < sizeof(_header)) break;
+        _rx_len = readU16(_header + 2);
+        _rx_count = 0;
+        if (_rx_len > EPD_SERVER_MAX_PAYLOAD)
+        {
+          _reply(EPD_SERVER_NAK, _header[1], EPD_SERVER_ERR_TOO_BIG);
+          _errors++;
+          _rx_state = RX_SYNC;
+        }
+        else _rx_state = RX_PAYLOAD;
+        break;
+      default:
+        // 负载与校验和连续存放
+        _rx[_rx_count++] = c;
+        if (_rx_count < _rx_len + 2) break;
+        _rx_state = RX_SYNC;
+        // 每次最多处理一帧，loop()中的其它工作（空闲全刷、快照等）不会被连续的帧饿死
+        return _handle();
+    }
+  }
+  return false;
+}
+
+bool EpdServer::_handle()
+{
+  uint8_t type = _header[0];
+  uint8_t seq = _header[1];
+  uint16_t crc = crc16(crc16(0xFFFF, _header, sizeof(_header)), _rx, _rx_len);
+  if (crc != readU16(_rx + _rx_len))
+  {
+    _reply(EPD_SERVER_NAK, seq, EPD_SERVER_ERR_CRC);
+    _errors++;
+    return false;
+  }
+  if (type == EPD_SERVER_HELLO)
+  {
+    // 新的连接从seq 0重新开始，不能与上一个连接的最后一帧比较
+    _last_valid = false;
+    _sendInfo(seq);
+    return false;
+  }
+  // 主机没收到ACK而重发的同一帧
+  if (_last_valid && (seq == _last_seq) && (crc == _last_crc))
+  {
+    _reply(EPD_SERVER_ACK, seq, 0);
+    _send(EPD_SERVER_DONE, seq, 0, 0);
+    return false;
+  }
+  uint8_t status = 0;
+  if (!_apply(type, _rx, _rx_len, status))
+  {
+    _reply(EPD_SERVER_NAK, seq, status);
+    _errors++;
+    return false;
+  }
+  _frames++;
+  _payload_bytes += _rx_len;
+  _last_valid = true;
+  _last_seq = seq;
+  _last_crc = crc;
+  _reply(EPD_SERVER_ACK, seq, 0);
+  if (_rx[0] & EPD_SERVER_DEFER) return false;
+  bool refreshed = _refresh((_rx[0] & EPD_SERVER_FULL) || _pending_full);
+  _send(EPD_SERVER_DONE, seq, 0, 0);
+  return refreshed;
+}
+
+bool EpdServer::_apply(uint8_t type, const uint8_t* p, uint16_t len, uint8_t& status)
+{
+  status = EPD_SERVER_ERR_LENGTH;
+  if (len < 1) return false;
+  uint8_t flags = p[0];
+  bool compressed = flags & EPD_SERVER_COMPRESSED;
+  int16_t x = 0, y = 0, w = _width, h = _height;
+  switch (type)
+  {
+    case EPD_SERVER_FRAME:
+      p += 1;
+      len -= 1;
+      break;
+    case EPD_SERVER_RECT:
+      if (len < 9) return false;
+      x = readU16(p + 1);
+      y = readU16(p + 3);
+      w = readU16(p + 5);
+      h = readU16(p + 7);
+      p += 9;
+      len -= 9;
+      if ((x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (x + w > _width) || (y + h > _height))
+      {
+        status = EPD_SERVER_ERR_RECT;
+        return false;
+      }
+      break;
+    case EPD_SERVER_REFRESH:
+      if (flags & EPD_SERVER_FULL) _pending_full = true;
+      return true;
+    default:
+      status = EPD_SERVER_ERR_TYPE;
+      return false;
+  }
+  if (!_blit(x, y, w, h, p, len, compressed))
+  {
+    status = compressed ? EPD_SERVER_ERR_DATA : EPD_SERVER_ERR_LENGTH;
+    return false;
+  }
+  _pending.add(x, y, w, h);
+  if (flags & EPD_SERVER_FULL) _pending_full = true;
+  return true;
+}
+
+bool EpdServer::_blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* data, uint16_t len, bool compressed)
+{
+  uint16_t rb = (w + 7) / 8;
+  uint16_t fb = (_width + 7) / 8;
+  if (compressed)
+  {
+    // 先完整检查一遍，出错时帧缓冲保持原样（与主机缓存的上一帧一致）
+    ServerUnpacker check(data, len);
+    for (int16_t r = 0; r < h; r++)
+      if (!check.read(0, rb)) return false;
+    if (!check.done()) return false;
+  }
+  else if (len != uint32_t(rb) * h) return false;
+
+  ServerUnpacker unpack(data, len);
+  uint8_t row[(296 + 7) / 8];   // 最长的一行（横屏）
+  for (int16_t r = 0; r < h; r++)
+  {
+    const uint8_t* src = data + uint32_t(r) * rb;
+    if (compressed)
+    {
+      unpack.read(row, rb);
+      src = row;
+    }
+    uint8_t* dst = _frame + uint32_t(y + r) * fb;
+    if ((x & 7) == 0)
+    {
+      // 字节对齐：整字节复制，只有最后一个字节要保留矩形右边的像素
+      uint16_t full = w / 8;
+      memcpy(dst + x / 8, src, full);
+      if (w & 7)
+      {
+        uint8_t mask = 0xFF << (8 - (w & 7));
+        dst[x / 8 + full] = (dst[x / 8 + full] & ~mask) | (src[full] & mask);
+      }
+      continue;
+    }
+    for (int16_t i = 0; i < w; i++)
+    {
+      uint8_t bit = 0x80 >> ((x + i) & 7);
+      if (src[i / 8] & (0x80 >> (i & 7))) dst[(x + i) / 8] |= bit;
+      else dst[(x + i) / 8] &= ~bit;
+    }
+  }
+  return true;
+}
+
+bool EpdServer::_refresh(bool full)
+{
+  if (_pending.isEmpty() && !full) return false;
+  if (full)
+  {
+    // 全刷清除残影：整个帧缓冲按GxEPD2的全刷流程绘制
+    _display.setFullWindow();
+    _display.firstPage();
+    do
+    {
+      _drawFrame(this);
+    }
+    while (_display.nextPage());
+  }
+  else _display.updateWindow(_drawFrame, this, _display.toPhysical(_pending.bounds()));
+  _pending.clear();
+  _pending_full = false;
+  _refreshes++;
+  return true;
+}
+
+void EpdServer::_drawFrame(const void* pv)
+{
+  const EpdServer* s = (const EpdServer*)pv;
+  s->_display.drawBitmap(0, 0, s->_frame, s->_width, s->_height, GxEPD_BLACK, GxEPD_WHITE);
+}
+
+void EpdServer::_sendInfo(uint8_t seq)
+{
+  uint8_t info[14];
+  uint32_t hash = frameHash();
+  info[0] = EPD_SERVER_VERSION;
+  info[1] = _width & 0xFF;
+  info[2] = _width >> 8;
+  info[3] = _height & 0xFF;
+  info[4] = _height >> 8;
+  info[5] = _display.getRotation();
+  info[6] = EPD_SERVER_MAX_PAYLOAD & 0xFF;
+  info[7] = EPD_SERVER_MAX_PAYLOAD >> 8;
+  info[8] = EPD_SERVER_RX_BUFFER & 0xFF;
+  info[9] = (EPD_SERVER_RX_BUFFER >> 8) & 0xFF;
+  for (uint8_t i = 0; i < 4; i++) info[10 + i] = hash >> (8 * i);
+  _send(EPD_SERVER_INFO, seq, info, sizeof(info));
+}
+
+void EpdServer::_send(uint8_t type, uint8_t seq, const uint8_t* payload, uint16_t len)
+{
+  uint8_t head[5] = { EPD_SERVER_SYNC, type, seq, uint8_t(len & 0xFF), uint8_t(len >> 8) };
+  uint16_t crc = crc16(crc16(0xFFFF, head + 1, 4), payload, len);
+  uint8_t tail[2] = { uint8_t(crc & 0xFF), uint8_t(crc >> 8) };
+  _port->write(head, sizeof(head));
+  if (len) _port->write(payload, len);
+  _port->write(tail, sizeof(tail));
+}
+
+// CRC-16/CCITT-FALSE，逐位计算（一帧最多约4.7KB，相对串口传输时间可忽略）
+uint16_t EpdServer::crc16(uint16_t crc, const uint8_t* p, uint16_t n)
+{
+  while (n--)
+  {
+    crc ^= uint16_t(*p++) << 8;
+    for (uint8_t i = 0; i < 8; i++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// 帧之外的可打印字符按行交给回调，其它字节（如不完整帧的残余）丢弃当前行
+void EpdServer::_lineByte(uint8_t c)
+{
+  if ((c == '\n') || (c == '\r'))
+  {
+    if (_line_len && _line_handler)
+    {
+      _line[_line_len] = 0;
+      _line_handler(_line, _line_ctx);
+    }
+    _line_len = 0;
+  }
+  else if ((c >= 0x20) && (c < 0x7F))
+  {
+    if (_line_len < sizeof(_line) - 1) _line[_line_len++] = c;
+  }
+  else _line_len = 0;
+}
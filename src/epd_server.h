@@ -0,0 +1,192 @@
+// epd_server.h
+// 串口显示服务：主机（Linux）经串口发送整帧、压缩帧或矩形差分，设备更新帧缓冲并局部刷新对应窗口。
+// 主机端工具见tools/epd_send.py
+//
+// 帧格式（多字节字段为小端）：
+//   0  0xE5         同步字节
+//   1  uint8  type
+//   2  uint8  seq    主机逐帧递增，应答原样带回
+//   3  uint16 len    负载字节数（不超过EPD_SERVER_MAX_PAYLOAD）
+//   5  负载
+//   .. uint16 crc    CRC-16/CCITT-FALSE（多项式0x1021，初值0xFFFF），覆盖type到负载末尾
+//
+// 主机 -> 设备：
+//   0x01 HELLO    无负载，应答INFO
+//   0x02 FRAME    flags(1) + 整屏图像（当前旋转下的逻辑坐标，每行(width + 7) / 8字节，MSB在左，1为黑）
+//   0x03 RECT     flags(1) + x(2) y(2) w(2) h(2) + 矩形图像（每行(w + 7) / 8字节，第一个字节的最高位是第x列）
+//   0x04 REFRESH  flags(1)：刷新EPD_SERVER_DEFER累积的区域
+// 设备 -> 主机：
+//   0x06 ACK      status(1) = 0：负载已写入帧缓冲
+//   0x15 NAK      status(1)：EPD_SERVER_ERR_*，主机以同一seq重发
+//   0x81 INFO     version(1) width(2) height(2) rotation(1) max_payload(2) rx_buffer(2) frame_hash(4)
+//   0x82 DONE     无负载：seq那一帧触发的刷新已完成
+//
+// flags：EPD_SERVER_COMPRESSED 图像为行程编码（控制字节与压缩位图相同，见compressed_bitmap.h，不带头和组索引）；
+//        EPD_SERVER_DEFER 只更新帧缓冲并记下区域，与之后的帧一起刷新；EPD_SERVER_FULL 全刷（清除残影）
+#ifndef EPD_SERVER_H
+#define EPD_SERVER_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+
+#define EPD_SERVER_VERSION 1
+#define EPD_SERVER_SYNC 0xE5
+
+#define EPD_SERVER_HELLO   0x01
+#define EPD_SERVER_FRAME   0x02
+#define EPD_SERVER_RECT    0x03
+#define EPD_SERVER_REFRESH 0x04
+#define EPD_SERVER_ACK     0x06
+#define EPD_SERVER_NAK     0x15
+#define EPD_SERVER_INFO    0x81
+#define EPD_SERVER_DONE    0x82
+
+#define EPD_SERVER_COMPRESSED 0x01
+#define EPD_SERVER_DEFER      0x02
+#define EPD_SERVER_FULL       0x04
+
+#define EPD_SERVER_ERR_CRC     1   // 校验和不对
+#define EPD_SERVER_ERR_TOO_BIG 2   // len超过EPD_SERVER_MAX_PAYLOAD
+#define EPD_SERVER_ERR_TYPE    3   // 未知的帧类型
+#define EPD_SERVER_ERR_LENGTH  4   // 负载长度与图像尺寸不符
+#define EPD_SERVER_ERR_RECT    5   // 矩形超出屏幕
+#define EPD_SERVER_ERR_DATA    6   // 行程编码数据不完整或超长
+#define EPD_SERVER_ERR_TIMEOUT 7   // 一帧没有收完就中断了
+
+#define EPD_SERVER_FRAME_SIZE (128 / 8 * 296)
+#define EPD_SERVER_MAX_PAYLOAD (9 + EPD_SERVER_FRAME_SIZE)   // RECT头 + 整屏
+// 串口接收缓冲区（Serial.setRxBufferSize()，须在Serial.begin()之前）：至少放得下一个最大的帧，
+// 刷新期间主机发来的下一帧暂存在这里
+#ifndef EPD_SERVER_RX_BUFFER
+#define EPD_SERVER_RX_BUFFER 5120
+#endif
+// 帧内两个字节之间的最长间隔（ms），超过时丢弃已收到的部分
+#ifndef EPD_SERVER_BYTE_TIMEOUT_MS
+#define EPD_SERVER_BYTE_TIMEOUT_MS 200
+#endif
+
+// 行程编码解码（与CbmStream相同的控制字节），按输入长度检查越界；out为0时只检查
+class ServerUnpacker
+{
+  public:
+    ServerUnpacker(const uint8_t* p, uint16_t len) : _p(p), _end(p + len), _literal(0), _repeat(0), _value(0) {}
+
+    bool read(uint8_t* out, uint16_t n)
+    {
+      while (n > 0)
+      {
+        if (_repeat)
+        {
+          uint8_t k = _repeat < n ? _repeat : n;
+          if (out) memset(out, _value, k), out += k;
+          n -= k;
+          _repeat -= k;
+        }
+        else if (_literal)
+        {
+          uint8_t k = _literal < n ? _literal : n;
+          if (_end - _p < k) return false;
+          if (out) memcpy(out, _p, k), out += k;
+          _p += k;
+          n -= k;
+          _literal -= k;
+        }
+        else
+        {
+          if (_p >= _end) return false;
+          uint8_t c = *_p++;
+          if (c < 128) _literal = c + 1;
+          else
+          {
+            if (_p >= _end) return false;
+            _repeat = c - 125;
+            _value = *_p++;
+          }
+        }
+      }
+      return true;
+    }
+    // 数据正好用完（多余的字节视为错误）
+    bool done() const { return (_p == _end) && !_literal && !_repeat; }
+
+  private:
+    const uint8_t* _p;
+    const uint8_t* _end;
+    uint8_t _literal, _repeat, _value;
+};
+
+// 帧之外收到的文本行（如energy、trace命令）交给这个回调
+typedef void (*EpdServerLineHandler)(const char* line, void* ctx);
+
+/**
+ * 流控：设备收完一帧、校验并写入帧缓冲后立即ACK，再刷新；主机收到ACK就可以发送下一帧（同一时间最多一帧未应答），
+ * 下一帧在刷新期间进入串口接收缓冲区（INFO中的rx_buffer），刷新完成后设备发送DONE。
+ * 主机超时未收到ACK时以同一seq重发：seq与校验和都与上一帧相同时设备只重发ACK，不重复刷新。
+ *
+ * 帧缓冲是屏幕内容在设备上的副本（当前旋转下的逻辑坐标），每个矩形差分映射为一次局部刷新窗口
+ * （EpdDisplay::updateWindow()，窗口内用整个帧缓冲重画，按字节对齐扩展的部分也是正确的内容）。
+ * INFO中的frame_hash（FNV-1a）让主机判断它缓存的上一帧是否就是设备上的帧缓冲，不是时应先发送整帧。
+ * 设备的调试输出与应答共用串口，主机按同步字节与校验和找出应答。
+ */
+class EpdServer
+{
+  public:
+    EpdServer(EpdDisplay& display);
+
+    // 帧缓冲置为白（屏幕上的内容由主机的第一帧整帧替换）
+    void begin(Stream& port);
+    void setLineHandler(EpdServerLineHandler handler, void* ctx) { _line_handler = handler; _line_ctx = ctx; }
+
+    // 在loop()中调用：读取串口，收完一帧就处理；返回是否刷新了屏幕
+    bool poll();
+
+    uint32_t frameHash() const;
+    // 统计：处理的帧数、NAK数、刷新次数、收到的负载字节数
+    uint32_t frames() const { return _frames; }
+    uint32_t errors() const { return _errors; }
+    uint32_t refreshes() const { return _refreshes; }
+    uint32_t payloadBytes() const { return _payload_bytes; }
+
+    // CRC-16/CCITT-FALSE：crc16(0xFFFF, p, n)，可以分段累加
+    static uint16_t crc16(uint16_t crc, const uint8_t* p, uint16_t n);
+
+  private:
+    bool _handle();
+    bool _apply(uint8_t type, const uint8_t* p, uint16_t len, uint8_t& status);
+    bool _blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t* data, uint16_t len, bool compressed);
+    bool _refresh(bool full);
+    void _send(uint8_t type, uint8_t seq, const uint8_t* payload, uint16_t len);
+    void _reply(uint8_t type, uint8_t seq, uint8_t status) { _send(type, seq, &status, 1); }
+    void _sendInfo(uint8_t seq);
+    void _lineByte(uint8_t c);
+    static void _drawFrame(const void* pv);
+
+  private:
+    enum RxState { RX_SYNC, RX_HEADER, RX_PAYLOAD };
+
+    EpdDisplay& _display;
+    Stream* _port;
+    uint8_t _frame[EPD_SERVER_FRAME_SIZE];
+    int16_t _width, _height;
+    DirtyRegion _pending;       // EPD_SERVER_DEFER累积的区域（逻辑坐标）
+    bool _pending_full;
+
+    RxState _rx_state;
+    uint8_t _header[4];         // type, seq, len
+    uint16_t _rx_count;
+    uint16_t _rx_len;
+    uint8_t _rx[EPD_SERVER_MAX_PAYLOAD + 2];
+    uint32_t _rx_ms;
+    bool _last_valid;
+    uint8_t _last_seq;
+    uint16_t _last_crc;
+
+    EpdServerLineHandler _line_handler;
+    void* _line_ctx;
+    char _line[48];
+    uint8_t _line_len;
+
+    uint32_t _frames, _errors, _refreshes, _payload_bytes;
+};
+
+#endif
@@ -0,0 +1,80 @@
+// epd_snapshot.cpp
+// 闪存快照实现（Preferences/NVS）
+#include "epd_snapshot.h"
+
+// 键名：frame为整个EpdRetainedFrame，stale为“保存之后屏幕更新过”的标记
+static const char* KEY_FRAME = "frame";
+static const char* KEY_STALE = "stale";
+
+EpdSnapshot::EpdSnapshot() :
+  _open(false), _stale(false), _checksum(0), _saved_ms(0), _saved_once(false), _writes(0)
+{
+}
+
+bool EpdSnapshot::begin(const char* name)
+{
+  _open = _prefs.begin(name, false);
+  return _open;
+}
+
+void EpdSnapshot::end()
+{
+  if (_open) _prefs.end();
+  _open = false;
+}
+
+bool EpdSnapshot::load(EpdRetainedFrame& r)
+{
+  _checksum = 0;
+  if (!_open || (_prefs.getBytesLength(KEY_FRAME) != sizeof(r))) return false;
+  if ((_prefs.getBytes(KEY_FRAME, &r, sizeof(r)) != sizeof(r)) || !epdRetainedValid(r)) return false;
+  _checksum = r.checksum;
+  _stale = _prefs.getBool(KEY_STALE, false);
+  // 已存的快照按本次启动时保存计：save()的最短间隔跨重启也成立，不会每次启动都写一遍
+  _saved_ms = millis();
+  _saved_once = true;
+  return true;
+}
+
+void EpdSnapshot::markDirty()
+{
+  if (!_open || _stale) return;
+  // 还没有快照时只在内存中记下（due()据此安排第一次保存），闪存中的标记没有意义
+  if (_checksum) _prefs.putBool(KEY_STALE, true);
+  _stale = true;
+}
+
+bool EpdSnapshot::due() const
+{
+  return _open && _stale && (!_saved_once || (millis() - _saved_ms >= EPD_SNAPSHOT_INTERVAL_MS));
+}
+
+bool EpdSnapshot::save(const EpdRetainedFrame& r, bool force)
+{
+  if (!_open || !epdRetainedValid(r)) return false;
+  if (r.checksum == _checksum)
+  {
+    // 屏幕又回到了已存的那一帧
+    if (_stale) _prefs.putBool(KEY_STALE, false);
+    _stale = false;
+    return false;
+  }
+  if (!force && _saved_once && (millis() - _saved_ms < EPD_SNAPSHOT_INTERVAL_MS)) return false;
+  if (_prefs.putBytes(KEY_FRAME, &r, sizeof(r)) != sizeof(r)) return false;
+  if (_stale) _prefs.putBool(KEY_STALE, false);
+  _stale = false;
+  _checksum = r.checksum;
+  _saved_ms = millis();
+  _saved_once = true;
+  _writes++;
+  return true;
+}
+
+void EpdSnapshot::clear()
+{
+  if (!_open) return;
+  _prefs.remove(KEY_FRAME);
+  _prefs.remove(KEY_STALE);
+  _checksum = 0;
+  _stale = false;
+}
@@ -0,0 +1,58 @@
+// epd_snapshot.h
+// 闪存快照：屏幕上的一帧与窗口状态（EpdRetainedFrame）存入NVS，断电重启后不清屏、直接局部刷新
+#ifndef EPD_SNAPSHOT_H
+#define EPD_SNAPSHOT_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "epd_retain.h"
+
+// 两次save()之间的最短间隔（ms）：NVS按页擦写，4.9KB的快照频繁写入会缩短闪存寿命
+#ifndef EPD_SNAPSHOT_INTERVAL_MS
+#define EPD_SNAPSHOT_INTERVAL_MS 600000ul
+#endif
+
+/**
+ * 电子纸断电后仍显示最后的画面，但控制器RAM与MCU内存都丢了。启动时load()取回快照，
+ * 以init(0, false)初始化（不清屏、第一次刷新不强制全刷），再EpdDisplay::restore(frame, true)把这一帧写回控制器，
+ * 之后的第一次更新就是差分局部刷新，不再有清屏与全刷的两秒多。
+ *
+ * 快照只在画面稳定时保存（save()，内容未变或间隔不足时不写），保存之后屏幕又更新过就不再完全可信：
+ * 第一次更新前调用markDirty()记下（只写一次小的标记），下次启动stale()为true，
+ * 仍然直接局部刷新，但应安排一次空闲时的全刷（EpdGhostTracker::requestFullRefresh()）清除可能的残留。
+ */
+class EpdSnapshot
+{
+  public:
+    EpdSnapshot();
+
+    bool begin(const char* name = "epd_snap");
+    void end();
+
+    // 读取快照，没有或校验失败时返回false
+    bool load(EpdRetainedFrame& r);
+    // 上次保存之后屏幕是否更新过（load()之后有效）
+    bool stale() const { return _stale; }
+    // 屏幕将要偏离快照：第一次调用时写入标记（还没有快照时只记在内存中）
+    void markDirty();
+    // 屏幕已偏离快照且距上次保存超过EPD_SNAPSHOT_INTERVAL_MS（空闲时据此决定是否retain()并save()）
+    bool due() const;
+    // 保存（r已由EpdDisplay::retain()填好）；force为false时受EPD_SNAPSHOT_INTERVAL_MS限制
+    // （load()取回的快照算作启动时保存的），与已存快照相同时只清除标记。返回是否写入了快照
+    bool save(const EpdRetainedFrame& r, bool force = false);
+    void clear();
+
+    // 统计：写入快照的次数
+    uint32_t writes() const { return _writes; }
+
+  private:
+    Preferences _prefs;
+    bool _open;
+    bool _stale;            // 闪存中的标记（避免重复写入）
+    uint32_t _checksum;     // 已存快照的校验和，0表示没有
+    uint32_t _saved_ms;
+    bool _saved_once;
+    uint32_t _writes;
+};
+
+#endif
@@ -0,0 +1,57 @@
+// epd_trace.cpp
+// 事件跟踪的导出与串口命令
+#include "epd_trace.h"
+
+static_assert((EPD_TRACE_EVENTS & (EPD_TRACE_EVENTS - 1)) == 0, "EPD_TRACE_EVENTS须为2的幂");
+
+#if EPD_TRACE
+EpdTrace epdTrace;
+#endif
+
+static const char* const kindNames[EPD_TRACE_KIND_COUNT] = { "update", "page", "spi", "busy", "glyph", "blit", "window", "text" };
+
+EpdTrace::EpdTrace() :
+  _head(0), _enabled(true)
+{
+  memset(_events, 0, sizeof(_events));
+}
+
+const char* EpdTrace::kindName(uint8_t kind)
+{
+  return kind < EPD_TRACE_KIND_COUNT ? kindNames[kind] : "unknown";
+}
+
+void EpdTrace::dump(Print& out)
+{
+  bool enabled = _enabled;
+  _enabled = false;
+  uint32_t head = _head;
+  uint32_t first = head > EPD_TRACE_EVENTS ? head - EPD_TRACE_EVENTS : 0;
+  out.printf("trace,begin,%lu,%lu,%lu\n", (unsigned long)ESP.getCpuFreqMHz(), (unsigned long)(head - first), (unsigned long)first);
+  for (uint32_t i = first; i < head; i++)
+  {
+    const EpdTraceEvent& e = _events[i & (EPD_TRACE_EVENTS - 1)];
+    out.printf("trace,%lu,%u,%s,%c,%d,%d,%d,%d\n", (unsigned long)e.cycles, e.core, kindName(e.kind), e.phase, e.a, e.b, e.c, e.d);
+  }
+  out.println("trace,end");
+  _enabled = enabled;
+}
+
+bool EpdTrace::command(const char* line, Print& out)
+{
+  while (*line == ' ') line++;
+  if (strncmp(line, "trace", 5) || (line[5] && (line[5] != ' '))) return false;
+  line += 5;
+  while (*line == ' ') line++;
+  if (!*line) dump(out);
+  else if (strcmp(line, "on") == 0) setEnabled(true);
+  else if (strcmp(line, "off") == 0) setEnabled(false);
+  else if (strcmp(line, "clear") == 0) clear();
+  else
+  {
+    out.println("trace,error,usage: trace [on | off | clear]");
+    return true;
+  }
+  if (*line) out.printf("trace,%s\n", line);
+  return true;
+}
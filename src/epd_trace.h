@@ -0,0 +1,116 @@
+// epd_trace.h
+// 事件跟踪：固定大小的无锁环形缓冲区，记录一次更新内部的页、SPI写入、BUSY等待、字形光栅化、位图绘制、窗口设置等事件，
+// 时间戳取CPU周期计数器，经串口导出后由tools/trace2chrome.py转换为Chrome/Perfetto的trace JSON
+#ifndef EPD_TRACE_H
+#define EPD_TRACE_H
+
+#include <Arduino.h>
+
+// 编译开关：-DEPD_TRACE=0时记录宏为空，不占用缓冲区
+#ifndef EPD_TRACE
+#define EPD_TRACE 1
+#endif
+// 缓冲区事件数（2的幂），每个事件16字节，写满后覆盖最早的事件
+#ifndef EPD_TRACE_EVENTS
+#define EPD_TRACE_EVENTS 1024
+#endif
+
+// 事件类型（参数a~d的含义，导出时按类型命名）
+enum EpdTraceKind
+{
+  EPD_TRACE_UPDATE,   // 一次更新（EpdDisplay的更新边界，与能耗记账相同）
+  EPD_TRACE_PAGE,     // 分页绘制的一页：a = 页序号
+  EPD_TRACE_SPI,      // 一段连续的控制器RAM写入：a = 起始行，b = 行数，c = 字节数（DMA时为排队时间）
+  EPD_TRACE_BUSY,     // 刷新或开关电等待BUSY：a = EPD_TRACE_BUSY_PARTIAL等
+  EPD_TRACE_GLYPH,    // 字形光栅化（字形缓存未命中）：a = 编码
+  EPD_TRACE_BLIT,     // 位图绘制：a, b = 位置，c, d = 宽高
+  EPD_TRACE_WINDOW,   // 设置窗口（瞬时事件）：a, b = 位置，c, d = 宽高（物理坐标，x按8对齐）
+  EPD_TRACE_TEXT,     // drawUniversalText()：a, b = 位置，c, d = 宽高（排版的外接矩形）
+  EPD_TRACE_KIND_COUNT
+};
+
+#define EPD_TRACE_BUSY_PARTIAL   0
+#define EPD_TRACE_BUSY_FULL      1
+#define EPD_TRACE_BUSY_POWER_OFF 2
+#define EPD_TRACE_BUSY_HIBERNATE 3
+
+// 阶段，取值与Chrome trace的ph字段相同
+#define EPD_TRACE_PH_BEGIN   'B'
+#define EPD_TRACE_PH_END     'E'
+#define EPD_TRACE_PH_INSTANT 'i'
+
+struct EpdTraceEvent
+{
+  uint32_t cycles;   // ESP.getCycleCount()
+  uint8_t kind;      // EpdTraceKind
+  char phase;        // EPD_TRACE_PH_*
+  uint8_t core;
+  uint8_t reserved;
+  int16_t a, b, c, d;
+};
+
+/**
+ * record()先用原子加法占一个槽位再填写，中断与两个核都可以同时记录，不加锁也不关中断，
+ * 开启时每个事件约几十个周期。周期计数器每个核各有一个，ESP32上两核之间可能有几μs的偏差，导出时按核分成不同的线程；
+ * 32位计数在240MHz下约18秒回绕，转换脚本按每个核的事件顺序展开（两个相邻事件的间隔须小于一个回绕周期）。
+ * EPD_BUSY_LIGHT_SLEEP方式等待时CPU时钟停止，计数器也停止，BUSY事件的时长会偏短。
+ *
+ * dump()期间暂停记录，输出CSV：
+ *   trace,begin,<CPU MHz>,<事件数>,<被覆盖的事件数>
+ *   trace,<周期>,<核>,<类型名>,<阶段>,<a>,<b>,<c>,<d>
+ *   trace,end
+ */
+class EpdTrace
+{
+  public:
+    EpdTrace();
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool enabled() const { return _enabled; }
+    void clear() { _head = 0; }
+
+    inline void record(EpdTraceKind kind, char phase, int16_t a = 0, int16_t b = 0, int16_t c = 0, int16_t d = 0)
+    {
+      if (!_enabled) return;
+      uint32_t i = __atomic_fetch_add(&_head, 1, __ATOMIC_RELAXED);
+      EpdTraceEvent& e = _events[i & (EPD_TRACE_EVENTS - 1)];
+      e.cycles = ESP.getCycleCount();
+      e.kind = kind;
+      e.phase = phase;
+      e.core = xPortGetCoreID();
+      e.a = a;
+      e.b = b;
+      e.c = c;
+      e.d = d;
+    }
+
+    // 统计：记录过的事件总数、因缓冲区写满而被覆盖的事件数
+    uint32_t recorded() const { return _head; }
+    uint32_t overwritten() const { return _head > EPD_TRACE_EVENTS ? _head - EPD_TRACE_EVENTS : 0; }
+
+    void dump(Print& out);
+    // 串口命令（一行，不含换行）：trace导出，trace on/off开始/暂停记录，trace clear清空；
+    // 不是trace命令时返回false
+    bool command(const char* line, Print& out);
+
+    static const char* kindName(uint8_t kind);
+
+  private:
+    EpdTraceEvent _events[EPD_TRACE_EVENTS];
+    uint32_t _head;          // 下一个事件的序号（只增不减，取模得到槽位）
+    volatile bool _enabled;
+};
+
+#if EPD_TRACE
+extern EpdTrace epdTrace;
+// 记录宏：参数为事件类型与最多4个参数
+#define EPD_TRACE_BEGIN(kind, ...) epdTrace.record(kind, EPD_TRACE_PH_BEGIN, ##__VA_ARGS__)
+#define EPD_TRACE_END(kind, ...) epdTrace.record(kind, EPD_TRACE_PH_END, ##__VA_ARGS__)
+#define EPD_TRACE_MARK(kind, ...) epdTrace.record(kind, EPD_TRACE_PH_INSTANT, ##__VA_ARGS__)
+#else
+#define EPD_TRACE_BEGIN(kind, ...) ((void)0)
+#define EPD_TRACE_END(kind, ...) ((void)0)
+#define EPD_TRACE_MARK(kind, ...) ((void)0)
+#endif
+
+#endif
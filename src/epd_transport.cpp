@@ -0,0 +1,273 @@
+// epd_transport.cpp
+// 电子纸SPI的DMA异步传输层实现
+#include "epd_transport.h"
+#include <esp_heap_caps.h>
+#include <driver/gpio.h>
+#include <soc/spi_periph.h>
+
+// SPIClass(HSPI)对应的ESP-IDF主机
+#define EPD_SPI_HOST HSPI_HOST
+
+EpdTransport::EpdTransport() :
+  _spi(0), _dev(0), _sck(-1), _mosi(-1), _cs(-1), _dc(-1), _clock_hz(EPD_SPI_CLOCK_HZ), _enabled(false), _released(0),
+  _chunk(0), _start(0), _fill(0), _head(0), _in_flight(0), _bytes(0), _blocked_us(0)
+{
+  memset(_chunks, 0, sizeof(_chunks));
+  memset(_chunk_refs, 0, sizeof(_chunk_refs));
+  memset(_slots, 0, sizeof(_slots));
+}
+
+bool EpdTransport::begin(SPIClass& spi, int8_t sck, int8_t mosi, int8_t cs, int8_t dc, uint32_t clock_hz)
+{
+  _spi = &spi;
+  _sck = sck;
+  _mosi = mosi;
+  _cs = cs;
+  _dc = dc;
+  _clock_hz = clock_hz < EPD_SPI_MAX_CLOCK_HZ ? clock_hz : EPD_SPI_MAX_CLOCK_HZ;
+  for (uint8_t i = 0; i < EPD_DMA_CHUNKS; i++)
+  {
+    if (!_chunks[i]) _chunks[i] = (uint8_t*)heap_caps_malloc(EPD_DMA_CHUNK_SIZE, MALLOC_CAP_DMA);
+    if (!_chunks[i]) return false; // 暂存区分配失败，继续使用SPIClass阻塞传输
+  }
+  _released = 0;
+  spi_bus_config_t bus;
+  memset(&bus, 0, sizeof(bus));
+  bus.mosi_io_num = _mosi;
+  bus.miso_io_num = -1;
+  bus.sclk_io_num = _sck;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = EPD_DMA_CHUNK_SIZE;
+  if (spi_bus_initialize(EPD_SPI_HOST, &bus, SPI_DMA_CH_AUTO) == ESP_OK)
+  {
+    _enabled = _addDevice();
+    if (_enabled) return true;
+    spi_bus_free(EPD_SPI_HOST);
+  }
+  // 初始化失败：总线留给SPIClass，驱动退回阻塞传输
+  _spi->begin(_sck, -1, _mosi);
+  return false;
+}
+
+void EpdTransport::end()
+{
+  if (!_enabled) return;
+  if (_released) spi_device_release_bus(_dev);
+  else wait();
+  _removeDevice();
+  spi_bus_free(EPD_SPI_HOST);
+  _spi->begin(_sck, -1, _mosi);
+  pinMode(_cs, OUTPUT);
+  digitalWrite(_cs, HIGH);
+  _enabled = false;
+  _released = 0;
+  for (uint8_t i = 0; i < EPD_DMA_CHUNKS; i++)
+  {
+    heap_caps_free(_chunks[i]);
+    _chunks[i] = 0;
+  }
+}
+
+uint32_t EpdTransport::setClock(uint32_t clock_hz)
+{
+  _clock_hz = clock_hz < EPD_SPI_MAX_CLOCK_HZ ? clock_hz : EPD_SPI_MAX_CLOCK_HZ;
+  if (active())
+  {
+    // 按新时钟重新添加设备（借出期间调用时先放开总线锁，加好后再占住，CS仍交给GPIO）
+    if (_released) spi_device_release_bus(_dev);
+    else wait();
+    _removeDevice();
+    if (!_addDevice())
+    {
+      // 失败时把总线交回SPIClass
+      spi_bus_free(EPD_SPI_HOST);
+      _spi->begin(_sck, -1, _mosi);
+      _enabled = false;
+    }
+    else if (_released) spi_device_acquire_bus(_dev, portMAX_DELAY);
+    if (_released || !_enabled)
+    {
+      pinMode(_cs, OUTPUT);
+      digitalWrite(_cs, HIGH);
+    }
+  }
+  return _clock_hz;
+}
+
+void EpdTransport::release()
+{
+  if (_released++ || !_enabled) return;
+  wait();
+  // 设备保持挂在总线上，只占住总线锁：借出期间ESP-IDF不会再动SPI外设，由SPIClass直接操作寄存器
+  spi_device_acquire_bus(_dev, portMAX_DELAY);
+  // CS引脚从SPI外设矩阵切回GPIO，由原驱动digitalWrite()控制
+  pinMode(_cs, OUTPUT);
+  digitalWrite(_cs, HIGH);
+}
+
+void EpdTransport::acquire()
+{
+  if (!_released || --_released || !_enabled) return;
+  // CS接回设备的片选信号（spi_bus_add_device()时分配的第一路CS）
+  pinMatrixOutAttach(_cs, spi_periph_signal[EPD_SPI_HOST].spics_out[0], false, false);
+  spi_device_release_bus(_dev);
+}
+
+bool EpdTransport::_addDevice()
+{
+  spi_device_interface_config_t dev;
+  memset(&dev, 0, sizeof(dev));
+  dev.mode = 0; // 与原配置相同，SSD1608使用MODE0
+  dev.clock_speed_hz = _clock_hz;
+  dev.spics_io_num = _cs;
+  dev.queue_size = EPD_DMA_QUEUE;
+  dev.pre_cb = _preTransfer;
+  dev.post_cb = _postTransfer;
+  if (spi_bus_add_device(EPD_SPI_HOST, &dev, &_dev) != ESP_OK)
+  {
+    _dev = 0;
+    return false;
+  }
+  _chunk = _start = _fill = 0;
+  _head = _in_flight = 0;
+  memset(_chunk_refs, 0, sizeof(_chunk_refs));
+  return true;
+}
+
+void EpdTransport::_removeDevice()
+{
+  spi_bus_remove_device(_dev);
+  _dev = 0;
+}
+
+void EpdTransport::command(uint8_t cmd)
+{
+  _submitData(0, 0); // 之前排队的数据先发
+  Slot* s = _slot();
+  s->t.flags = SPI_TRANS_USE_TXDATA;
+  s->t.length = 8;
+  s->t.tx_data[0] = cmd;
+  s->dc = 0;
+  _submit(s);
+}
+
+void EpdTransport::flush(EpdFlushCallback cb, void* ctx)
+{
+  if (_fill > _start)
+  {
+    _submitData(cb, ctx);
+  }
+  else if (cb)
+  {
+    // 没有未提交的数据，回调无处挂靠：等已排队的发完后直接调用（极少出现，命令后立即flush()）
+    wait();
+    cb(ctx);
+  }
+}
+
+bool EpdTransport::busy()
+{
+  if (!active()) return false;
+  while (_in_flight && _reclaim(0)) {}
+  return _in_flight != 0;
+}
+
+void EpdTransport::wait()
+{
+  if (!active()) return;
+  _submitData(0, 0);
+  uint32_t t0 = micros();
+  while (_in_flight) _reclaim(portMAX_DELAY);
+  _blocked_us += micros() - t0;
+}
+
+EpdTransport::Slot* EpdTransport::_slot()
+{
+  if (_in_flight >= EPD_DMA_QUEUE)
+  {
+    uint32_t t0 = micros();
+    _reclaim(portMAX_DELAY);
+    _blocked_us += micros() - t0;
+  }
+  // 传输按提交顺序完成，_head处的槽一定已经回收
+  Slot* s = &_slots[_head];
+  _head = (_head + 1) % EPD_DMA_QUEUE;
+  memset(&s->t, 0, sizeof(s->t));
+  s->t.user = s;
+  s->owner = this;
+  s->chunk = -1;
+  s->cb = 0;
+  s->ctx = 0;
+  return s;
+}
+
+void EpdTransport::_submit(Slot* s)
+{
+  if (s->chunk >= 0) _chunk_refs[s->chunk]++;
+  _in_flight++;
+  _bytes += s->t.length / 8;
+  spi_device_queue_trans(_dev, &s->t, portMAX_DELAY);
+}
+
+bool EpdTransport::_reclaim(TickType_t ticks)
+{
+  spi_transaction_t* t;
+  if (spi_device_get_trans_result(_dev, &t, ticks) != ESP_OK) return false;
+  Slot* s = (Slot*)t->user;
+  if (s->chunk >= 0) _chunk_refs[s->chunk]--;
+  _in_flight--;
+  return true;
+}
+
+void EpdTransport::_submitData(EpdFlushCallback cb, void* ctx)
+{
+  uint16_t n = _fill - _start;
+  if (!n) return;
+  Slot* s = _slot();
+  s->t.length = n * 8;
+  s->dc = 1;
+  s->cb = cb;
+  s->ctx = ctx;
+  if (n <= 4)
+  {
+    // 设置RAM窗口之类的短数据内联在传输描述里，暂存区空间留给后面的数据
+    s->t.flags = SPI_TRANS_USE_TXDATA;
+    memcpy(s->t.tx_data, _chunks[_chunk] + _start, n);
+    _fill = _start;
+  }
+  else
+  {
+    s->t.tx_buffer = _chunks[_chunk] + _start;
+    s->chunk = _chunk;
+    // 下一段数据从4字节对齐处开始（不对齐时驱动会另外分配缓冲区复制）
+    _start = _fill = (_fill + 3) & ~3;
+  }
+  _submit(s);
+}
+
+void EpdTransport::_nextChunk()
+{
+  _submitData(0, 0);
+  _chunk = (_chunk + 1) % EPD_DMA_CHUNKS;
+  // 背压：下一块仍在发送时等它完成
+  if (_chunk_refs[_chunk])
+  {
+    uint32_t t0 = micros();
+    while (_chunk_refs[_chunk]) _reclaim(portMAX_DELAY);
+    _blocked_us += micros() - t0;
+  }
+  _start = _fill = 0;
+}
+
+void IRAM_ATTR EpdTransport::_preTransfer(spi_transaction_t* t)
+{
+  Slot* s = (Slot*)t->user;
+  gpio_set_level((gpio_num_t)s->owner->_dc, s->dc);
+}
+
+void IRAM_ATTR EpdTransport::_postTransfer(spi_transaction_t* t)
+{
+  Slot* s = (Slot*)t->user;
+  if (s->cb) s->cb(s->ctx);
+}
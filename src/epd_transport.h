@@ -0,0 +1,114 @@
+// epd_transport.h
+// 电子纸SPI的DMA异步传输层：命令与数据按突发排队到ESP-IDF spi_master的DMA传输中，
+// 提交后立即返回，CPU在字节发送期间可以继续渲染下一页或做其它事情
+#ifndef EPD_TRANSPORT_H
+#define EPD_TRANSPORT_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <driver/spi_master.h>
+
+// 默认时钟与原配置相同；SSD16xx系列写入时序允许到约20MHz，更高的设置取上限
+#ifndef EPD_SPI_CLOCK_HZ
+#define EPD_SPI_CLOCK_HZ 4000000
+#endif
+#define EPD_SPI_MAX_CLOCK_HZ 20000000
+
+// DMA暂存区：EPD_DMA_CHUNKS块，每块EPD_DMA_CHUNK_SIZE字节（需要DMA可访问的内部RAM），
+// 总容量大于一整帧（4736字节），一帧数据排队时通常不需要等待
+#ifndef EPD_DMA_CHUNK_SIZE
+#define EPD_DMA_CHUNK_SIZE 2048
+#endif
+#ifndef EPD_DMA_CHUNKS
+#define EPD_DMA_CHUNKS 3
+#endif
+#define EPD_DMA_QUEUE 16   // 同时在队列中的传输数
+
+// 一次flush()的数据全部发完时调用。在SPI中断中执行：只能置标志、发信号量或通知任务
+typedef void (*EpdFlushCallback)(void* ctx);
+
+/**
+ * 总线所有权：ESP-IDF驱动与Arduino SPIClass共用HSPI外设，不能同时传输。
+ * begin()后设备一直挂在总线上；原驱动（GxEPD2_290）的命令仍走SPIClass，
+ * 调用前用release()等待队列发完、占住总线锁（spi_device_acquire_bus()）并把CS交给GPIO，
+ * 调用后acquire()接回CS、放开总线锁（可嵌套）。两者只是轮流写同一组外设寄存器，
+ * ESP-IDF收回后不会重新配置时钟，所以SPIClass的SPISettings要与本类的时钟和模式（MODE0）一致。
+ */
+class EpdTransport
+{
+  public:
+    EpdTransport();
+
+    // spi为原来绑定面板的已begin()的SPIClass（初始化失败或end()时重新begin），引脚与SPIClass::begin()一致
+    bool begin(SPIClass& spi, int8_t sck, int8_t mosi, int8_t cs, int8_t dc, uint32_t clock_hz = EPD_SPI_CLOCK_HZ);
+    void end();
+    bool active() const { return _dev != 0; }
+
+    // 修改时钟（等待队列发完后重新添加设备，SPIClass的SPISettings需同步修改），返回实际使用的时钟
+    uint32_t setClock(uint32_t clock_hz);
+    uint32_t clock() const { return _clock_hz; }
+
+    // 排队一个命令字节（DC=0）/数据字节（DC=1）；数据先写入暂存区，
+    // 遇到下一个命令、暂存块写满或flush()时才提交
+    void command(uint8_t cmd);
+    void data(uint8_t d)
+    {
+      if (_fill >= EPD_DMA_CHUNK_SIZE) _nextChunk();
+      _chunks[_chunk][_fill++] = d;
+    }
+
+    // 提交暂存的数据后立即返回；cb非空时，到此为止排队的字节全部发完后在中断中调用cb(ctx)
+    void flush(EpdFlushCallback cb = 0, void* ctx = 0);
+    // 回收已完成的传输，返回是否还有未完成的传输（不阻塞）
+    bool busy();
+    // 提交并等待全部发完
+    void wait();
+
+    // 交回/收回总线（计数嵌套，只有最外层真正切换）
+    void release();
+    void acquire();
+
+    // 统计：排队的字节数、因暂存区或队列满以及wait()而阻塞的时间
+    uint32_t bytesQueued() const { return _bytes; }
+    uint32_t blockedMicros() const { return _blocked_us; }
+    void resetStats() { _bytes = _blocked_us = 0; }
+
+  private:
+    struct Slot
+    {
+      spi_transaction_t t;
+      EpdTransport* owner;
+      uint8_t dc;
+      int8_t chunk;           // 数据所在的暂存块，-1为内联（tx_data）
+      EpdFlushCallback cb;
+      void* ctx;
+    };
+
+    bool _addDevice();
+    void _removeDevice();
+    Slot* _slot();
+    void _submit(Slot* s);
+    bool _reclaim(TickType_t ticks);
+    void _submitData(EpdFlushCallback cb, void* ctx);
+    void _nextChunk();
+
+    static void IRAM_ATTR _preTransfer(spi_transaction_t* t);
+    static void IRAM_ATTR _postTransfer(spi_transaction_t* t);
+
+  private:
+    SPIClass* _spi;
+    spi_device_handle_t _dev;
+    int8_t _sck, _mosi, _cs, _dc;
+    uint32_t _clock_hz;
+    bool _enabled;                           // begin()成功且未end()
+    uint8_t _released;                       // release()嵌套层数
+    uint8_t* _chunks[EPD_DMA_CHUNKS];
+    uint8_t _chunk_refs[EPD_DMA_CHUNKS];     // 引用该暂存块、尚未完成的传输数
+    uint8_t _chunk;                          // 当前写入的暂存块
+    uint16_t _start, _fill;                  // 当前块中未提交数据的范围[_start, _fill)
+    Slot _slots[EPD_DMA_QUEUE];
+    uint8_t _head, _in_flight;               // 下一个可用的槽、已提交未回收的传输数
+    uint32_t _bytes, _blocked_us;
+};
+
+#endif
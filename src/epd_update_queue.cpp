@@ -0,0 +1,117 @@
+// epd_update_queue.cpp
+// 更新合并队列实现
+#include "epd_update_queue.h"
+
+EpdUpdateQueue::EpdUpdateQueue(EpdDisplay& display) :
+  _display(display), _pending(0), _deadline(0), _requests(0), _refreshes(0)
+{
+  memset(_slots, 0, sizeof(_slots));
+}
+
+int8_t EpdUpdateQueue::_find(EpdDrawCallback cb, const void* pv, bool allocate)
+{
+  int8_t free_slot = -1;
+  for (uint8_t i = 0; i < EPD_QUEUE_SLOTS; i++)
+  {
+    if (_slots[i].cb == cb && _slots[i].pv == pv) return i;
+    if (!_slots[i].cb && (free_slot < 0)) free_slot = i;
+  }
+  if (!allocate || (free_slot < 0)) return -1;
+  Slot& s = _slots[free_slot];
+  memset(&s, 0, sizeof(s));
+  s.cb = cb;
+  s.pv = pv;
+  return free_slot;
+}
+
+void EpdUpdateQueue::_schedule(Slot& s, uint16_t latency_ms)
+{
+  uint32_t due = millis() + latency_ms;
+  // 截止时间取所有待更新元素中最早的
+  if (!_pending || (int32_t(due - _deadline) < 0)) _deadline = due;
+  if (!s.pending) _pending++;
+  s.pending = true;
+  _requests++;
+}
+
+bool EpdUpdateQueue::request(EpdDrawCallback cb, const void* pv, uint16_t latency_ms)
+{
+  int8_t i = _find(cb, pv, true);
+  if (i < 0)
+  {
+    flush();
+    i = _find(cb, pv, true);
+    if (i < 0) return false;
+  }
+  _slots[i].removing = false;
+  _schedule(_slots[i], latency_ms);
+  return true;
+}
+
+bool EpdUpdateQueue::remove(EpdDrawCallback cb, const void* pv, uint16_t latency_ms)
+{
+  int8_t i = _find(cb, pv, false);
+  if (i < 0) return false;
+  if (!_slots[i].drawn)
+  {
+    // 还没画到屏幕上，直接注销
+    if (_slots[i].pending) _pending--;
+    memset(&_slots[i], 0, sizeof(Slot));
+    return true;
+  }
+  _slots[i].removing = true;
+  _schedule(_slots[i], latency_ms);
+  return true;
+}
+
+uint32_t EpdUpdateQueue::msUntilDue() const
+{
+  if (!_pending) return UINT32_MAX;
+  int32_t left = int32_t(_deadline - millis());
+  return left > 0 ? left : 0;
+}
+
+bool EpdUpdateQueue::service()
+{
+  if (!_pending || (int32_t(millis() - _deadline) < 0)) return false;
+  return flush();
+}
+
+bool EpdUpdateQueue::flush()
+{
+  if (!_pending) return false;
+  // 窗口：待更新元素的旧内容区域（擦除）与新内容区域（绘制）的并集
+  DirtyRegion region;
+  for (uint8_t i = 0; i < EPD_QUEUE_SLOTS; i++)
+  {
+    Slot& s = _slots[i];
+    if (!s.cb || !s.pending) continue;
+    if (s.drawn) region.add(s.bounds);
+    if (s.removing)
+    {
+      memset(&s, 0, sizeof(Slot));
+      continue;
+    }
+    s.bounds = _display.recordBounds(s.cb, s.pv);
+    s.drawn = true;
+    s.pending = false;
+    region.add(s.bounds);
+  }
+  _pending = 0;
+  if (!_display.updateWindow(_drawAll, this, region.bounds())) return false;
+  _refreshes++;
+  return true;
+}
+
+// 白底上依次画出所有元素，元素回调里的白色清屏被忽略
+void EpdUpdateQueue::_drawAll(const void* pv)
+{
+  const EpdUpdateQueue* q = (const EpdUpdateQueue*)pv;
+  q->_display.fillScreen(GxEPD_WHITE);
+  q->_display.setKeepBackground(true);
+  for (uint8_t i = 0; i < EPD_QUEUE_SLOTS; i++)
+  {
+    if (q->_slots[i].cb) q->_slots[i].cb(q->_slots[i].pv);
+  }
+  q->_display.setKeepBackground(false);
+}
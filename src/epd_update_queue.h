@@ -0,0 +1,71 @@
+// epd_update_queue.h
+// 更新合并队列：短时间内的多次绘制请求按最早的截止时间合并成一次局部刷新
+#ifndef EPD_UPDATE_QUEUE_H
+#define EPD_UPDATE_QUEUE_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+
+#define EPD_QUEUE_SLOTS 8          // 同时登记的绘制元素数
+#define EPD_QUEUE_LATENCY_MS 300   // request()默认允许的延迟
+
+typedef void (*EpdDrawCallback)(const void*);
+
+/**
+ * 每个元素是一个绘图回调加参数（签名与updateDirty()相同，可以以白色清屏开头，
+ * 只画自己的内容），同一对(回调, 参数)视为同一元素，重复请求只保留一次、截止时间取较早者。
+ *
+ * service()在最早的截止时间到达时把所有待更新元素一起刷新：窗口取这些元素新旧内容区域的并集，
+ * 窗口内按登记顺序重画所有元素（未变化的元素也要画，窗口会覆盖它们），只刷新一次。
+ * SSD1608局部刷新的时间与窗口大小无关，差分传输又会跳过没有变化的行，
+ * 所以即使元素彼此不相邻，合成一个外接窗口也比分开刷新便宜。
+ * 参数指向的数据在刷新前都要保持有效（刷新时才读取）；字体、颜色等也在刷新时才用到，
+ * 依赖display当前状态的回调应自己设置。
+ */
+class EpdUpdateQueue
+{
+  public:
+    EpdUpdateQueue(EpdDisplay& display);
+
+    // 请求在latency_ms内更新该元素；元素表已满时先立即刷新再登记，仍失败返回false
+    bool request(EpdDrawCallback cb, const void* pv, uint16_t latency_ms = EPD_QUEUE_LATENCY_MS);
+    // 擦除元素并不再登记（同样在截止时间前合并刷新）
+    bool remove(EpdDrawCallback cb, const void* pv, uint16_t latency_ms = EPD_QUEUE_LATENCY_MS);
+
+    // 在loop()中调用：到达截止时间则刷新，返回是否刷新了
+    bool service();
+    // 立即刷新所有待更新元素
+    bool flush();
+
+    bool pending() const { return _pending > 0; }
+    // 距最早的截止时间还有多少ms（没有待更新元素时返回UINT32_MAX）
+    uint32_t msUntilDue() const;
+
+    // 统计：收到的请求数与实际刷新次数
+    uint32_t requests() const { return _requests; }
+    uint32_t refreshes() const { return _refreshes; }
+
+  private:
+    struct Slot
+    {
+      EpdDrawCallback cb;
+      const void* pv;
+      DirtyRect bounds;     // 上次绘制的内容区域（物理坐标）
+      bool drawn;           // bounds有效
+      bool pending;
+      bool removing;
+    };
+
+    int8_t _find(EpdDrawCallback cb, const void* pv, bool allocate);
+    void _schedule(Slot& s, uint16_t latency_ms);
+    static void _drawAll(const void* pv);
+
+  private:
+    EpdDisplay& _display;
+    Slot _slots[EPD_QUEUE_SLOTS];
+    uint8_t _pending;
+    uint32_t _deadline;     // millis()
+    uint32_t _requests, _refreshes;
+};
+
+#endif
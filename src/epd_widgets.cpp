@@ -0,0 +1,304 @@
+// epd_widgets.cpp
+// 保留模式控件实现
+#include "epd_widgets.h"
+
+static const DirtyRect emptyRect = { 0, 0, 0, 0 };
+
+// ---------------- EpdWidget / EpdGroup ----------------
+
+EpdWidget::EpdWidget() :
+  _bounds(emptyRect), _drawn(emptyRect), _dirty(true), _visible(true), _next(0)
+{
+}
+
+void EpdWidget::setVisible(bool visible)
+{
+  if (visible == _visible) return;
+  _visible = visible;
+  _dirty = true;
+}
+
+EpdGroup::EpdGroup() :
+  _first(0), _last(0)
+{
+}
+
+void EpdGroup::add(EpdWidget& child)
+{
+  child._next = 0;
+  if (_last) _last->_next = &child;
+  else _first = &child;
+  _last = &child;
+  child._dirty = true;
+}
+
+// ---------------- EpdLabel ----------------
+
+EpdLabel::EpdLabel(int16_t x, int16_t y, const char* text, const TextStyle& style, uint16_t color) :
+  _x(x), _y(y), _text(text), _style(style), _color(color)
+{
+}
+
+void EpdLabel::setText(const char* text)
+{
+  if (text == _text) return;
+  _text = text;
+  _dirty = true;
+}
+
+void EpdLabel::setColor(uint16_t color)
+{
+  if (color == _color) return;
+  _color = color;
+  _dirty = true;
+}
+
+void EpdLabel::layout()
+{
+  _layout = _text ? TextLayout(_x, _y, _text, _style) : TextLayout();
+  DirtyRect b = { _layout.x(), _layout.y(), _layout.width(), _layout.height() };
+  _bounds = b;
+}
+
+void EpdLabel::draw(EpdDisplay& gfx) const
+{
+  _layout.draw(gfx, _color);
+}
+
+// ---------------- EpdValue ----------------
+
+EpdValue::EpdValue(int16_t x, int16_t y, const char* format, const TextStyle& style, uint16_t color) :
+  _x(x), _y(y), _fmt(format), _style(style), _color(color), _int_src(0), _float_src(0),
+  _int_value(0), _float_value(0), _has_value(false)
+{
+  _text[0] = 0;
+}
+
+void EpdValue::bind(const long* source)
+{
+  _int_src = source;
+  _float_src = 0;
+  _has_value = false;
+}
+
+void EpdValue::bind(const float* source)
+{
+  _float_src = source;
+  _int_src = 0;
+  _has_value = false;
+}
+
+void EpdValue::set(long value)
+{
+  if (_has_value && (value == _int_value)) return;
+  _format(false, value, 0);
+}
+
+void EpdValue::set(float value)
+{
+  if (_has_value && (value == _float_value)) return;
+  _format(true, 0, value);
+}
+
+void EpdValue::sync()
+{
+  if (_int_src) set(*_int_src);
+  else if (_float_src) set(*_float_src);
+}
+
+// 只在原始值变化时格式化；格式化结果相同（如只变了显示精度以下的位）时不失效
+void EpdValue::_format(bool is_float, long i, float f)
+{
+  _int_value = i;
+  _float_value = f;
+  _has_value = true;
+  char text[EPD_VALUE_MAX_TEXT];
+  if (is_float) snprintf(text, sizeof(text), _fmt, f);
+  else snprintf(text, sizeof(text), _fmt, i);
+  if (strcmp(text, _text) == 0) return;
+  strcpy(_text, text);
+  _dirty = true;
+}
+
+void EpdValue::layout()
+{
+  _layout = TextLayout(_x, _y, _text, _style);
+  DirtyRect b = { _layout.x(), _layout.y(), _layout.width(), _layout.height() };
+  _bounds = b;
+}
+
+void EpdValue::draw(EpdDisplay& gfx) const
+{
+  _layout.draw(gfx, _color);
+}
+
+// ---------------- EpdBitmap / EpdBox / EpdLine ----------------
+
+EpdBitmap::EpdBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) :
+  _x(x), _y(y), _w(w), _h(h), _bitmap(bitmap), _color(color)
+{
+}
+
+void EpdBitmap::setBitmap(const uint8_t* bitmap)
+{
+  if (bitmap == _bitmap) return;
+  _bitmap = bitmap;
+  _dirty = true;
+}
+
+void EpdBitmap::setPosition(int16_t x, int16_t y)
+{
+  if ((x == _x) && (y == _y)) return;
+  _x = x;
+  _y = y;
+  _dirty = true;
+}
+
+void EpdBitmap::layout()
+{
+  DirtyRect b = { _x, _y, int16_t(_bitmap ? _w : 0), _h };
+  _bounds = b;
+}
+
+void EpdBitmap::draw(EpdDisplay& gfx) const
+{
+  if (_bitmap) gfx.drawBitmap(_x, _y, _bitmap, _w, _h, _color);
+}
+
+EpdBox::EpdBox(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, bool filled) :
+  _x(x), _y(y), _w(w), _h(h), _color(color), _filled(filled)
+{
+}
+
+void EpdBox::setRect(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if ((x == _x) && (y == _y) && (w == _w) && (h == _h)) return;
+  _x = x;
+  _y = y;
+  _w = w;
+  _h = h;
+  _dirty = true;
+}
+
+void EpdBox::setColor(uint16_t color)
+{
+  if (color == _color) return;
+  _color = color;
+  _dirty = true;
+}
+
+void EpdBox::layout()
+{
+  DirtyRect b = { _x, _y, _w, _h };
+  _bounds = b;
+}
+
+void EpdBox::draw(EpdDisplay& gfx) const
+{
+  if (_filled) gfx.fillRect(_x, _y, _w, _h, _color);
+  else gfx.drawRect(_x, _y, _w, _h, _color);
+}
+
+EpdLine::EpdLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) :
+  _x0(x0), _y0(y0), _x1(x1), _y1(y1), _color(color)
+{
+}
+
+void EpdLine::setEnds(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+  if ((x0 == _x0) && (y0 == _y0) && (x1 == _x1) && (y1 == _y1)) return;
+  _x0 = x0;
+  _y0 = y0;
+  _x1 = x1;
+  _y1 = y1;
+  _dirty = true;
+}
+
+void EpdLine::layout()
+{
+  int16_t x = min(_x0, _x1), y = min(_y0, _y1);
+  DirtyRect b = { x, y, int16_t(max(_x0, _x1) - x + 1), int16_t(max(_y0, _y1) - y + 1) };
+  _bounds = b;
+}
+
+void EpdLine::draw(EpdDisplay& gfx) const
+{
+  gfx.drawLine(_x0, _y0, _x1, _y1, _color);
+}
+
+// ---------------- EpdScreen ----------------
+
+EpdScreen::EpdScreen(EpdDisplay& display) :
+  _display(display), _laid_out(0), _draw_calls(0)
+{
+}
+
+// 失效的控件：旧内容区域加入窗口（擦除），重新排版后新内容区域也加入窗口；
+// 容器失效（显示/隐藏）时其下所有控件一起处理
+void EpdScreen::_collect(EpdWidget* parent, DirtyRegion& region, bool force, bool hidden)
+{
+  for (EpdWidget* w = parent->firstChild(); w; w = w->_next)
+  {
+    w->sync();
+    bool dirty = w->_dirty || force;
+    if (dirty)
+    {
+      region.add(w->_drawn);
+      w->layout();
+      w->_dirty = false;
+      _laid_out++;
+    }
+    if (w->firstChild())
+    {
+      // 隐藏的容器按子控件都不可见处理
+      _collect(w, region, dirty, hidden || !w->_visible);
+      continue;
+    }
+    if (dirty)
+    {
+      bool shown = w->_visible && !hidden && !w->_bounds.isEmpty();
+      w->_drawn = shown ? _display.toPhysical(w->_bounds) : emptyRect;
+      region.add(w->_drawn);
+    }
+  }
+}
+
+bool EpdScreen::update()
+{
+  DirtyRegion region;
+  _laid_out = _draw_calls = 0;
+  _collect(this, region, false, false);
+  return _display.updateWindow(_drawTree, this, region.bounds());
+}
+
+void EpdScreen::present(bool partial_update_mode)
+{
+  DirtyRegion region;
+  _laid_out = _draw_calls = 0;
+  _collect(this, region, true, false);
+  _display.drawPipelined(_drawTree, this, partial_update_mode);
+}
+
+void EpdScreen::_drawChildren(const EpdWidget* parent, const DirtyRect& page)
+{
+  for (const EpdWidget* w = parent->firstChild(); w; w = w->_next)
+  {
+    if (!w->_visible) continue;
+    if (w->firstChild())
+    {
+      _drawChildren(w, page);
+      continue;
+    }
+    // 与当前页（窗口内）不相交的控件不绘制
+    if (w->_drawn.isEmpty() || !w->_bounds.intersects(page)) continue;
+    w->draw(_display);
+    _draw_calls++;
+  }
+}
+
+void EpdScreen::_drawTree(const void* pv)
+{
+  EpdScreen* s = (EpdScreen*)pv;
+  s->_display.fillScreen(GxEPD_WHITE);
+  s->_drawChildren(s, s->_display.pageRect());
+}
@@ -0,0 +1,199 @@
+// epd_widgets.h
+// 保留模式控件：标签、数值、位图、方框、线段挂在EpdScreen下，
+// 每个控件缓存自己的排版，数据变化时才失效，刷新只重画失效控件所在的窗口
+#ifndef EPD_WIDGETS_H
+#define EPD_WIDGETS_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+#include "text_layout.h"
+
+#define EPD_VALUE_MAX_TEXT 48   // 数值控件格式化后的最大字节数
+
+/**
+ * 控件基类。坐标都是逻辑坐标（当前旋转下），背景为白色。
+ * 子类实现layout()（按当前数据排版并更新_bounds）与draw()（按排版结果绘制），
+ * 带数据绑定的控件在sync()中与缓存比较，变化时才invalidate()。
+ */
+class EpdWidget
+{
+  public:
+    EpdWidget();
+    virtual ~EpdWidget() {}
+
+    void invalidate() { _dirty = true; }
+    bool isDirty() const { return _dirty; }
+    void setVisible(bool visible);
+    bool visible() const { return _visible; }
+    // 最近一次排版的外接矩形
+    const DirtyRect& bounds() const { return _bounds; }
+
+  protected:
+    friend class EpdGroup;
+    friend class EpdScreen;
+
+    virtual void sync() {}
+    virtual void layout() = 0;
+    virtual void draw(EpdDisplay& gfx) const = 0;
+    virtual EpdWidget* firstChild() const { return 0; }
+
+  protected:
+    DirtyRect _bounds;
+    DirtyRect _drawn;     // 屏幕上现有内容的区域（物理坐标），空表示还没画过
+    bool _dirty;
+    bool _visible;
+    EpdWidget* _next;     // 同一父控件下的下一个控件
+};
+
+// 容器：本身不绘制，按添加顺序绘制子控件
+class EpdGroup : public EpdWidget
+{
+  public:
+    EpdGroup();
+    void add(EpdWidget& child);
+
+  protected:
+    void layout() {}
+    void draw(EpdDisplay& gfx) const { (void)gfx; }
+    EpdWidget* firstChild() const { return _first; }
+
+  private:
+    EpdWidget* _first;
+    EpdWidget* _last;
+};
+
+// 文本标签（drawUniversalText的排版，中英文混排）
+class EpdLabel : public EpdWidget
+{
+  public:
+    // (x, y)与TextLayout相同：对齐基准点与第一行基线
+    EpdLabel(int16_t x, int16_t y, const char* text, const TextStyle& style, uint16_t color = GxEPD_BLACK);
+    // 换成另一段文本（同一缓冲区内容改变时调用invalidate()）
+    void setText(const char* text);
+    void setColor(uint16_t color);
+
+  protected:
+    void layout();
+    void draw(EpdDisplay& gfx) const;
+
+  private:
+    int16_t _x, _y;
+    const char* _text;
+    TextStyle _style;
+    uint16_t _color;
+    TextLayout _layout;
+};
+
+// 数值：按printf格式显示一个绑定的整数或浮点数，格式化结果不变时不失效
+class EpdValue : public EpdWidget
+{
+  public:
+    // format含一个%ld（整数）或%f类（浮点数）转换，如"平均：%.2f FPS"
+    EpdValue(int16_t x, int16_t y, const char* format, const TextStyle& style, uint16_t color = GxEPD_BLACK);
+    void bind(const long* source);
+    void bind(const float* source);
+    void set(long value);
+    void set(float value);
+
+  protected:
+    void sync();
+    void layout();
+    void draw(EpdDisplay& gfx) const;
+
+  private:
+    void _format(bool is_float, long i, float f);
+
+  private:
+    int16_t _x, _y;
+    const char* _fmt;
+    TextStyle _style;
+    uint16_t _color;
+    const long* _int_src;
+    const float* _float_src;
+    long _int_value;
+    float _float_value;
+    bool _has_value;
+    char _text[EPD_VALUE_MAX_TEXT];
+    TextLayout _layout;
+};
+
+// 位图（drawBitmap()，1为前景色）
+class EpdBitmap : public EpdWidget
+{
+  public:
+    EpdBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color = GxEPD_BLACK);
+    void setBitmap(const uint8_t* bitmap);
+    void setPosition(int16_t x, int16_t y);
+
+  protected:
+    void layout();
+    void draw(EpdDisplay& gfx) const;
+
+  private:
+    int16_t _x, _y, _w, _h;
+    const uint8_t* _bitmap;
+    uint16_t _color;
+};
+
+// 方框（填充或1像素边框）
+class EpdBox : public EpdWidget
+{
+  public:
+    EpdBox(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color = GxEPD_BLACK, bool filled = true);
+    void setRect(int16_t x, int16_t y, int16_t w, int16_t h);
+    void setColor(uint16_t color);
+
+  protected:
+    void layout();
+    void draw(EpdDisplay& gfx) const;
+
+  private:
+    int16_t _x, _y, _w, _h;
+    uint16_t _color;
+    bool _filled;
+};
+
+// 线段
+class EpdLine : public EpdWidget
+{
+  public:
+    EpdLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color = GxEPD_BLACK);
+    void setEnds(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+  protected:
+    void layout();
+    void draw(EpdDisplay& gfx) const;
+
+  private:
+    int16_t _x0, _y0, _x1, _y1;
+    uint16_t _color;
+};
+
+/**
+ * 控件树的根。update()先让各控件同步绑定的数据，再对失效的控件重新排版，
+ * 刷新窗口取它们旧内容区域与新内容区域的并集（按字节对齐），窗口内只绘制与当前页相交的控件；
+ * 没有控件失效时什么都不做。present()整屏绘制一次（首次显示或旋转改变后）。
+ */
+class EpdScreen : public EpdGroup
+{
+  public:
+    EpdScreen(EpdDisplay& display);
+
+    bool update();
+    void present(bool partial_update_mode = true);
+
+    // 统计：最近一次update()/present()重新排版的控件数、绘制调用数（每页每个控件一次）
+    uint16_t lastLaidOut() const { return _laid_out; }
+    uint16_t lastDrawCalls() const { return _draw_calls; }
+
+  private:
+    void _collect(EpdWidget* parent, DirtyRegion& region, bool force, bool hidden);
+    void _drawChildren(const EpdWidget* parent, const DirtyRect& page);
+    static void _drawTree(const void* pv);
+
+  private:
+    EpdDisplay& _display;
+    uint16_t _laid_out, _draw_calls;
+};
+
+#endif
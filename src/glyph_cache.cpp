@@ -0,0 +1,273 @@
+// glyph_cache.cpp
+// 字形光栅化缓存实现
+#include "glyph_cache.h"
+#include "epd_trace.h"
+
+#if (GLYPH_CACHE_BUCKETS & (GLYPH_CACHE_BUCKETS - 1)) || (GLYPH_CACHE_SLOTS > GLYPH_CACHE_BUCKETS)
+#error "GLYPH_CACHE_BUCKETS必须是2的幂且不小于GLYPH_CACHE_SLOTS"
+#endif
+
+GlyphCache glyphCache;
+
+void GlyphCanvas::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if ((x < 0) || (x >= GLYPH_RASTER_SIZE) || (y < 0) || (y >= GLYPH_RASTER_SIZE)) return;
+  uint8_t* p = &_buffer[y * (GLYPH_RASTER_SIZE / 8) + x / 8];
+  if (color) *p |= (0x80 >> (x & 7));
+  else *p &= ~(0x80 >> (x & 7));
+}
+
+GlyphCache::GlyphCache() : _font(0), _raster_advance(0), _hits(0), _misses(0), _evictions(0)
+{
+  clear();
+  _rasterizer.begin(_canvas);
+  _rasterizer.setFontMode(1);          // 透明模式：只画前景像素
+  _rasterizer.setFontDirection(0);
+  _rasterizer.setForegroundColor(1);
+}
+
+void GlyphCache::clear()
+{
+  for (uint16_t i = 0; i < HASH_SIZE; i++) _buckets[i] = NONE;
+  _head = _tail = NONE;
+  _used = 0;
+}
+
+void GlyphCache::_selectFont(const uint8_t* font)
+{
+  // setFont要重新解析字体头，逐段、逐页调用时开销不小
+  if (font == _font) return;
+  _rasterizer.setFont(font);
+  _font = font;
+}
+
+bool GlyphCache::supportsFont(const uint8_t* font)
+{
+  _selectFont(font);
+  const u8g2_font_info_t& fi = _rasterizer.u8g2.font_info;
+  int16_t cell_w = fi.max_char_width + (fi.x_offset < 0 ? -fi.x_offset : 0);
+  return (cell_w <= GLYPH_RASTER_SIZE) && (fi.max_char_height <= GLYPH_RASTER_SIZE);
+}
+
+uint16_t GlyphCache::_hash(const uint8_t* font, uint16_t encoding)
+{
+  uint32_t h = uint32_t(uintptr_t(font)) * 2654435761u ^ (uint32_t(encoding) * 40503u);
+  return (h ^ (h >> 16)) & (HASH_SIZE - 1);
+}
+
+const CachedGlyph* GlyphCache::lookup(const uint8_t* font, uint16_t encoding)
+{
+  uint16_t b = _hash(font, encoding);
+  for (uint16_t i = _buckets[b]; i != NONE; i = _chain[i])
+  {
+    if ((_slots[i].encoding == encoding) && (_slots[i].font == font))
+    {
+      _hits++;
+      if (_head != i)
+      {
+        _unlink(i);
+        _pushFront(i);
+      }
+      return &_slots[i];
+    }
+  }
+  _misses++;
+  // 取空闲槽，或淘汰链表尾部（最久未使用）
+  uint16_t i;
+  if (_used < GLYPH_CACHE_SLOTS)
+  {
+    i = _used++;
+  }
+  else
+  {
+    i = _tail;
+    _unlink(i);
+    _hashRemove(i);
+    _evictions++;
+  }
+  if (!_rasterize(_slots[i], font, encoding))
+  {
+    // 字形超出缓存尺寸：槽位放回链表尾部，结果留在画布上由调用方直接绘制
+    _slots[i].font = 0;
+    _chain[i] = NONE;
+    _prev[i] = _tail;
+    _next[i] = NONE;
+    if (_tail != NONE) _next[_tail] = i;
+    _tail = i;
+    if (_head == NONE) _head = i;
+    return 0;
+  }
+  _chain[i] = _buckets[b];
+  _buckets[b] = i;
+  _pushFront(i);
+  return &_slots[i];
+}
+
+int16_t GlyphCache::advance(const uint8_t* font, uint16_t encoding)
+{
+  const CachedGlyph* g = lookup(font, encoding);
+  return g ? g->advance : _raster_advance;
+}
+
+bool GlyphCache::_rasterize(CachedGlyph& g, const uint8_t* font, uint16_t encoding)
+{
+  // 笔位置放在字体包围盒左上角对齐画布的位置
+  _selectFont(font);
+  const u8g2_font_info_t& fi = _rasterizer.u8g2.font_info;
+  int16_t pen_x = fi.x_offset < 0 ? -fi.x_offset : 0;
+  int16_t baseline = fi.max_char_height + fi.y_offset;
+  _canvas.clear();
+  EPD_TRACE_BEGIN(EPD_TRACE_GLYPH, encoding);
+  int16_t advance = _rasterizer.drawGlyph(pen_x, baseline, encoding);
+  _raster_advance = advance;
+
+  // 求紧凑包围盒
+  int16_t x0 = GLYPH_RASTER_SIZE, y0 = GLYPH_RASTER_SIZE, x1 = -1, y1 = -1;
+  for (int16_t y = 0; y < GLYPH_RASTER_SIZE; y++)
+  {
+    for (int16_t x = 0; x < GLYPH_RASTER_SIZE; x++)
+    {
+      if (_canvas.getPixel(x, y))
+      {
+        if (x < x0) x0 = x;
+        if (x > x1) x1 = x;
+        if (y < y0) y0 = y;
+        if (y > y1) y1 = y;
+      }
+    }
+  }
+  EPD_TRACE_END(EPD_TRACE_GLYPH, encoding);
+  g.font = font;
+  g.encoding = encoding;
+  g.advance = advance;
+  if (x1 < 0) // 空白字形（如空格）
+  {
+    g.x_offset = g.y_offset = 0;
+    g.w = g.h = 0;
+    return true;
+  }
+  g.x_offset = x0 - pen_x;
+  g.y_offset = y0 - baseline;
+  g.w = x1 - x0 + 1;
+  g.h = y1 - y0 + 1;
+  if ((g.w > GLYPH_CACHE_MAX_W) || (g.h > GLYPH_CACHE_MAX_H)) return false;
+
+  uint8_t wb = (g.w + 7) / 8;
+  memset(g.bitmap, 0, wb * g.h);
+  for (int16_t y = 0; y < g.h; y++)
+  {
+    for (int16_t x = 0; x < g.w; x++)
+    {
+      if (_canvas.getPixel(x0 + x, y0 + y)) g.bitmap[y * wb + x / 8] |= (0x80 >> (x & 7));
+    }
+  }
+  return true;
+}
+
+void GlyphCache::blit(Adafruit_GFX& gfx, int16_t x, int16_t y, const CachedGlyph* g, uint16_t color)
+{
+  uint8_t wb = (g->w + 7) / 8;
+  int16_t left = x + g->x_offset;
+  int16_t top = y + g->y_offset;
+  for (int16_t row = 0; row < g->h; row++)
+  {
+    const uint8_t* line = &g->bitmap[row * wb];
+    int16_t run = -1;
+    for (int16_t col = 0; col <= g->w; col++)
+    {
+      bool on = (col < g->w) && (line[col / 8] & (0x80 >> (col & 7)));
+      if (on && (run < 0)) run = col;
+      else if (!on && (run >= 0))
+      {
+        gfx.drawFastHLine(left + run, top + row, col - run, color); // 按行段绘制，而不是逐像素
+        run = -1;
+      }
+    }
+  }
+}
+
+int16_t GlyphCache::drawUTF8(Adafruit_GFX& gfx, int16_t x, int16_t y, const char* text, const uint8_t* font, uint16_t color,
+                             const DirtyRect* clip)
+{
+  int16_t start_x = x;
+  uint16_t e;
+  while ((e = nextCodepoint(text)) != 0)
+  {
+    // 字形左边不会比笔位置再往左超过光栅化画布的宽度
+    if (clip && (x - GLYPH_RASTER_SIZE >= clip->right())) break;
+    const CachedGlyph* g = lookup(font, e);
+    if (g)
+    {
+      DirtyRect box = { int16_t(x + g->x_offset), int16_t(y + g->y_offset), g->w, g->h };
+      if (g->w && (!clip || box.intersects(*clip))) blit(gfx, x, y, g, color);
+      x += g->advance;
+    }
+    else
+    {
+      // 超出缓存尺寸的字形：直接从光栅化画布绘制
+      const u8g2_font_info_t& fi = _rasterizer.u8g2.font_info;
+      int16_t pen_x = fi.x_offset < 0 ? -fi.x_offset : 0;
+      int16_t baseline = fi.max_char_height + fi.y_offset;
+      for (int16_t cy = 0; cy < GLYPH_RASTER_SIZE; cy++)
+        for (int16_t cx = 0; cx < GLYPH_RASTER_SIZE; cx++)
+          if (_canvas.getPixel(cx, cy)) gfx.drawPixel(x + cx - pen_x, y + cy - baseline, color);
+      x += _raster_advance;
+    }
+  }
+  return x - start_x;
+}
+
+uint16_t GlyphCache::nextCodepoint(const char*& s)
+{
+  uint8_t c = uint8_t(*s);
+  if (c == 0) return 0;
+  s++;
+  if (c < 0x80) return c;
+  uint8_t extra;
+  uint32_t cp;
+  if (c >= 0xF0) { extra = 3; cp = c & 0x07; }
+  else if (c >= 0xE0) { extra = 2; cp = c & 0x0F; }
+  else if (c >= 0xC0) { extra = 1; cp = c & 0x1F; }
+  else return '?'; // 孤立的后续字节
+  while (extra--)
+  {
+    uint8_t n = uint8_t(*s);
+    if ((n & 0xC0) != 0x80) return '?'; // 非法序列
+    s++;
+    cp = (cp << 6) | (n & 0x3F);
+  }
+  return cp <= 0xFFFF ? uint16_t(cp) : '?'; // U8g2只支持BMP内的码点
+}
+
+void GlyphCache::_unlink(uint16_t i)
+{
+  if (_prev[i] != NONE) _next[_prev[i]] = _next[i];
+  else _head = _next[i];
+  if (_next[i] != NONE) _prev[_next[i]] = _prev[i];
+  else _tail = _prev[i];
+}
+
+void GlyphCache::_pushFront(uint16_t i)
+{
+  _prev[i] = NONE;
+  _next[i] = _head;
+  if (_head != NONE) _prev[_head] = i;
+  _head = i;
+  if (_tail == NONE) _tail = i;
+}
+
+void GlyphCache::_hashRemove(uint16_t i)
+{
+  if (!_slots[i].font) return; // 未入哈希表的槽位
+  uint16_t b = _hash(_slots[i].font, _slots[i].encoding);
+  uint16_t* p = &_buckets[b];
+  while (*p != NONE)
+  {
+    if (*p == i)
+    {
+      *p = _chain[i];
+      return;
+    }
+    p = &_chain[*p];
+  }
+}
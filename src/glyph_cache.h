@@ -0,0 +1,105 @@
+// glyph_cache.h
+// 字形光栅化缓存：U8g2字体（如u8g2_font_wqy16_t_gb2312b）的字形解码一次后以1bpp位图缓存，
+// 之后直接按行段blit，不再逐像素解码RLE数据
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "U8g2_for_Adafruit_GFX.h"
+#include "dirty_region.h"
+
+#ifndef GLYPH_CACHE_SLOTS
+#define GLYPH_CACHE_SLOTS 64    // 缓存字形数（一屏用到的汉字），每个约90字节
+#endif
+#ifndef GLYPH_CACHE_BUCKETS
+#define GLYPH_CACHE_BUCKETS 128 // 哈希桶数，2的幂，不小于GLYPH_CACHE_SLOTS
+#endif
+#define GLYPH_CACHE_MAX_W 24    // 可缓存字形的最大紧凑包围盒
+#define GLYPH_CACHE_MAX_H 24
+#define GLYPH_RASTER_SIZE 32    // 光栅化画布尺寸，字体单元格超过此尺寸的字体不走缓存
+
+// 缓存的字形：包围盒相对于笔位置（基线）的偏移 + 1bpp位图（每行(w+7)/8字节，MSB在左）
+struct CachedGlyph
+{
+  const uint8_t* font;
+  uint16_t encoding;
+  int8_t x_offset;    // 位图左边相对笔位置x
+  int8_t y_offset;    // 位图顶部相对基线y（向上为负）
+  uint8_t w, h;
+  int8_t advance;     // 笔位置前进量
+  uint8_t bitmap[((GLYPH_CACHE_MAX_W + 7) / 8) * GLYPH_CACHE_MAX_H];
+};
+
+// 光栅化用的小画布（静态缓冲区，避免GFXcanvas1在堆上分配）
+class GlyphCanvas : public Adafruit_GFX
+{
+  public:
+    GlyphCanvas() : Adafruit_GFX(GLYPH_RASTER_SIZE, GLYPH_RASTER_SIZE) { clear(); }
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void clear() { memset(_buffer, 0, sizeof(_buffer)); }
+    bool getPixel(int16_t x, int16_t y) const
+    {
+      return _buffer[y * (GLYPH_RASTER_SIZE / 8) + x / 8] & (0x80 >> (x & 7));
+    }
+  private:
+    uint8_t _buffer[GLYPH_RASTER_SIZE / 8 * GLYPH_RASTER_SIZE];
+};
+
+class GlyphCache
+{
+  public:
+    GlyphCache();
+
+    // 字体单元格是否能放进光栅化画布（否则调用方应直接用u8g2gfx绘制）
+    bool supportsFont(const uint8_t* font);
+
+    // 查找字形，未命中时光栅化并放入缓存（淘汰最久未使用的）；字形过大时返回0
+    const CachedGlyph* lookup(const uint8_t* font, uint16_t encoding);
+
+    // 字形前进量（未命中时同样会光栅化并缓存，随后绘制直接命中）
+    int16_t advance(const uint8_t* font, uint16_t encoding);
+
+    // 在gfx上以(x, y)为基线起点绘制UTF-8文本（透明背景），返回已处理文本的宽度。
+    // clip非0时（分页绘制的当前页）跳过与之不相交的字形，笔位置越过右边界后不再处理后面的字符
+    int16_t drawUTF8(Adafruit_GFX& gfx, int16_t x, int16_t y, const char* text, const uint8_t* font, uint16_t color,
+                     const DirtyRect* clip = 0);
+    // 绘制单个已缓存字形
+    static void blit(Adafruit_GFX& gfx, int16_t x, int16_t y, const CachedGlyph* g, uint16_t color);
+
+    // 命中/未命中统计
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t evictions() const { return _evictions; }
+    void resetStats() { _hits = _misses = _evictions = 0; }
+    void clear();
+
+    // UTF-8解码：返回下一个码点并前移指针，字符串结束返回0
+    static uint16_t nextCodepoint(const char*& s);
+
+  private:
+    static uint16_t _hash(const uint8_t* font, uint16_t encoding);
+    void _selectFont(const uint8_t* font);
+    bool _rasterize(CachedGlyph& g, const uint8_t* font, uint16_t encoding);
+    void _unlink(uint16_t i);
+    void _pushFront(uint16_t i);
+    void _hashRemove(uint16_t i);
+
+  private:
+    static const uint16_t NONE = 0xFFFF;
+    static const uint16_t HASH_SIZE = GLYPH_CACHE_BUCKETS;
+    CachedGlyph _slots[GLYPH_CACHE_SLOTS];
+    uint16_t _prev[GLYPH_CACHE_SLOTS], _next[GLYPH_CACHE_SLOTS]; // LRU双向链表（头部最近使用）
+    uint16_t _chain[GLYPH_CACHE_SLOTS];                          // 哈希桶链
+    uint16_t _buckets[HASH_SIZE];
+    uint16_t _head, _tail, _used;
+    GlyphCanvas _canvas;
+    U8G2_FOR_ADAFRUIT_GFX _rasterizer;
+    const uint8_t* _font;     // _rasterizer当前字体，变化时才调用setFont
+    int16_t _raster_advance;  // 最近一次光栅化的前进量（未入缓存的大字形使用）
+    uint32_t _hits, _misses, _evictions;
+};
+
+extern GlyphCache glyphCache;
+
+#endif
@@ -27,41 +27,89 @@
 // 关键：U8g2适配Adafruit_GFX（GxEPD2继承自Adafruit_GFX）
 #include "U8g2_for_Adafruit_GFX.h"
 #include <cstdio>
-
-// 选择显示类（仅一个），需与电子纸面板类型匹配
-#define GxEPD2_DISPLAY_CLASS GxEPD2_BW
-
-// 选择显示驱动类（仅一个），需与你的面板匹配
-#define GxEPD2_DRIVER_CLASS GxEPD2_290     // GDEH029A1   128x296, SSD1608 (IL3820), (E029A01-FPC-A1 SYX1553)
-
-// 定义显示类型相关的宏
-#define GxEPD2_BW_IS_GxEPD2_BW true
-#define IS_GxEPD(c, x) (c##x)
-#define IS_GxEPD2_BW(x) IS_GxEPD(GxEPD2_BW_IS_, x)
+#include "epd_display.h"
+#include "glyph_cache.h"
+#include "text_metrics.h"
+#include "text_layout.h"
+#include "epd_benchmark.h"
+#include "epd_update_queue.h"
+#include "epd_widgets.h"
+#include "epd_panels.h"
+#include "epd_snapshot.h"
+#include "boot_profiler.h"
+#include "epd_energy.h"
+#include "epd_trace.h"
+#include "epd_server.h"
 
 #if defined(ESP32)
-    #define MAX_DISPLAY_BUFFER_SIZE 65536ul // 最大显示缓冲区大小
-    #if IS_GxEPD2_BW(GxEPD2_DISPLAY_CLASS)
-    // 计算最大高度，确保不超过缓冲区大小
-    #define MAX_HEIGHT(EPD) (EPD::HEIGHT <= MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8) ? EPD::HEIGHT : MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8))
-    #endif
-
-    // 定义显示类型
-    typedef GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> DisplayType;
-
     // 初始化显示对象，参数为引脚：CS=15, DC=27, RST=26, BUSY=25
+    // 显示类、驱动类及DisplayType的定义见epd_display.h
     DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
 #endif
 
-// 部分刷新窗口配置（满足字节对齐）
+// 多面板测试：构建参数加-DEPD_MULTI_PANEL时，第二块面板与第一块共用HSPI和DC，CS/RST/BUSY单独接线
+#if defined(EPD_MULTI_PANEL) && defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+#ifndef EPD_PANEL2_CS
+#define EPD_PANEL2_CS 4
+#endif
+#ifndef EPD_PANEL2_RST
+#define EPD_PANEL2_RST 17
+#endif
+#ifndef EPD_PANEL2_BUSY
+#define EPD_PANEL2_BUSY 16
+#endif
+EpdDisplay panel2(GxEPD2_DRIVER_CLASS(EPD_PANEL2_CS, /*DC=*/ 27, EPD_PANEL2_RST, EPD_PANEL2_BUSY));
+EpdBusyWait panel2Busy;
+void multiPanelTest();
+#endif
+
+// 深睡眠唤醒测试：构建参数加-DEPD_DEEP_SLEEP_DEMO时，setup()只更新唤醒计数然后深睡眠，每EPD_WAKE_INTERVAL_S秒唤醒一次；
+// 最后一帧保留在RTC内存中，唤醒后只差分局部刷新变化的数字（面板在深睡眠期间保持供电）
+#if defined(EPD_DEEP_SLEEP_DEMO) && defined(ESP32)
+#include <esp_sleep.h>
+#ifndef EPD_WAKE_INTERVAL_S
+#define EPD_WAKE_INTERVAL_S 60
+#endif
+RTC_DATA_ATTR EpdRetainedFrame retainedFrame;
+RTC_DATA_ATTR uint32_t wakeCount;
+void deepSleepCycle(bool warm);
+#endif
+
+// 即时启动：闪存中有屏幕当前画面的快照时不清屏、不全刷，直接局部刷新（-DEPD_INSTANT_ON=0关闭）
+#ifndef EPD_INSTANT_ON
+#define EPD_INSTANT_ON 1
+#endif
+#if EPD_INSTANT_ON
+EpdSnapshot snapshot;
+EpdRetainedFrame snapshotFrame;  // 4.9KB，放在全局而不是栈上
+#endif
+// 启动计时：从复位到SPI就绪、控制器就绪、第一帧可见
+BootProfiler bootProfile;
+
+// 刷新测试方块配置（满足字节对齐；刷新窗口由脏矩形跟踪从fillRect自动求出）
 #define REFRESH_X 8
 #define REFRESH_Y 8
 #define REFRESH_W 16
 #define REFRESH_H 16
 #define TEST_COUNT 20  // 测试次数（减少次数避免显示拥挤）
 
+// 分阶段基准测试：构建参数加-DEPD_BENCHMARK时在setup()中执行，结果以CSV和JSON输出到串口
+#if defined(EPD_BENCHMARK)
+static const EpdBenchSize benchSizes[] = { { 8, 8 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 128, 128 } };
+static const EpdBenchConfig benchConfig =
+{
+  benchSizes, sizeof(benchSizes) / sizeof(benchSizes[0]),
+  EPD_BENCH_TOP_LEFT | EPD_BENCH_CENTER | EPD_BENCH_BOTTOM_RIGHT,
+  0x0F,      // 四个旋转方向
+  (1 << EPD_LUT_PROFILE_COUNT) - 1,  // 全部局部刷新波形
+  20, 1,     // 每项20次，第1次预热
+  EPD_BENCH_CSV | EPD_BENCH_JSON
+};
+#endif
+
 
-U8G2_FOR_ADAFRUIT_GFX u8g2gfx;
+// u8g2gfx（U8g2字体绘制）、glyphCache（已光栅化字形的LRU缓存）、textMetrics（文本宽度/边界测量缓存）
+// 定义在各自的模块中（text_layout.cpp、glyph_cache.cpp、text_metrics.cpp），单元测试不编译本文件时也能链接
 
 #include "epaper_bitmaps.h"
 
@@ -71,12 +119,40 @@ U8G2_FOR_ADAFRUIT_GFX u8g2gfx;
 #if defined(ESP32) && defined(USE_HSPI_FOR_EPD)
 // 定义HSPI对象
 SPIClass hspi(HSPI);
+// 面板数据的DMA异步传输（时钟可用-DEPD_SPI_CLOCK_HZ=...调整，上限见epd_transport.h）
+EpdTransport epdTransport;
+#endif
+// BUSY（引脚25）用中断等待，刷新期间本任务让出CPU
+EpdBusyWait epdBusy;
+// 重影预算：局部刷新累计到预算才全刷，优先在loop()空闲时做
+EpdGhostTracker epdGhost;
+// 数值、状态文本等频繁变化的元素经队列合并刷新（loop()中处理）
+EpdUpdateQueue updateQueue(display);
+// 能耗记账：每次更新各状态的时间与估算电荷，串口输入energy查询（见epd_energy.h）
+EpdEnergyMeter epdEnergy;
+static char serialLine[48];
+static uint8_t serialLength;
+
+// 串口波特率：显示服务模式下主机发送整帧约4.7KB，115200时约0.4秒，可提高到921600
+#ifndef EPD_SERIAL_BAUD
+#define EPD_SERIAL_BAUD 115200
+#endif
+// 显示服务模式：构建参数加-DEPD_DISPLAY_SERVER时，setup()显示启动画面后不运行演示，
+// loop()接收主机（tools/epd_send.py）发来的整帧、压缩帧与矩形差分并局部刷新（见epd_server.h）
+#if defined(EPD_DISPLAY_SERVER)
+EpdServer server(display);
 #endif
 
 // 声明需使用的字体（中文字库+英文字体，统一通过U8g2管理）
 // 中文字库：u8g2_font_wqy16_t_gb2312b（16号文泉驿正黑，支持GB2312）
 // 英文字体：u8g2_font_helvB12_tf（12号Helvetica粗体，与中文字体风格匹配）
+#if __has_include("font_subset.h")
+// 构建时由tools/font_subset.py生成的子集：只含源码字符串和font_subset.txt中出现的字符
+#include "font_subset.h"
+const uint8_t* chineseFont = FONT_SUBSET;
+#else
 const uint8_t* chineseFont = u8g2_font_wqy16_t_gb2312b;
+#endif
 const uint8_t* englishFont = u8g2_font_helvB12_tf;
 
 
@@ -96,17 +172,41 @@ void drawBitmaps();
 void drawBitmaps128x296();
 void drawMyImage();
 //统一文本显示函数（支持汉字、英文、数字混合显示）
-void drawUniversalText(int16_t x, int16_t y, const char* text, const uint8_t* font, uint16_t color, uint8_t alignment = 0);
+void drawUniversalText(const TextLayout& layout, uint16_t color);
 void testUnifiedTextDisplay();// 测试函数：验证统一接口的混合显示效果
+void showTestResults(long count, unsigned long minUs, unsigned long maxUs, float avgFps, float maxFps);
+
+// updateDirty()绘图回调（签名与GxEPD2的drawPaged()一致）
+struct TextAt
+{
+  int16_t x;
+  int16_t y;
+  const char* text;
+};
+struct BoxFill
+{
+  int16_t x, y, w, h;
+  uint16_t color;
+  int16_t cursor_y;     // >=0时在方块内打印value
+  float value;
+};
+void drawRefreshTestBox(const void* pv);
+void drawTextAt(const void* pv);
+void drawBoxFill(const void* pv);
+void serialCommand(const char* line, void*);  // 串口文本命令（energy、trace）
 
 
 
 
 void setup()
 {
-  Serial.begin(115200);
+#if defined(EPD_DISPLAY_SERVER)
+  Serial.setRxBufferSize(EPD_SERVER_RX_BUFFER);
+#endif
+  Serial.begin(EPD_SERIAL_BAUD);
   Serial.println();
   Serial.println("setup");
+  epdEnergy.begin();
 
   // *** 针对Waveshare ESP32驱动板的特殊处理 *** //
   // ********************************************************* //
@@ -114,48 +214,105 @@ void setup()
 #if defined(ESP32) && defined(USE_HSPI_FOR_EPD)
   hspi.begin(14, -1, 13);  // sck=14, miso=-1(不使用), mosi=13(根据硬件连接配置)
   // 关键：使用SPI时，E029A01默认需要MODE0，若使用MODE3可能无法读取
-  SPISettings epd_spi_settings(4000000, MSBFIRST, SPI_MODE0); // 4MHz速率，SPI模式为MODE0
+  SPISettings epd_spi_settings(EPD_SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0); // 默认4MHz速率，SPI模式为MODE0
   display.epd2.selectSPI(hspi, epd_spi_settings); // 选择配置好的SPI对象
+#endif
+  bootProfile.mark("spi");
+#if defined(EPD_MULTI_PANEL) && defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+  // 第二块面板的CS先拉高，否则它会收到第一块面板的初始化与数据
+  pinMode(EPD_PANEL2_CS, OUTPUT);
+  digitalWrite(EPD_PANEL2_CS, HIGH);
 #endif
   // *** 初始化显示屏（原函数display.init(115200)改为无参，保持默认配置）*** //
-  display.init();
+  // 屏幕上已有可信的画面（深睡眠唤醒或闪存快照）时不清空控制器RAM，第一次刷新也不强制全刷
+  bool keep = false;
+#if defined(EPD_DEEP_SLEEP_DEMO) && defined(ESP32)
+  bool warm = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) && epdRetainedValid(retainedFrame);
+  keep = warm;
+#endif
+#if EPD_INSTANT_ON
+  bool instant = !keep && snapshot.begin() && snapshot.load(snapshotFrame);
+  keep = keep || instant;
+#else
+  bool instant = false;
+#endif
+  display.init(0, !keep);
   display.setRotation(1);
+  // 启用行级差分传输：只发送与上一帧不同的行（影子副本4736字节）
+  display.epd2.setDeltaTransfer(true);
+  display.epd2.setBusyWait(&epdBusy, EPD_BUSY_IRQ);
+  display.epd2.setGhostTracker(&epdGhost);
+  display.epd2.setEnergyMeter(&epdEnergy);
+#if EPD_INSTANT_ON
+  // 断电后控制器RAM已丢失：把快照写回控制器（屏幕不变），失败时按冷启动清屏全刷
+  if (instant && !display.restore(snapshotFrame, true))
+  {
+    instant = false;
+    display.init();
+  }
+  display.setRotation(1);
+  // 快照保存之后屏幕又更新过：画面可能与快照不完全一致，空闲时全刷一次清除残留
+  if (instant && snapshot.stale()) epdGhost.requestFullRefresh();
+#endif
+#if defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+  // 把HSPI交给DMA传输层：nextPage()排队数据后立即返回，渲染下一页与发送上一页重叠
+  if (epdTransport.begin(hspi, 14, 13, /*CS=*/ 15, /*DC=*/ 27, EPD_SPI_CLOCK_HZ)) display.epd2.setTransport(&epdTransport);
+  else Serial.println("DMA传输初始化失败，使用阻塞SPI");
+#endif
   Serial.println("显示屏初始化完成"); // 打印提示确认初始化执行
+  // 冷启动时控制器在第一次写入时才复位初始化，计入第一帧；即时启动时这里已经写回了快照
+  bootProfile.mark("controller");
 
   // 关键：初始化U8g2与GxEPD2显示对象的绑定
   u8g2gfx.begin(display);  // 将u8g2gfx与display关联，后续通过u8g2gfx绘图
+#if defined(EPD_DEEP_SLEEP_DEMO) && defined(ESP32)
+  deepSleepCycle(warm);  // 不返回
+#endif
 //   drawCustomContent();  // 绘制自定义内容
 //   delay(5000);
-   // 显示自定义图片
-//   display.setFullWindow(); // 全屏幕刷新（图片需要全刷新）
-//   display.firstPage();     // 开始绘图循环
-//   do {
-//     display.fillScreen(GxEPD_WHITE); // 填充背景为白色
-//     // 绘制自定义生成的图片（此处替换为实际图片对应的绘制函数）
-//     draw_rgb_cam_1758806792_png();
-//   } while (display.nextPage()); // 完成绘图并刷新屏幕
+   // 显示自定义图片（流式写入控制器RAM，不经过显示缓冲区）
+//   drawMyImage();
 //     delay(5000);
 //   display.setFullWindow();//diaplay.init()里面已经设置过了
 
+#if EPD_INSTANT_ON
+  snapshot.markDirty();
+#endif
   helloWorld();
+  bootProfile.mark("visible");
+  Serial.println(instant ? "启动：快照恢复，直接局部刷新" : "启动：清屏全刷");
+  bootProfile.report(Serial);
+#if defined(EPD_DISPLAY_SERVER)
+  // 屏幕保持启动画面，主机连接后发送第一帧整帧
+  server.begin(Serial);
+  server.setLineHandler(serialCommand, 0);
+  display.powerOff();
+  Serial.printf("显示服务：%d x %d，等待主机\n", display.width(), display.height());
+  return;
+#endif
   helloEpaper();
 
 
 //   // 测试新的统一文本显示函数
 //   testUnifiedTextDisplay();
 
-    display.setPartialWindow(REFRESH_X, REFRESH_Y, REFRESH_W, REFRESH_H);
+#if defined(EPD_BENCHMARK)
+  runRefreshBenchmark(display, benchConfig, Serial);
+#endif
+#if defined(EPD_MULTI_PANEL) && defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+  multiPanelTest();
+#endif
+
   unsigned long totalTime = 0;
   unsigned long minTime = 1000000;
   unsigned long maxTime = 0;
 
+  // 计数器类的小区域更新用快速波形：每次略有残影，换来更低的刷新延迟
+  display.epd2.setLutProfile(EPD_LUT_FAST);
   for (int i = 0; i < TEST_COUNT; i++) {
     unsigned long start = micros();
-    // 执行部分刷新（绘制简单内容）
-    display.firstPage();
-    do {
-      display.fillRect(REFRESH_X, REFRESH_Y, REFRESH_W, REFRESH_H, i % 2 == 0 ? GxEPD_BLACK : GxEPD_WHITE);
-    } while (display.nextPage());
+    // 执行部分刷新（绘制简单内容），窗口即测试方块本身
+    display.updateDirty(drawRefreshTestBox, &i);
     unsigned long end = micros();
     unsigned long duration = end - start;
 
@@ -164,128 +321,125 @@ void setup()
     if (duration > maxTime) maxTime = duration;
     delayMicroseconds(100);  // 避免硬件过载
   }
+  display.epd2.setLutProfile(EPD_LUT_STANDARD);
+
+  Serial.printf("差分传输：发送%lu行，跳过%lu行\n", (unsigned long)display.epd2.rowsSent(), (unsigned long)display.epd2.rowsSkipped());
+#if defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+  Serial.printf("DMA传输：%lu字节，等待%luμs，时钟%luHz\n", (unsigned long)epdTransport.bytesQueued(),
+                (unsigned long)epdTransport.blockedMicros(), (unsigned long)epdTransport.clock());
+#endif
+  Serial.printf("BUSY等待：%luμs，中断唤醒%lu次\n", (unsigned long)epdBusy.blockedMicros(), (unsigned long)epdBusy.wakeups());
+  Serial.printf("快速波形：局部刷新%luμs（标准波形%luμs）\n", (unsigned long)display.epd2.lutRefreshMicros(EPD_LUT_FAST),
+                (unsigned long)display.epd2.lutRefreshMicros(EPD_LUT_STANDARD));
 
   // 计算测试结果
   float avgDurationMs = totalTime / TEST_COUNT / 1000.0;
   float avgFps = 1000.0 / avgDurationMs;
   float maxFps = 1000000.0 / minTime;
 
-  // 在屏幕上显示结果（全窗口刷新确保清晰）
-  display.setFullWindow();
-  display.firstPage();
-  do {
-    display.fillScreen(GxEPD_WHITE);  // 清空背景
+  // 在屏幕上显示结果：整屏局部刷新，重影超出预算时驱动自动改为全刷
+  showTestResults(TEST_COUNT, minTime, maxTime, avgFps, maxFps);
 
-    // 标题（居中）
-    drawUniversalText(
-      display.width() / 2, 20,
-      "刷新率测试结果",
-      chineseFont,
-      GxEPD_BLACK,
-      1  // 居中对齐
-    );
-
-    // 测试次数（左对齐）
-    char countStr[32];
-    sprintf(countStr, "测试次数：%d次", TEST_COUNT);
-    drawUniversalText(
-      10, 50,
-      countStr,
-      chineseFont,
-      GxEPD_BLACK,
-      0  // 左对齐
-    );
-
-    // 最小耗时
-    char minStr[32];
-    sprintf(minStr, "最小耗时：%luμs", minTime);
-    drawUniversalText(
-      10, 75,
-      minStr,
-      chineseFont,
-      GxEPD_BLACK,
-      0
-    );
-
-    // 最大耗时
-    char maxStr[32];
-    sprintf(maxStr, "最大耗时：%luμs", maxTime);
-    drawUniversalText(
-      10, 100,
-      maxStr,
-      chineseFont,
-      GxEPD_BLACK,
-      0
-    );
-
-    // 平均刷新率（右对齐）
-    char avgFpsStr[32];
-    sprintf(avgFpsStr, "平均：%.2f FPS", avgFps);
-    drawUniversalText(
-      display.width() - 10, 75,
-      avgFpsStr,
-      englishFont,
-      GxEPD_BLACK,
-      2  // 右对齐
-    );
-
-    // 最大刷新率（右对齐）
-    char maxFpsStr[32];
-    sprintf(maxFpsStr, "最大：%.2f FPS", maxFps);
-    drawUniversalText(
-      display.width() - 10, 100,
-      maxFpsStr,
-      englishFont,
-      GxEPD_BLACK,
-      2
-    );
-
-  } while (display.nextPage());
+  Serial.printf("字形缓存：命中%lu次，未命中%lu次，淘汰%lu次\n",
+                (unsigned long)glyphCache.hits(), (unsigned long)glyphCache.misses(), (unsigned long)glyphCache.evictions());
 
+  Serial.printf("分页裁剪：%lu次图元调用落在当前页之外\n", (unsigned long)display.culledCalls());
 
+  Serial.printf("重影预算：最高%u%%，全刷%lu次（超预算直接全刷%lu次）\n", epdGhost.worst(),
+                (unsigned long)epdGhost.fullRefreshes(), (unsigned long)epdGhost.promotions());
+
+#if EPD_INSTANT_ON
+  // 画面稳定：保存快照，下次断电重启直接从这一帧局部刷新。还没有快照时立即写入，
+  // 已有快照时受EPD_SNAPSHOT_INTERVAL_MS限制（结果页的计时每次启动都不同，强制保存等于每次复位都写闪存），
+  // 到时由loop()补存
+  if (display.retain(snapshotFrame) && snapshot.save(snapshotFrame)) Serial.println("快照已保存");
+#endif
   display.powerOff();
+  epdEnergy.report(Serial);
+  bootProfile.mark("setup");
   Serial.println("setup done");
 }
 
+// 串口命令：energy为能耗查询（见epd_energy.h），trace导出事件跟踪（见epd_trace.h）
+void serialCommand(const char* line, void*)
+{
+  bool handled = !*line || epdEnergy.command(line, Serial);
+#if EPD_TRACE
+  handled = handled || epdTrace.command(line, Serial);
+#endif
+  if (!handled) Serial.printf("未知命令：%s\n", line);
+}
+
+// 按行收集串口输入
+void serviceSerial()
+{
+  while (Serial.available())
+  {
+    int c = Serial.read();
+    if ((c != '\n') && (c != '\r'))
+    {
+      if (serialLength < sizeof(serialLine) - 1) serialLine[serialLength++] = c;
+      continue;
+    }
+    serialLine[serialLength] = 0;
+    serialCommand(serialLine, 0);
+    serialLength = 0;
+  }
+}
+
 void loop()
 {
+  epdEnergy.poll();
+#if defined(EPD_DISPLAY_SERVER)
+  // 串口由显示服务接收，帧之外的文本行交给serialCommand()
+  if (server.poll())
+  {
+#if EPD_INSTANT_ON
+    snapshot.markDirty();
+#endif
+    return;
+  }
+#else
+  serviceSerial();
+#endif
+#if EPD_INSTANT_ON
+  if (updateQueue.pending()) snapshot.markDirty();
+#endif
+  if (updateQueue.service()) return;
+  // 空闲时清除累积的重影：只有超出预算才全刷
+  if (!updateQueue.pending() && display.epd2.refreshIfGhosted())
+  {
+    display.powerOff();
+    Serial.println("空闲全刷：重影超出预算");
+  }
+#if EPD_INSTANT_ON
+  // 空闲时按最短间隔更新快照
+  if (!updateQueue.pending() && snapshot.due() && display.retain(snapshotFrame)) snapshot.save(snapshotFrame);
+#endif
 }
 
 // 测试函数：验证统一接口的混合显示效果
 void testUnifiedTextDisplay()
 {
+  int16_t screenHeight = display.height();
+  // 1. 左对齐：混合中英文+数字（数字和符号用英文字体，汉字用中文字体）
+  const TextStyle mixedStyle = { englishFont, chineseFont, 0, TEXT_ALIGN_LEFT, 0, 0, screenHeight };
+  const TextLayout mixed(10, 14, "温度：25.5℃ 湿度：60%", mixedStyle);
+  // 2. 居中对齐：英文句子，超过屏幕宽度一半时自动换行
+  const TextStyle englishStyle = { englishFont, 0, 0, TEXT_ALIGN_CENTER, int16_t(display.width() / 2), 2, screenHeight };
+  const TextLayout english(display.width() / 2, 60, "ESP32 & E-Paper Demo", englishStyle);
+  // 3. 右对齐：中文句子
+  const TextStyle chineseStyle = { 0, chineseFont, 0, TEXT_ALIGN_RIGHT, 0, 0, screenHeight };
+  const TextLayout chinese(display.width() - 10, 126, "统一接口测试成功", chineseStyle);
+
   display.setPartialFullWindow();
   display.firstPage();
   do
   {
     display.fillScreen(GxEPD_WHITE);
-
-    // 1. 左对齐：混合中英文+数字
-    drawUniversalText(
-      10, 14,
-      "温度：25.5℃ 湿度：60%",  // 含汉字、数字、符号
-      chineseFont,
-      GxEPD_BLACK,
-      0  // 左对齐
-    );
-
-    // 2. 居中对齐：英文句子
-    drawUniversalText(
-      display.width() / 2, 80,
-      "ESP32 & E-Paper Demo",
-      englishFont,
-      GxEPD_BLACK,
-      1  // 居中
-    );
-
-    // 3. 右对齐：中文句子
-    drawUniversalText(
-      display.width() - 10, 126,
-      "统一接口测试成功",
-      chineseFont,
-      GxEPD_BLACK,
-      2  // 右对齐
-    );
+    drawUniversalText(mixed, GxEPD_BLACK);
+    drawUniversalText(english, GxEPD_BLACK);
+    drawUniversalText(chinese, GxEPD_BLACK);
   }
   while (display.nextPage());
   delay(5000);  // 显示5秒
@@ -293,70 +447,18 @@ void testUnifiedTextDisplay()
 
 /**
  * 统一文本显示函数（支持汉字、英文、数字混合显示）
- * @param x：文本左上角x坐标（或对齐基准点x）
- * @param y：文本基线y坐标（U8g2文本绘制以基线为基准，非左上角）
- * @param text：要显示的字符串（支持GB2312汉字+ASCII字符）
- * @param font：U8g2字体（如chineseFont/englishFont）
- * @param color：文本颜色（GxEPD_BLACK/GxEPD_WHITE，电子纸仅支持黑白）
- * @param alignment：对齐方式（0=左对齐，1=居中，2=右对齐）
- */
-/**
- * 统一文本显示函数（支持汉字、英文、数字混合显示）
- * 基于字体特性优化：Ascent=14（基线到顶部距离），Descent=-2（基线到底部距离）
- * @param x：文本左上角x坐标（或对齐基准点x）
- * @param y：文本基线y坐标（U8g2文本绘制以基线为基准）
- * @param text：要显示的字符串（支持GB2312汉字+ASCII字符）
- * @param font：U8g2字体（如chineseFont/englishFont）
+ * 排版（字体的ascent/descent/advance、对齐、换行）在firstPage()之前构造TextLayout时完成一次，
+ * 分页循环内每页只调用这里绘制，不再重新排版
+ * @param layout：排好版的文本（TextStyle指定中英文字体与对齐方式）
  * @param color：文本颜色（GxEPD_BLACK/GxEPD_WHITE）
- * @param alignment：对齐方式（0=左对齐，1=居中，2=右对齐）
  */
-void drawUniversalText(int16_t x, int16_t y, const char* text, const uint8_t* font, uint16_t color, uint8_t alignment)
+void drawUniversalText(const TextLayout& layout, uint16_t color)
 {
-  // 1. 字体固定参数（根据测试得出）
-  const int16_t ascent = 14;    // 基线到文本顶部的距离
-  const int16_t descent = -2;   // 基线到文本底部的距离（负值）
-  const uint16_t fontHeight = ascent - descent;  // 字体总高度：14 - (-2) = 16
-  const uint16_t screenHeight = display.height(); // 屏幕高度（旋转后为128）
-
-  // 2. 设置字体和颜色
-  u8g2gfx.setFont(font);
-  u8g2gfx.setForegroundColor(color == GxEPD_BLACK ? 0 : 1);
-  u8g2gfx.setBackgroundColor(color == GxEPD_WHITE ? 0 : 1);
-
-  // 3. 计算对齐后的x坐标
-  if (alignment != 0)
-  {
-    uint16_t textWidth = u8g2gfx.getUTF8Width(text);
-    if (alignment == 1)  // 居中对齐
-    {
-      x -= textWidth / 2;
-    }
-    else if (alignment == 2)  // 右对齐
-    {
-      x -= textWidth;
-    }
-  }
-
-  // 4. 边界检查与y坐标调整（确保文本完全显示在屏幕内）
-  int16_t textTop = y - ascent;       // 文本顶部坐标
-  int16_t textBottom = y - descent;   // 文本底部坐标（实际为y + 2）
-
-  // 若文本顶部超出屏幕上边界，调整到刚好可见
-  if (textTop < 0)
-  {
-    y = ascent;  // 顶部对齐屏幕顶部（基线=ascent，此时textTop=0）
-  }
-  // 若文本底部超出屏幕下边界，调整到刚好可见
-  else if (textBottom > screenHeight)
-  {
-    y = screenHeight + descent;  // 底部对齐屏幕底部（128 - 2 = 126）
-  }
-
-  // 5. 绘制文本（确保在调整后的安全坐标内）
-  u8g2gfx.drawUTF8(x, y, text);
+  EPD_TRACE_BEGIN(EPD_TRACE_TEXT, layout.x(), layout.y(), layout.width(), layout.height());
+  layout.draw(display, color);
+  EPD_TRACE_END(EPD_TRACE_TEXT);
 }
 
-
 // void drawUniversalText(int16_t x, int16_t y, const char* text, const uint8_t* font, uint16_t color, uint8_t alignment)
 // {
 //   // 1. 设置字体
@@ -410,7 +512,7 @@ void drawCustomContent() {
     // --------------------------
     // 计算文字1的边界框以实现居中
     int16_t tbx1, tby1; uint16_t tbw1, tbh1;
-    display.getTextBounds(customText1, 0, 0, &tbx1, &tby1, &tbw1, &tbh1);
+    textMetrics.textBounds(display, customText1, 0, 0, &tbx1, &tby1, &tbw1, &tbh1);
     uint16_t x1 = (screenW - tbw1) / 2 - tbx1;  // 水平居中
     uint16_t y1 = screenH / 3 - tby1;           // 垂直位置（1/3高度处）
     display.setCursor(x1, y1);
@@ -418,7 +520,7 @@ void drawCustomContent() {
 
     // 计算文字2的边界框
     int16_t tbx2, tby2; uint16_t tbw2, tbh2;
-    display.getTextBounds(customText2, 0, 0, &tbx2, &tby2, &tbw2, &tbh2);
+    textMetrics.textBounds(display, customText2, 0, 0, &tbx2, &tby2, &tbw2, &tbh2);
     uint16_t x2 = (screenW - tbw2) / 2 - tbx2;
     uint16_t y2 = screenH * 2 / 3 - tby2;       // 垂直位置（2/3高度处）
     display.setCursor(x2, y2);
@@ -451,31 +553,20 @@ const char HelloEpaper[] = "Hello E-Paper!";
 // 示例：改造helloWorld函数
 void helloWorld()
 {
+  int16_t screenHeight = display.height();
+  const TextStyle centered = { englishFont, chineseFont, 0, TEXT_ALIGN_CENTER, 0, 0, screenHeight };
+  // 显示英文（使用英文字体，居中对齐；x为屏幕中点，y为基线位置）
+  const TextLayout english(display.width() / 2, display.height() / 2, HelloWorld, centered);
+  // 显示汉字（使用中文字库，在英文下方，基线下移30px）
+  const TextLayout chinese(display.width() / 2, display.height() / 2 + 30, "你好，世界！", centered);
+
   display.setPartialFullWindow();
   display.firstPage();
   do
   {
     display.fillScreen(GxEPD_WHITE);  // 清空背景
-
-    // 显示英文（使用英文字体，居中对齐）
-    drawUniversalText(
-      display.width() / 2,    // x：屏幕中点（居中基准）
-      display.height() / 2,   // y：基线位置（垂直居中）
-      "Hello World!",         // 文本内容
-      englishFont,            // 英文字体
-      GxEPD_BLACK,            // 黑色文本
-      1                       // 居中对齐
-    );
-
-    // 显示汉字（使用中文字库，在英文下方）
-    drawUniversalText(
-      display.width() / 2,
-      display.height() / 2 + 30,  // 基线下移30px（字体高度约16px，留间距）
-      "你好，世界！",
-      chineseFont,
-      GxEPD_BLACK,
-      1
-    );
+    drawUniversalText(english, GxEPD_BLACK);
+    drawUniversalText(chinese, GxEPD_BLACK);
   }
   while (display.nextPage());
 }
@@ -493,7 +584,7 @@ void helloWorldForDummies()
   display.setTextColor(GxEPD_BLACK);
   // Adafruit_GFX的getTextBounds()方法可确定当前字体下文本的边界框
   int16_t tbx, tby; uint16_t tbw, tbh; // 边界框窗口
-  display.getTextBounds(text, 0, 0, &tbx, &tby, &tbw, &tbh); // 适用于原点(0,0)，tby可能为负
+  textMetrics.textBounds(display, text, 0, 0, &tbx, &tby, &tbw, &tbh); // 适用于原点(0,0)，tby可能为负
   // 通过原点转换使边界框居中
   uint16_t x = ((display.width() - tbw) / 2) - tbx;
   uint16_t y = ((display.height() - tbh) / 2) - tby;
@@ -548,15 +639,15 @@ void helloFullScreenPartialMode()
   // 在循环外执行此操作
   int16_t tbx, tby; uint16_t tbw, tbh;
   // 居中更新文本
-  display.getTextBounds(fullscreen, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, fullscreen, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t utx = ((display.width() - tbw) / 2) - tbx;
   uint16_t uty = ((display.height() / 4) - tbh / 2) - tby;
   // 居中更新模式
-  display.getTextBounds(updatemode, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, updatemode, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t umx = ((display.width() - tbw) / 2) - tbx;
   uint16_t umy = ((display.height() * 3 / 4) - tbh / 2) - tby;
   // 居中HelloWorld
-  display.getTextBounds(HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh, true);
   uint16_t hwx = ((display.width() - tbw) / 2) - tbx;
   uint16_t hwy = ((display.height() - tbh) / 2) - tby;
   display.firstPage();
@@ -580,23 +671,14 @@ void helloArduino()
   display.setTextColor(display.epd2.hasColor ? GxEPD_RED : GxEPD_BLACK);
   int16_t tbx, tby; uint16_t tbw, tbh;
   // 与居中的HelloWorld对齐
-  display.getTextBounds(HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh, true);
   uint16_t x = ((display.width() - tbw) / 2) - tbx;
   // 高度可能不同
-  display.getTextBounds(HelloArduino, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, HelloArduino, 0, 0, &tbx, &tby, &tbw, &tbh, true);
   uint16_t y = ((display.height() / 4) - tbh / 2) - tby; // y是基线！
-  // 使窗口足够大以覆盖（覆盖）先前文本的下行部分
-  uint16_t wh = FreeMonoBold9pt7b.yAdvance;
-  uint16_t wy = (display.height() / 4) - wh / 2;
-  display.setPartialWindow(0, wy, display.width(), wh);
-  display.firstPage();
-  do
-  {
-    display.fillScreen(GxEPD_WHITE);
-    display.setCursor(x, y);
-    display.print(HelloArduino);
-  }
-  while (display.nextPage());
+  // 刷新窗口由脏矩形跟踪从实际绘制的字形求出，不再整行刷新
+  TextAt t = { int16_t(x), int16_t(y), HelloArduino };
+  display.updateDirty(drawTextAt, &t);
   delay(1000);
 }
 
@@ -607,23 +689,14 @@ void helloEpaper()
   display.setTextColor(display.epd2.hasColor ? GxEPD_RED : GxEPD_BLACK);
   int16_t tbx, tby; uint16_t tbw, tbh;
   // 与居中的HelloWorld对齐
-  display.getTextBounds(HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, HelloWorld, 0, 0, &tbx, &tby, &tbw, &tbh, true);
   uint16_t x = ((display.width() - tbw) / 2) - tbx;
   // 高度可能不同
-  display.getTextBounds(HelloEpaper, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, HelloEpaper, 0, 0, &tbx, &tby, &tbw, &tbh, true);
   uint16_t y = (display.height() * 3 / 4) + tbh / 2; // y是基线！
-  // 使窗口足够大以覆盖（覆盖）先前文本的下行部分
-  uint16_t wh = FreeMonoBold9pt7b.yAdvance;
-  uint16_t wy = (display.height() * 3 / 4) - wh / 2;
-  display.setPartialWindow(0, wy, display.width(), wh);
-  display.firstPage();
-  do
-  {
-    display.fillScreen(GxEPD_WHITE);
-    display.setCursor(x, y);
-    display.print(HelloEpaper);
-  }
-  while (display.nextPage());
+  // 刷新窗口由脏矩形跟踪从实际绘制的字形求出，不再整行刷新
+  TextAt t = { int16_t(x), int16_t(y), HelloEpaper };
+  display.updateDirty(drawTextAt, &t);
 }
 
 void deepSleepTest()
@@ -637,7 +710,7 @@ void deepSleepTest()
   display.setTextColor(GxEPD_BLACK);
   int16_t tbx, tby; uint16_t tbw, tbh;
   // 居中文本
-  display.getTextBounds(hibernating, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, hibernating, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t x = ((display.width() - tbw) / 2) - tbx;
   uint16_t y = ((display.height() - tbh) / 2) - tby;
   display.setFullWindow();
@@ -651,10 +724,10 @@ void deepSleepTest()
   while (display.nextPage());
   display.hibernate();
   delay(5000);
-  display.getTextBounds(wokeup, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, wokeup, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t wx = (display.width() - tbw) / 2;
   uint16_t wy = (display.height() / 3) + tbh / 2; // y是基线！
-  display.getTextBounds(from, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, from, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t fx = (display.width() - tbw) / 2;
   uint16_t fy = (display.height() * 2 / 3) + tbh / 2; // y是基线！
   display.firstPage();
@@ -668,10 +741,10 @@ void deepSleepTest()
   }
   while (display.nextPage());
   delay(5000);
-  display.getTextBounds(hibernating, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, hibernating, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t hx = (display.width() - tbw) / 2;
   uint16_t hy = (display.height() / 3) + tbh / 2; // y是基线！
-  display.getTextBounds(again, 0, 0, &tbx, &tby, &tbw, &tbh);
+  textMetrics.textBounds(display, again, 0, 0, &tbx, &tby, &tbw, &tbh);
   uint16_t ax = (display.width() - tbw) / 2;
   uint16_t ay = (display.height() * 2 / 3) + tbh / 2; // y是基线！
   display.firstPage();
@@ -692,12 +765,11 @@ void showBox(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool partial)
   display.setRotation(1);
   if (partial)
   {
-    display.setPartialWindow(x, y, w, h);
-  }
-  else
-  {
-    display.setFullWindow();
+    BoxFill box = { int16_t(x), int16_t(y), int16_t(w), int16_t(h), GxEPD_BLACK, -1, 0 };
+    display.updateDirty(drawBoxFill, &box);
+    return;
   }
+  display.setFullWindow();
   display.firstPage();
   do
   {
@@ -788,48 +860,31 @@ void showPartialUpdate()
   for (uint16_t r = 0; r < 4; r++)
   {
     display.setRotation(r);
-    display.setPartialWindow(box_x, box_y, box_w, box_h);
-    display.firstPage();
-    do
-    {
-      display.fillRect(box_x, box_y, box_w, box_h, GxEPD_BLACK);
-    }
-    while (display.nextPage());
+    BoxFill box = { int16_t(box_x), int16_t(box_y), int16_t(box_w), int16_t(box_h), GxEPD_BLACK, -1, 0 };
+    display.updateDirty(drawBoxFill, &box);
     delay(2000);
-    display.firstPage();
-    do
-    {
-      display.fillRect(box_x, box_y, box_w, box_h, GxEPD_WHITE);
-    }
-    while (display.nextPage());
+    box.color = GxEPD_WHITE;
+    display.updateDirty(drawBoxFill, &box);
     delay(1000);
   }
-  // 在更新框中显示更新内容
+  // 在更新框中显示更新内容（数值更新用快速波形）
+  display.epd2.setLutProfile(EPD_LUT_FAST);
   for (uint16_t r = 0; r < 4; r++)
   {
     display.setRotation(r);
-    display.setPartialWindow(box_x, box_y, box_w, box_h);
+    BoxFill box = { int16_t(box_x), int16_t(box_y), int16_t(box_w), int16_t(box_h), GxEPD_WHITE, int16_t(cursor_y), 0 };
     for (uint16_t i = 1; i <= 10; i += incr)
     {
-      display.firstPage();
-      do
-      {
-        display.fillRect(box_x, box_y, box_w, box_h, GxEPD_WHITE);
-        display.setCursor(box_x, cursor_y);
-        display.print(value * i, 2);
-      }
-      while (display.nextPage());
+      box.value = value * i;
+      display.updateDirty(drawBoxFill, &box);
       delay(500);
     }
     delay(1000);
-    display.firstPage();
-    do
-    {
-      display.fillRect(box_x, box_y, box_w, box_h, GxEPD_WHITE);
-    }
-    while (display.nextPage());
+    box.cursor_y = -1;
+    display.updateDirty(drawBoxFill, &box);
     delay(1000);
   }
+  display.epd2.setLutProfile(EPD_LUT_STANDARD);
 }
 
 
@@ -840,3 +895,188 @@ void drawBitmaps()
   drawBitmaps128x296();
 #endif
 }
+
+// 刷新率测试方块：pv指向迭代序号，偶数次填黑、奇数次填白
+void drawRefreshTestBox(const void* pv)
+{
+  int i = *(const int*)pv;
+  display.fillScreen(GxEPD_WHITE);
+  display.fillRect(REFRESH_X, REFRESH_Y, REFRESH_W, REFRESH_H, i % 2 == 0 ? GxEPD_BLACK : GxEPD_WHITE);
+}
+
+// 在指定基线位置打印文本（字体与颜色沿用display当前设置）
+void drawTextAt(const void* pv)
+{
+  const TextAt* t = (const TextAt*)pv;
+  display.fillScreen(GxEPD_WHITE);
+  display.setCursor(t->x, t->y);
+  display.print(t->text);
+}
+
+// 填充方块，可选在方块内打印数值
+void drawBoxFill(const void* pv)
+{
+  const BoxFill* b = (const BoxFill*)pv;
+  display.fillScreen(GxEPD_WHITE);
+  display.fillRect(b->x, b->y, b->w, b->h, b->color);
+  if (b->cursor_y >= 0)
+  {
+    display.setCursor(b->x, b->cursor_y);
+    display.print(b->value, 2);
+  }
+}
+
+#if defined(EPD_MULTI_PANEL) && defined(ESP32) && defined(USE_HSPI_FOR_EPD)
+// 多面板测试页：面板序号与随轮次移动的方块
+struct PanelPage
+{
+  uint8_t index;
+  uint8_t round;
+};
+
+void drawPanelPage(EpdDisplay& gfx, const void* pv)
+{
+  const PanelPage* p = (const PanelPage*)pv;
+  gfx.fillScreen(GxEPD_WHITE);
+  gfx.setFont(&FreeMonoBold9pt7b);
+  gfx.setTextColor(GxEPD_BLACK);
+  gfx.setCursor(10, 30);
+  gfx.printf("panel %u", p->index + 1);
+  gfx.fillRect(16 + p->round * 24, 56, 16, 16, GxEPD_BLACK);
+}
+
+// 两块面板依次更新与并行更新（一块刷新时向另一块传输）的耗时对比
+void multiPanelTest()
+{
+  // 共用总线时不用DMA传输，HSPI交回SPIClass
+  display.epd2.setTransport(0);
+  epdTransport.end();
+  SPISettings settings(EPD_SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0);
+  panel2.epd2.selectSPI(hspi, settings);
+  panel2.init();
+  panel2.setRotation(1);
+  panel2.epd2.setDeltaTransfer(true);
+
+  EpdPanelSet panels(hspi, settings);
+  panels.add(display);                // 已初始化，沿用原来的BUSY等待
+  panels.add(panel2, &panel2Busy);
+  if (!panels.begin(false))
+  {
+    Serial.println("多面板：任务创建失败");
+    return;
+  }
+  PanelPage pages[2] = { { 0, 0 }, { 1, 0 } };
+  // 第一轮全刷（第二块面板的首次刷新总是全刷）
+  for (uint8_t i = 0; i < 2; i++) panels.draw(i, drawPanelPage, &pages[i], false);
+  panels.wait();
+  Serial.printf("多面板：全刷%luμs（刷新合计%luμs）\n", (unsigned long)panels.lastMicros(), (unsigned long)panels.lastRefreshMicros());
+
+  // 依次局部刷新：后一块面板等前一块刷新完才开始
+  uint32_t sequential = 0;
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    pages[i].round = 1;
+    panels.draw(i, drawPanelPage, &pages[i]);
+    panels.wait();
+    sequential += panels.lastMicros();
+  }
+  // 并行局部刷新：第一块刷新期间向第二块传输
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    pages[i].round = 2;
+    panels.draw(i, drawPanelPage, &pages[i]);
+  }
+  panels.wait();
+  Serial.printf("多面板：依次更新%luμs，并行更新%luμs（刷新合计%luμs）\n", (unsigned long)sequential,
+                (unsigned long)panels.lastMicros(), (unsigned long)panels.lastRefreshMicros());
+  panels.powerOff();
+  panels.end();
+
+  if (epdTransport.begin(hspi, 14, 13, /*CS=*/ 15, /*DC=*/ 27, EPD_SPI_CLOCK_HZ)) display.epd2.setTransport(&epdTransport);
+}
+#endif
+
+#if defined(EPD_DEEP_SLEEP_DEMO) && defined(ESP32)
+void drawWakePage(const void* pv)
+{
+  display.fillScreen(GxEPD_WHITE);
+  display.setFont(&FreeMonoBold9pt7b);
+  display.setTextColor(GxEPD_BLACK);
+  display.setCursor(10, 30);
+  display.print("deep sleep demo");
+  display.setCursor(10, 70);
+  display.printf("wake %lu", (unsigned long)wakeCount);
+}
+
+// 冷启动时updateDirty()的刷新由原驱动改为全刷；唤醒后恢复影子副本与跟踪区域，只刷新计数所在的窗口
+void deepSleepCycle(bool warm)
+{
+  if (warm) warm = display.restore(retainedFrame);
+  wakeCount = warm ? wakeCount + 1 : 0;
+  uint32_t t0 = micros();
+  display.epd2.resetTransferStats();
+  display.updateDirty(drawWakePage);
+  Serial.printf("唤醒%lu：%s，发送%lu行，跳过%lu行，%luμs\n", (unsigned long)wakeCount, warm ? "差分局部刷新" : "冷启动全刷",
+                (unsigned long)display.epd2.rowsSent(), (unsigned long)display.epd2.rowsSkipped(), (unsigned long)(micros() - t0));
+  // 睡眠前就是空闲时间：重影超出预算在这里全刷（预算的累计值随retain()保存）
+  if (display.epd2.refreshIfGhosted()) Serial.println("重影超出预算，全刷");
+  if (!display.retain(retainedFrame)) epdRetainedClear(retainedFrame);
+  display.hibernate();
+  esp_sleep_enable_timer_wakeup(EPD_WAKE_INTERVAL_S * 1000000ull);
+  esp_deep_sleep_start();
+}
+#endif
+
+// 刷新率测试结果页（保留模式控件）：第一次整屏绘制，之后只刷新数值变化的控件
+static long resultCount, resultMin, resultMax;
+static float resultAvgFps, resultMaxFps;
+
+void showTestResults(long count, unsigned long minUs, unsigned long maxUs, float avgFps, float maxFps)
+{
+  const int16_t h = display.height();
+  static const TextStyle titleStyle = { chineseFont, chineseFont, 0, TEXT_ALIGN_CENTER, 0, 0, h };
+  static const TextStyle leftStyle = { chineseFont, chineseFont, 0, TEXT_ALIGN_LEFT, 0, 0, h };
+  // 数字和“FPS”用英文字体，“平均：”等汉字回退到中文字体
+  static const TextStyle fpsStyle = { englishFont, chineseFont, 0, TEXT_ALIGN_RIGHT, 0, 0, h };
+  static EpdScreen screen(display);
+  static EpdLabel title(display.width() / 2, 20, "刷新率测试结果", titleStyle);          // 标题（居中）
+  static EpdValue countValue(10, 50, "测试次数：%ld次", leftStyle);                       // 测试次数（左对齐）
+  static EpdValue minValue(10, 75, "最小耗时：%ldμs", leftStyle);                         // 最小耗时
+  static EpdValue maxValue(10, 100, "最大耗时：%ldμs", leftStyle);                        // 最大耗时
+  static EpdValue avgFpsValue(display.width() - 10, 75, "平均：%.2f FPS", fpsStyle);     // 平均刷新率（右对齐）
+  static EpdValue maxFpsValue(display.width() - 10, 100, "最大：%.2f FPS", fpsStyle);    // 最大刷新率（右对齐）
+  static bool built = false;
+
+  resultCount = count;
+  resultMin = (long)minUs;
+  resultMax = (long)maxUs;
+  resultAvgFps = avgFps;
+  resultMaxFps = maxFps;
+  if (!built)
+  {
+    countValue.bind(&resultCount);
+    minValue.bind(&resultMin);
+    maxValue.bind(&resultMax);
+    avgFpsValue.bind(&resultAvgFps);
+    maxFpsValue.bind(&resultMaxFps);
+    screen.add(title);
+    screen.add(countValue);
+    screen.add(minValue);
+    screen.add(maxValue);
+    screen.add(avgFpsValue);
+    screen.add(maxFpsValue);
+    // 核0渲染下一页的同时本核把上一页写入控制器
+    screen.present(true);
+    built = true;
+  }
+  else screen.update();
+  Serial.printf("结果页：重新排版%u个控件，绘制%u次\n", screen.lastLaidOut(), screen.lastDrawCalls());
+}
+
+// 显示自定义图片：压缩位图按8行一组解码后直接写入控制器RAM（全刷新），
+// 不需要整帧显示缓冲区，也省去先画进缓冲区再拷贝的一遍
+void drawMyImage()
+{
+  CompressedBitmapSource src = { rgb_cam_1758806792_png, { 0, 0, 0, 0 } };
+  display.streamFrame(compressedBitmapRowSource, &src, false);
+}
@@ -0,0 +1,279 @@
+// text_layout.cpp
+// 文本排版实现
+#include "text_layout.h"
+#include "glyph_cache.h"
+
+U8G2_FOR_ADAFRUIT_GFX u8g2gfx;
+
+// 可以在其前面断行的字符（汉字、假名、谚文；行首禁则：全角标点不放在行首）
+static bool breakBefore(uint16_t cp)
+{
+  if (cp < 0x2E80) return false;
+  if ((cp >= 0x3000) && (cp <= 0x303F)) return false; // CJK标点
+  if ((cp >= 0xFF00) && (cp <= 0xFFEF)) return false; // 全角符号
+  return true;
+}
+
+// 可以在其后面断行的字符（空格和全角字符）
+static bool breakAfter(uint16_t cp)
+{
+  return (cp == ' ') || (cp >= 0x2E80);
+}
+
+FontMetrics FontMetrics::fromU8g2(const uint8_t* font)
+{
+  // 使用字体包围盒：y_offset为包围盒底部相对基线的位置
+  u8g2gfx.setFont(font);
+  const u8g2_font_info_t& fi = u8g2gfx.u8g2.font_info;
+  FontMetrics m;
+  m.ascent = fi.max_char_height + fi.y_offset;
+  m.descent = fi.y_offset;
+  m.lineHeight = m.ascent - m.descent;
+  return m;
+}
+
+FontMetrics FontMetrics::fromGFXfont(const GFXfont* font, uint8_t size)
+{
+  FontMetrics m;
+  if (!font)
+  {
+    // 内置5x7字体：光标在字符左上角，没有基线
+    m.ascent = 0;
+    m.descent = -8 * size;
+    m.lineHeight = 8 * size;
+    return m;
+  }
+  int16_t top = 0, bottom = 0;
+  for (uint16_t c = font->first; c <= font->last; c++)
+  {
+    const GFXglyph& g = font->glyph[c - font->first];
+    if ((g.width == 0) || (g.height == 0)) continue;
+    if (g.yOffset < top) top = g.yOffset;
+    if (g.yOffset + g.height > bottom) bottom = g.yOffset + g.height;
+  }
+  m.ascent = -top * size;
+  m.descent = -bottom * size;
+  m.lineHeight = font->yAdvance * size;
+  return m;
+}
+
+int16_t TextLayout::_advance(const uint8_t* font, uint16_t cp, const char* utf8, uint8_t len)
+{
+  if (glyphCache.supportsFont(font)) return glyphCache.advance(font, cp);
+  // 字体单元格太大，不走字形缓存：单独测量这个字符
+  char one[5];
+  memcpy(one, utf8, len);
+  one[len] = 0;
+  u8g2gfx.setFont(font);
+  return u8g2gfx.getUTF8Width(one);
+}
+
+TextLayout::TextLayout() :
+  _gfx_font(0), _run_count(0), _lines(0), _truncated(false),
+  _box_x(0), _box_y(0), _box_w(0), _box_h(0)
+{
+  _text[0] = 0;
+}
+
+TextLayout::TextLayout(int16_t x, int16_t y, const char* text, const TextStyle& style) :
+  _gfx_font(style.gfxFont), _run_count(0), _lines(0), _truncated(false),
+  _box_x(x), _box_y(y), _box_w(0), _box_h(0)
+{
+  // 1. 字体度量：中英文字体混排时取两者的并集
+  const uint8_t* latin = style.latinFont ? style.latinFont : style.cjkFont;
+  const uint8_t* cjk = style.cjkFont ? style.cjkFont : style.latinFont;
+  FontMetrics m;
+  if (_gfx_font)
+  {
+    m = FontMetrics::fromGFXfont(_gfx_font);
+  }
+  else
+  {
+    m = FontMetrics::fromU8g2(latin);
+    if (cjk != latin)
+    {
+      FontMetrics mc = FontMetrics::fromU8g2(cjk);
+      if (mc.ascent > m.ascent) m.ascent = mc.ascent;
+      if (mc.descent < m.descent) m.descent = mc.descent;
+    }
+    m.lineHeight = m.ascent - m.descent;
+  }
+  int16_t line_height = m.lineHeight + style.lineGap;
+
+  // 2. 解码并测量每个字符
+  Item items[TEXT_LAYOUT_MAX_GLYPHS];
+  uint8_t n = 0;
+  const char* p = text;
+  while (*p && (n < TEXT_LAYOUT_MAX_GLYPHS))
+  {
+    const char* start = p;
+    Item& it = items[n++];
+    it.cp = GlyphCache::nextCodepoint(p);
+    it.offset = start - text;
+    it.len = p - start;
+    if (it.cp == '\n')
+    {
+      it.font = 0;
+      it.advance = 0;
+    }
+    else if (_gfx_font)
+    {
+      it.font = 0;
+      bool in_font = (it.cp >= _gfx_font->first) && (it.cp <= _gfx_font->last);
+      it.advance = in_font ? _gfx_font->glyph[it.cp - _gfx_font->first].xAdvance : 0;
+    }
+    else
+    {
+      it.font = it.cp < 0x80 ? latin : cjk;
+      it.advance = _advance(it.font, it.cp, start, it.len);
+    }
+  }
+  if (*p) _truncated = true;
+
+  // 3. 断行：'\n'强制换行；超过maxWidth时在最近的断点（空格后、汉字前后）换行
+  uint8_t line_begin[TEXT_LAYOUT_MAX_GLYPHS], line_end[TEXT_LAYOUT_MAX_GLYPHS];
+  int16_t line_width[TEXT_LAYOUT_MAX_GLYPHS];
+  uint8_t i = 0;
+  while (i < n)
+  {
+    uint8_t begin = i, end = n, next = n, brk = 0xFF;
+    int16_t w = 0;
+    bool soft = false;
+    for (; i < n; i++)
+    {
+      const Item& it = items[i];
+      if (it.cp == '\n')
+      {
+        end = i;
+        next = i + 1;
+        break;
+      }
+      if ((style.maxWidth > 0) && (i > begin) && (w + it.advance > style.maxWidth))
+      {
+        end = next = ((brk != 0xFF) && (brk > begin)) ? brk : i;
+        soft = true;
+        break;
+      }
+      if (breakBefore(it.cp) && (i > begin)) brk = i;
+      w += it.advance;
+      if (breakAfter(it.cp)) brk = i + 1;
+    }
+    // 行尾空格不计入宽度
+    while ((end > begin) && (items[end - 1].cp == ' ')) end--;
+    w = 0;
+    for (uint8_t k = begin; k < end; k++) w += items[k].advance;
+    line_begin[_lines] = begin;
+    line_end[_lines] = end;
+    line_width[_lines] = w;
+    _lines++;
+    i = next;
+    // 自动换行后下一行行首的空格丢弃
+    if (soft) while ((i < n) && (items[i].cp == ' ')) i++;
+  }
+  if (_lines == 0) return;
+
+  // 4. 外接矩形与上下边界约束（整体平移，保证完全显示在屏幕内）
+  _box_w = 0;
+  for (uint8_t l = 0; l < _lines; l++) if (line_width[l] > _box_w) _box_w = line_width[l];
+  _box_x = x - (style.align == TEXT_ALIGN_CENTER ? _box_w / 2 : style.align == TEXT_ALIGN_RIGHT ? _box_w : 0);
+  _box_h = (_lines - 1) * line_height + m.ascent - m.descent;
+  int16_t baseline = y;
+  if (style.clampHeight > 0)
+  {
+    if (baseline - m.ascent < 0)
+    {
+      baseline = m.ascent;
+    }
+    else if (baseline - m.ascent + _box_h > style.clampHeight)
+    {
+      baseline = style.clampHeight - _box_h + m.ascent;
+      if (baseline - m.ascent < 0) baseline = m.ascent; // 比屏幕还高时保证首行可见
+    }
+  }
+  _box_y = baseline - m.ascent;
+
+  // 5. 每行按字体切分为段，段文本复制到_text（以'\0'分隔），绘制时无需再测量
+  uint16_t used = 0;
+  for (uint8_t l = 0; l < _lines; l++)
+  {
+    int16_t pen_x = x;
+    if (style.align == TEXT_ALIGN_CENTER) pen_x -= line_width[l] / 2;
+    else if (style.align == TEXT_ALIGN_RIGHT) pen_x -= line_width[l];
+    int16_t pen_y = baseline + l * line_height;
+    uint8_t k = line_begin[l];
+    while (k < line_end[l])
+    {
+      const uint8_t* font = items[k].font;
+      uint8_t e = k;
+      uint16_t bytes = 0;
+      int16_t w = 0;
+      while ((e < line_end[l]) && (items[e].font == font))
+      {
+        bytes += items[e].len;
+        w += items[e].advance;
+        e++;
+      }
+      if ((_run_count >= TEXT_LAYOUT_MAX_RUNS) || (used + bytes + 1 > TEXT_LAYOUT_MAX_BYTES))
+      {
+        _truncated = true;
+        return;
+      }
+      Run& r = _runs[_run_count++];
+      r.font = font;
+      r.x = pen_x;
+      r.y = pen_y;
+      r.offset = used;
+      memcpy(&_text[used], text + items[k].offset, bytes);
+      used += bytes;
+      _text[used++] = 0;
+      pen_x += w;
+      k = e;
+    }
+  }
+}
+
+void TextLayout::draw(EpdDisplay& gfx, uint16_t color) const
+{
+  // 记录模式（updateDirty()的第一遍）：只登记外接矩形，不解码字形
+  if (gfx.isRecording())
+  {
+    gfx.markDirty(_box_x, _box_y, _box_w, _box_h);
+    return;
+  }
+  // 分页绘制：整段文本在当前页之外时不绘制，部分相交时逐字形裁剪
+  const DirtyRect page = gfx.pageRect();
+  const DirtyRect box = { _box_x, _box_y, _box_w, _box_h };
+  if (!box.intersects(page)) return;
+  if (_gfx_font)
+  {
+    const GFXfont* saved_font = gfx.getFont();
+    bool saved_wrap = gfx.getTextWrap();
+    gfx.setFont(_gfx_font);
+    gfx.setTextColor(color);
+    gfx.setTextWrap(false); // 已经排好版，不让Adafruit_GFX再按屏幕宽度换行
+    for (uint8_t i = 0; i < _run_count; i++)
+    {
+      gfx.setCursor(_runs[i].x, _runs[i].y);
+      gfx.print(&_text[_runs[i].offset]);
+    }
+    gfx.setFont(saved_font);
+    gfx.setTextWrap(saved_wrap);
+    return;
+  }
+  for (uint8_t i = 0; i < _run_count; i++)
+  {
+    const Run& r = _runs[i];
+    // 字形从缓存按行段blit，只有首次出现的字形才需要U8g2解码
+    if (glyphCache.supportsFont(r.font))
+    {
+      glyphCache.drawUTF8(gfx, r.x, r.y, &_text[r.offset], r.font, color, &page);
+    }
+    else
+    {
+      u8g2gfx.setFont(r.font);
+      u8g2gfx.setFontMode(1);
+      u8g2gfx.setForegroundColor(color);
+      u8g2gfx.drawUTF8(r.x, r.y, &_text[r.offset]);
+    }
+  }
+}
@@ -0,0 +1,101 @@
+// text_layout.h
+// 文本排版：从字体读取真实的ascent/descent/advance（U8g2字体或Adafruit GFXfont），
+// 支持自动换行和中英文混排（ASCII用西文字体、其它字符用中文字体），
+// 排版结果是不可变对象，在firstPage()/nextPage()循环外计算一次，循环内只负责绘制
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "U8g2_for_Adafruit_GFX.h"
+#include "epd_display.h"
+
+#ifndef TEXT_LAYOUT_MAX_BYTES
+#define TEXT_LAYOUT_MAX_BYTES 160   // 排版后文本（含每段结束符）的最大字节数
+#endif
+#ifndef TEXT_LAYOUT_MAX_RUNS
+#define TEXT_LAYOUT_MAX_RUNS 16     // 最大段数（同一行内字体相同的连续字符为一段）
+#endif
+#define TEXT_LAYOUT_MAX_GLYPHS 96   // 单个排版对象最多的字符数
+
+// 对齐方式（取值与旧版drawUniversalText()的alignment参数一致）
+enum TextAlign
+{
+  TEXT_ALIGN_LEFT = 0,
+  TEXT_ALIGN_CENTER = 1,
+  TEXT_ALIGN_RIGHT = 2
+};
+
+// 字体度量（基线为0，向上为正）
+struct FontMetrics
+{
+  int16_t ascent;     // 基线到最高字形顶部
+  int16_t descent;    // 基线到最低字形底部（负值）
+  int16_t lineHeight; // 行距
+
+  static FontMetrics fromU8g2(const uint8_t* font);
+  static FontMetrics fromGFXfont(const GFXfont* font, uint8_t size = 1);
+};
+
+// 排版样式
+struct TextStyle
+{
+  const uint8_t* latinFont;  // ASCII字符使用的U8g2字体（为0时使用cjkFont）
+  const uint8_t* cjkFont;    // 非ASCII字符使用的U8g2字体（为0时使用latinFont）
+  const GFXfont* gfxFont;    // 非0时整段使用Adafruit GFXfont（仅ASCII），忽略上面两个字体
+  uint8_t align;             // TextAlign
+  int16_t maxWidth;          // >0时超过此宽度自动换行
+  int16_t lineGap;           // 行间额外间距
+  int16_t clampHeight;       // >0时整体上下平移以完全落在[0, clampHeight)内
+};
+
+class TextLayout
+{
+  public:
+    // (x, y)：对齐基准点x与第一行基线y
+    TextLayout(int16_t x, int16_t y, const char* text, const TextStyle& style);
+    // 空排版：不绘制任何内容（保留模式控件在排版前持有）
+    TextLayout();
+
+    // 绘制（透明背景）。记录模式下（updateDirty()第一遍）只登记外接矩形
+    void draw(EpdDisplay& gfx, uint16_t color) const;
+
+    // 外接矩形（逻辑坐标）
+    int16_t x() const { return _box_x; }
+    int16_t y() const { return _box_y; }
+    int16_t width() const { return _box_w; }
+    int16_t height() const { return _box_h; }
+    uint8_t lines() const { return _lines; }
+    bool truncated() const { return _truncated; }
+
+  private:
+    struct Run
+    {
+      const uint8_t* font;   // U8g2字体（gfxFont非0时不用）
+      int16_t x, y;          // 基线起点
+      uint16_t offset;       // 在_text中的偏移（以'\0'结尾）
+    };
+    struct Item
+    {
+      uint16_t offset;       // 在原文本中的字节偏移
+      uint8_t len;           // UTF-8字节数
+      uint16_t cp;
+      const uint8_t* font;
+      int16_t advance;
+    };
+
+    static int16_t _advance(const uint8_t* font, uint16_t cp, const char* utf8, uint8_t len);
+
+  private:
+    const GFXfont* _gfx_font;
+    Run _runs[TEXT_LAYOUT_MAX_RUNS];
+    uint8_t _run_count;
+    uint8_t _lines;
+    bool _truncated;
+    char _text[TEXT_LAYOUT_MAX_BYTES];
+    int16_t _box_x, _box_y, _box_w, _box_h;
+};
+
+extern U8G2_FOR_ADAFRUIT_GFX u8g2gfx;
+
+#endif
@@ -0,0 +1,91 @@
+// text_metrics.cpp
+// 文本测量缓存实现
+#include "text_metrics.h"
+
+TextMetricsCache textMetrics;
+
+// Adafruit_GFX内置5x7字体没有GFXfont指针，用此地址作为它的键
+static const uint8_t classicFontKey = 0;
+
+TextMetricsCache::TextMetricsCache() : _hits(0), _misses(0)
+{
+  clear();
+}
+
+void TextMetricsCache::clear()
+{
+  memset(_entries, 0, sizeof(_entries));
+}
+
+TextMetricsCache::Entry* TextMetricsCache::_find(const void* font, uint16_t kind, const char* text, bool constant, bool& hit)
+{
+  uint32_t hash;
+  uint16_t len = 0;
+  if (constant)
+  {
+    hash = uint32_t(uintptr_t(text)) * 2654435761u;
+  }
+  else
+  {
+    // FNV-1a，同时得到长度
+    hash = 2166136261u;
+    for (const char* p = text; *p; p++, len++)
+    {
+      if (len >= TEXT_METRICS_MAX_LEN) return 0;
+      hash = (hash ^ uint8_t(*p)) * 16777619u;
+    }
+  }
+  uint32_t slot_hash = hash ^ uint32_t(uintptr_t(font)) ^ kind;
+  Entry* e = &_entries[(slot_hash ^ (slot_hash >> 16)) & (TEXT_METRICS_SLOTS - 1)];
+  hit = (e->font == font) && (e->kind == kind) && (e->hash == hash) &&
+        (constant ? (e->ptr == text) : ((e->ptr == 0) && (e->len == len) && !memcmp(e->text, text, len)));
+  if (hit)
+  {
+    _hits++;
+  }
+  else
+  {
+    _misses++;
+    e->font = font;
+    e->kind = kind;
+    e->hash = hash;
+    e->len = len;
+    e->ptr = constant ? text : 0;
+    if (!constant) memcpy(e->text, text, len);
+  }
+  return e;
+}
+
+void TextMetricsCache::textBounds(EpdDisplay& gfx, const char* text, int16_t x, int16_t y,
+                                  int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, bool constant)
+{
+  // 多行文本换行后x回到0而不是原点x，结果与原点相关，不缓存
+  if (strchr(text, '\n'))
+  {
+    gfx.getTextBounds(text, x, y, x1, y1, w, h);
+    return;
+  }
+  const void* font = gfx.getFont() ? (const void*)gfx.getFont() : (const void*)&classicFontKey;
+  uint16_t kind = (uint16_t(gfx.getTextSizeX()) << 8) | gfx.getTextSizeY();
+  bool hit;
+  Entry* e = _find(font, kind, text, constant, hit);
+  if (!e)
+  {
+    gfx.getTextBounds(text, x, y, x1, y1, w, h);
+    return;
+  }
+  if (!hit)
+  {
+    gfx.getTextBounds(text, 0, 0, &e->x1, &e->y1, &e->w, &e->h);
+  }
+  // 以(0, 0)测得的边界平移到(x, y)；若平移后会触发自动换行，结果不再是平移关系，改为实际测量
+  if (gfx.getTextWrap() && (x + e->x1 + int16_t(e->w) > gfx.width()))
+  {
+    gfx.getTextBounds(text, x, y, x1, y1, w, h);
+    return;
+  }
+  *x1 = e->x1 + x;
+  *y1 = e->y1 + y;
+  *w = e->w;
+  *h = e->h;
+}
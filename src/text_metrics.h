@@ -0,0 +1,55 @@
+// text_metrics.h
+// 文本测量缓存：居中/右对齐每次绘制都要测量一遍宽度（等于把每个字形再遍历一次），
+// 这里按“字体 + 字符串内容”（或常量字符串的指针）缓存测量结果，重复测量不再遍历字形
+#ifndef TEXT_METRICS_H
+#define TEXT_METRICS_H
+
+#include <Arduino.h>
+#include "epd_display.h"
+
+#ifndef TEXT_METRICS_SLOTS
+#define TEXT_METRICS_SLOTS 32   // 直接映射表大小（2的幂）
+#endif
+#ifndef TEXT_METRICS_MAX_LEN
+#define TEXT_METRICS_MAX_LEN 24 // 按内容缓存的最长字符串（字节），每槽保存一份副本用于比较，更长的直接测量
+#endif
+
+class TextMetricsCache
+{
+  public:
+    TextMetricsCache();
+
+    // 与Adafruit_GFX::getTextBounds()结果相同，使用display当前的GFXfont和文字放大倍数；
+    // constant=true表示text是全局常量（如PROGMEM字符串），直接以指针为键，连哈希都不用算
+    // （U8g2文本的宽度在TextLayout排版时逐字形得到，排版结果在分页循环外只算一次，不经过这里）
+    void textBounds(EpdDisplay& gfx, const char* text, int16_t x, int16_t y,
+                    int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, bool constant = false);
+
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    void clear();
+
+  private:
+    struct Entry
+    {
+      const void* font;   // GFXfont指针（0表示空槽）
+      const char* ptr;    // 常量字符串指针（按内容缓存时为0）
+      uint32_t hash;      // 内容哈希（FNV-1a），只用于选槽和快速排除
+      uint16_t len;
+      uint16_t kind;      // 高字节/低字节为x/y放大倍数
+      int16_t x1, y1;     // 以(0, 0)为原点的边界
+      uint16_t w, h;
+      char text[TEXT_METRICS_MAX_LEN];   // 按内容缓存时的字符串副本（命中要求逐字节相同）
+    };
+
+    // 字符串超过TEXT_METRICS_MAX_LEN、不缓存时返回0
+    Entry* _find(const void* font, uint16_t kind, const char* text, bool constant, bool& hit);
+
+  private:
+    Entry _entries[TEXT_METRICS_SLOTS];
+    uint32_t _hits, _misses;
+};
+
+extern TextMetricsCache textMetrics;
+
+#endif
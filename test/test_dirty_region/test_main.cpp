@@ -0,0 +1,120 @@
+// test_main.cpp
+// 脏矩形累加器（dirty_region.h）：外接矩形合并、单点快速路径与SSD1608字节对齐
+// pio test -e native -f test_dirty_region
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include "dirty_region.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+static void assertRect(int16_t x, int16_t y, int16_t w, int16_t h, const DirtyRect& r)
+{
+  TEST_ASSERT_EQUAL_INT16(x, r.x);
+  TEST_ASSERT_EQUAL_INT16(y, r.y);
+  TEST_ASSERT_EQUAL_INT16(w, r.w);
+  TEST_ASSERT_EQUAL_INT16(h, r.h);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_rects_are_ignored()
+{
+  DirtyRegion d;
+  TEST_ASSERT_TRUE(d.isEmpty());
+  d.add(10, 10, 0, 5);
+  d.add(10, 10, 5, -1);
+  TEST_ASSERT_TRUE(d.isEmpty());
+  d.add(10, 20, 4, 3);
+  d.add(0, 0, 0, 0);   // 空矩形不把原点并进来
+  assertRect(10, 20, 4, 3, d.bounds());
+}
+
+void test_add_merges_to_bounding_box()
+{
+  DirtyRegion d;
+  d.add(10, 20, 5, 5);
+  d.add(40, 8, 2, 2);
+  assertRect(10, 8, 32, 17, d.bounds());
+  d.add(12, 12, 3, 3);   // 已被包含，不变
+  assertRect(10, 8, 32, 17, d.bounds());
+  DirtyRect r = { -4, 30, 6, 1 };
+  d.add(r);
+  assertRect(-4, 8, 46, 23, d.bounds());
+}
+
+void test_add_pixel_extends_bounds()
+{
+  DirtyRegion d;
+  d.addPixel(5, 7);
+  assertRect(5, 7, 1, 1, d.bounds());
+  d.addPixel(5, 7);
+  assertRect(5, 7, 1, 1, d.bounds());
+  d.addPixel(9, 3);
+  assertRect(5, 3, 5, 5, d.bounds());
+  d.addPixel(2, 12);
+  assertRect(2, 3, 8, 10, d.bounds());
+  // 与add()的1x1矩形结果一致
+  DirtyRegion a;
+  a.add(5, 7, 1, 1);
+  a.add(9, 3, 1, 1);
+  a.add(2, 12, 1, 1);
+  assertRect(a.bounds().x, a.bounds().y, a.bounds().w, a.bounds().h, d.bounds());
+}
+
+void test_clear_resets()
+{
+  DirtyRegion d;
+  d.add(1, 2, 3, 4);
+  d.clear();
+  TEST_ASSERT_TRUE(d.isEmpty());
+  d.addPixel(100, 200);
+  assertRect(100, 200, 1, 1, d.bounds());
+}
+
+void test_intersects()
+{
+  DirtyRect a = { 10, 10, 10, 10 };
+  DirtyRect b = { 19, 19, 5, 5 };
+  DirtyRect c = { 20, 10, 5, 5 };   // 紧贴右边界，不相交
+  DirtyRect e = { 12, 12, 0, 5 };
+  TEST_ASSERT_TRUE(a.intersects(b));
+  TEST_ASSERT_TRUE(b.intersects(a));
+  TEST_ASSERT_FALSE(a.intersects(c));
+  TEST_ASSERT_FALSE(a.intersects(e));
+  TEST_ASSERT_FALSE(e.intersects(e));
+}
+
+void test_snap_to_byte_alignment()
+{
+  DirtyRect r = { 3, 10, 7, 4 };
+  assertRect(0, 10, 16, 4, DirtyRegion::snapToByteAlignment(r, 128, 296));
+  DirtyRect aligned = { 8, 0, 16, 296 };
+  assertRect(8, 0, 16, 296, DirtyRegion::snapToByteAlignment(aligned, 128, 296));
+}
+
+void test_snap_clips_to_panel()
+{
+  DirtyRect r = { -5, -3, 20, 10 };
+  assertRect(0, 0, 16, 7, DirtyRegion::snapToByteAlignment(r, 128, 296));
+  DirtyRect edge = { 121, 290, 20, 20 };
+  assertRect(120, 290, 8, 6, DirtyRegion::snapToByteAlignment(edge, 128, 296));
+  DirtyRect outside = { 200, 300, 10, 10 };
+  TEST_ASSERT_TRUE(DirtyRegion::snapToByteAlignment(outside, 128, 296).isEmpty());
+}
+
+void setup()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_rects_are_ignored);
+  RUN_TEST(test_add_merges_to_bounding_box);
+  RUN_TEST(test_add_pixel_extends_bounds);
+  RUN_TEST(test_clear_resets);
+  RUN_TEST(test_intersects);
+  RUN_TEST(test_snap_to_byte_alignment);
+  RUN_TEST(test_snap_clips_to_panel);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,102 @@
+// test_main.cpp
+// 驱动刷新的记账：GxEPD2_290_Ext::refresh(true)（流水线绘制与流式整帧使用）与refresh(x, y, w, h)
+// 对SSD1608模型只刷新一次，残影权重只计一次，非标准波形只装入一次、刷新时间只记一次
+// pio test -e native -f test_driver_refresh
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include "epd_ghost.h"
+#include "epd_lut.h"
+#include "ssd1608_model.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+static EpdGhostTracker ghost;
+
+static SimPanel* panel()
+{
+  return SimPanel::at(0);
+}
+
+// 一次整屏局部刷新的残影得分（与驱动相同的按帧数折算）
+static uint16_t expectedWorst(EpdLutProfile profile)
+{
+  EpdGhostTracker ref;
+  ref.setBudget(ghost.budget());
+  uint8_t frames = epdLutInfo(profile).frames;
+  uint8_t std_frames = epdLutInfo(EPD_LUT_STANDARD).frames;
+  ref.partialRefresh(0, 0, GxEPD2_290::WIDTH, GxEPD2_290::HEIGHT,
+                     (EpdGhostTracker::WEIGHT_STANDARD * std_frames + frames / 2) / frames);
+  return ref.worst();
+}
+
+void setUp()
+{
+  display.epd2.setLutProfile(EPD_LUT_STANDARD);
+  display.epd2.refresh(false);   // 残影计数清零
+  display.epd2.refresh(true);    // 进入局部模式，之后的局部刷新可以装入其它波形
+  ghost.fullRefresh();
+}
+
+void tearDown() {}
+
+void test_partial_refresh_counts_once()
+{
+  display.epd2.setLutProfile(EPD_LUT_FAST);
+  uint32_t partials = panel()->partialRefreshes();
+  uint32_t fulls = panel()->fullRefreshes();
+  display.epd2.refresh(true);
+  TEST_ASSERT_EQUAL_UINT32(partials + 1, panel()->partialRefreshes());
+  TEST_ASSERT_EQUAL_UINT32(fulls, panel()->fullRefreshes());
+  TEST_ASSERT_EQUAL_UINT16(expectedWorst(EPD_LUT_FAST), ghost.worst());
+}
+
+void test_partial_refresh_matches_window_refresh()
+{
+  display.epd2.refresh(true);
+  uint16_t whole = ghost.worst();
+  ghost.fullRefresh();
+  display.epd2.refresh(0, 0, GxEPD2_290::WIDTH, GxEPD2_290::HEIGHT);
+  TEST_ASSERT_EQUAL_UINT16(whole, ghost.worst());
+  TEST_ASSERT_EQUAL_UINT16(expectedWorst(EPD_LUT_STANDARD), whole);
+}
+
+void test_full_refresh_resets_ghost()
+{
+  display.epd2.refresh(true);
+  TEST_ASSERT_TRUE(ghost.worst() > 0);
+  uint32_t fulls = panel()->fullRefreshes();
+  display.epd2.refresh(false);
+  TEST_ASSERT_EQUAL_UINT32(fulls + 1, panel()->fullRefreshes());
+  TEST_ASSERT_EQUAL_UINT16(0, ghost.worst());
+}
+
+void test_lut_loaded_and_timed_once()
+{
+  // 这一档在前面的用例中没用过：平均值就是这一次的刷新时间
+  TEST_ASSERT_EQUAL_UINT32(0, display.epd2.lutRefreshMicros(EPD_LUT_TURBO));
+  display.epd2.setLutProfile(EPD_LUT_TURBO);
+  uint32_t luts = panel()->lutWrites();
+  uint32_t us = display.epd2.refreshMicros();
+  display.epd2.refresh(true);
+  us = display.epd2.refreshMicros() - us;
+  TEST_ASSERT_EQUAL_UINT32(luts + 1, panel()->lutWrites());
+  TEST_ASSERT_EQUAL_UINT32(us, display.epd2.lutRefreshMicros(EPD_LUT_TURBO));
+  display.epd2.refresh(true);
+  TEST_ASSERT_EQUAL_UINT32(luts + 2, panel()->lutWrites());
+}
+
+void setup()
+{
+  display.init(0);
+  display.setRotation(0);
+  display.epd2.setGhostTracker(&ghost);
+  UNITY_BEGIN();
+  RUN_TEST(test_partial_refresh_counts_once);
+  RUN_TEST(test_partial_refresh_matches_window_refresh);
+  RUN_TEST(test_full_refresh_resets_ghost);
+  RUN_TEST(test_lut_loaded_and_timed_once);
+  UNITY_END();
+}
+
+void loop() {}
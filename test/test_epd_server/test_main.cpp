@@ -0,0 +1,407 @@
+// test_main.cpp
+// 串口显示服务（epd_server.h）：CRC-16、行程编码的越界检查与帧协议的状态机
+// （应答、NAK的错误码、DEFER/REFRESH、重发去重、帧内超时、帧之外的文本行）
+// pio test -e native -f test_epd_server
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include "epd_server.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+// 主机一侧：feed()写入设备的接收端，设备的应答留在out中
+class FakePort : public Stream
+{
+  public:
+    void reset() { _in_len = _in_pos = 0; out_len = out_pos = 0; }
+    void feed(const uint8_t* p, uint16_t n)
+    {
+      TEST_ASSERT_TRUE(_in_len + n <= sizeof(_in));
+      memcpy(_in + _in_len, p, n);
+      _in_len += n;
+    }
+    bool drained() const { return _in_pos == _in_len; }
+
+    int available() override { return _in_len - _in_pos; }
+    int read() override { return _in_pos < _in_len ? _in[_in_pos++] : -1; }
+    int peek() override { return _in_pos < _in_len ? _in[_in_pos] : -1; }
+    size_t write(uint8_t c) override
+    {
+      if (out_len < sizeof(out)) out[out_len++] = c;
+      return 1;
+    }
+    using Print::write;
+
+    uint8_t out[256];
+    uint16_t out_len, out_pos;
+
+  private:
+    uint8_t _in[EPD_SERVER_FRAME_SIZE + 64];
+    uint16_t _in_len, _in_pos;
+};
+
+struct Reply
+{
+  uint8_t type;
+  uint8_t seq;
+  uint16_t len;
+  uint8_t payload[16];
+};
+
+static FakePort port;
+static EpdServer server(display);
+static uint8_t frame[EPD_SERVER_FRAME_SIZE + 16];
+
+static void sendFrame(uint8_t type, uint8_t seq, const uint8_t* payload, uint16_t len, bool corrupt = false)
+{
+  uint8_t head[5] = { EPD_SERVER_SYNC, type, seq, uint8_t(len & 0xFF), uint8_t(len >> 8) };
+  uint16_t crc = EpdServer::crc16(EpdServer::crc16(0xFFFF, head + 1, 4), payload, len);
+  if (corrupt) crc ^= 1;
+  uint8_t tail[2] = { uint8_t(crc & 0xFF), uint8_t(crc >> 8) };
+  port.feed(head, sizeof(head));
+  port.feed(payload, len);
+  port.feed(tail, sizeof(tail));
+}
+
+// 每次poll()最多处理一帧
+static void pollAll()
+{
+  for (uint8_t i = 0; (i < 16) && !port.drained(); i++) server.poll();
+  TEST_ASSERT_TRUE(port.drained());
+}
+
+// 取出下一个应答并检查校验和；没有更多应答时返回false
+static bool nextReply(Reply& r)
+{
+  while ((port.out_pos < port.out_len) && (port.out[port.out_pos] != EPD_SERVER_SYNC)) port.out_pos++;
+  if (port.out_len - port.out_pos < 7) return false;
+  const uint8_t* p = port.out + port.out_pos;
+  r.type = p[1];
+  r.seq = p[2];
+  r.len = p[3] | (p[4] << 8);
+  TEST_ASSERT_TRUE(r.len <= sizeof(r.payload));
+  TEST_ASSERT_TRUE(port.out_pos + 7 + r.len <= port.out_len);
+  memcpy(r.payload, p + 5, r.len);
+  uint16_t crc = EpdServer::crc16(0xFFFF, p + 1, 4 + r.len);
+  TEST_ASSERT_EQUAL_HEX16(crc, p[5 + r.len] | (p[6 + r.len] << 8));
+  port.out_pos += 7 + r.len;
+  return true;
+}
+
+static void expectReply(uint8_t type, uint8_t seq)
+{
+  Reply r;
+  TEST_ASSERT_TRUE_MESSAGE(nextReply(r), "no reply");
+  TEST_ASSERT_EQUAL_HEX8(type, r.type);
+  TEST_ASSERT_EQUAL_UINT8(seq, r.seq);
+  if (type == EPD_SERVER_ACK)
+  {
+    TEST_ASSERT_EQUAL_UINT16(1, r.len);
+    TEST_ASSERT_EQUAL_UINT8(0, r.payload[0]);
+  }
+}
+
+static void expectNak(uint8_t seq, uint8_t status)
+{
+  Reply r;
+  TEST_ASSERT_TRUE_MESSAGE(nextReply(r), "no reply");
+  TEST_ASSERT_EQUAL_HEX8(EPD_SERVER_NAK, r.type);
+  TEST_ASSERT_EQUAL_UINT8(seq, r.seq);
+  TEST_ASSERT_EQUAL_UINT16(1, r.len);
+  TEST_ASSERT_EQUAL_UINT8(status, r.payload[0]);
+}
+
+static void expectNoReply()
+{
+  Reply r;
+  TEST_ASSERT_FALSE(nextReply(r));
+}
+
+// RECT负载：flags + x y w h + 图像
+static uint16_t rectPayload(uint8_t flags, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* data, uint16_t len)
+{
+  uint16_t v[4] = { x, y, w, h };
+  frame[0] = flags;
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    frame[1 + 2 * i] = v[i] & 0xFF;
+    frame[2 + 2 * i] = v[i] >> 8;
+  }
+  memcpy(frame + 9, data, len);
+  return 9 + len;
+}
+
+static uint32_t fnv1a(const uint8_t* p, uint16_t n)
+{
+  uint32_t h = 2166136261ul;
+  while (n--) h = (h ^ *p++) * 16777619ul;
+  return h;
+}
+
+static char last_line[48];
+static uint8_t lines;
+
+static void onLine(const char* line, void* ctx)
+{
+  strncpy(last_line, line, sizeof(last_line) - 1);
+  lines++;
+}
+
+void setUp()
+{
+  port.reset();
+}
+
+void tearDown()
+{
+  // 每个用例结束时接收状态回到等待同步字节
+  delay(EPD_SERVER_BYTE_TIMEOUT_MS + 50);
+  server.poll();
+}
+
+void test_crc16_check_value()
+{
+  const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, EpdServer::crc16(0xFFFF, check, sizeof(check)));
+  // 分段累加与一次计算相同
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, EpdServer::crc16(EpdServer::crc16(0xFFFF, check, 4), check + 4, 5));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, EpdServer::crc16(0xFFFF, check, 0));
+}
+
+void test_unpacker_literal_and_repeat()
+{
+  const uint8_t data[] = { 0x02, 0x11, 0x22, 0x33, 0x81, 0x44 };   // 3个字面量 + 4个0x44
+  const uint8_t expect[] = { 0x11, 0x22, 0x33, 0x44, 0x44, 0x44, 0x44 };
+  uint8_t out[7];
+  ServerUnpacker u(data, sizeof(data));
+  TEST_ASSERT_TRUE(u.read(out, 2));
+  TEST_ASSERT_FALSE(u.done());
+  TEST_ASSERT_TRUE(u.read(out + 2, 5));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expect, out, sizeof(expect));
+  TEST_ASSERT_TRUE(u.done());
+  // 已经读完，再读越界
+  TEST_ASSERT_FALSE(u.read(out, 1));
+
+  // out为0时只检查
+  ServerUnpacker check(data, sizeof(data));
+  TEST_ASSERT_TRUE(check.read(0, 7));
+  TEST_ASSERT_TRUE(check.done());
+}
+
+void test_unpacker_bounds()
+{
+  uint8_t out[8];
+  const uint8_t short_literal[] = { 0x02, 0x11, 0x22 };
+  ServerUnpacker a(short_literal, sizeof(short_literal));
+  TEST_ASSERT_FALSE(a.read(out, 3));
+
+  const uint8_t no_value[] = { 0x81 };
+  ServerUnpacker b(no_value, sizeof(no_value));
+  TEST_ASSERT_FALSE(b.read(out, 4));
+
+  ServerUnpacker c(no_value, 0);
+  TEST_ASSERT_FALSE(c.read(out, 1));
+  TEST_ASSERT_TRUE(c.done());
+
+  // 多余的字节
+  const uint8_t trailing[] = { 0x80, 0x55, 0x00 };
+  ServerUnpacker d(trailing, sizeof(trailing));
+  TEST_ASSERT_TRUE(d.read(out, 3));
+  TEST_ASSERT_FALSE(d.done());
+
+  // 重复段没有用完
+  ServerUnpacker e(trailing, 2);
+  TEST_ASSERT_TRUE(e.read(out, 2));
+  TEST_ASSERT_FALSE(e.done());
+}
+
+void test_hello_returns_info()
+{
+  sendFrame(EPD_SERVER_HELLO, 7, 0, 0);
+  pollAll();
+  Reply r;
+  TEST_ASSERT_TRUE(nextReply(r));
+  TEST_ASSERT_EQUAL_HEX8(EPD_SERVER_INFO, r.type);
+  TEST_ASSERT_EQUAL_UINT8(7, r.seq);
+  TEST_ASSERT_EQUAL_UINT16(14, r.len);
+  TEST_ASSERT_EQUAL_UINT8(EPD_SERVER_VERSION, r.payload[0]);
+  TEST_ASSERT_EQUAL_UINT16(display.width(), r.payload[1] | (r.payload[2] << 8));
+  TEST_ASSERT_EQUAL_UINT16(display.height(), r.payload[3] | (r.payload[4] << 8));
+  TEST_ASSERT_EQUAL_UINT8(display.getRotation(), r.payload[5]);
+  TEST_ASSERT_EQUAL_UINT16(EPD_SERVER_MAX_PAYLOAD, r.payload[6] | (r.payload[7] << 8));
+  uint32_t hash = r.payload[10] | (r.payload[11] << 8) | (uint32_t(r.payload[12]) << 16) | (uint32_t(r.payload[13]) << 24);
+  TEST_ASSERT_EQUAL_HEX32(server.frameHash(), hash);
+  expectNoReply();
+}
+
+void test_bad_crc_is_nak()
+{
+  uint8_t flags = 0;
+  uint32_t errors = server.errors();
+  sendFrame(EPD_SERVER_REFRESH, 3, &flags, 1, true);
+  pollAll();
+  expectNak(3, EPD_SERVER_ERR_CRC);
+  expectNoReply();
+  TEST_ASSERT_EQUAL_UINT32(errors + 1, server.errors());
+}
+
+void test_oversized_length_is_nak()
+{
+  // 只发头，设备收完len就拒绝，不等负载
+  uint16_t len = EPD_SERVER_MAX_PAYLOAD + 1;
+  uint8_t head[5] = { EPD_SERVER_SYNC, EPD_SERVER_FRAME, 4, uint8_t(len & 0xFF), uint8_t(len >> 8) };
+  port.feed(head, sizeof(head));
+  pollAll();
+  expectNak(4, EPD_SERVER_ERR_TOO_BIG);
+  expectNoReply();
+}
+
+void test_unknown_type_is_nak()
+{
+  uint8_t flags = 0;
+  sendFrame(0x7E, 5, &flags, 1);
+  pollAll();
+  expectNak(5, EPD_SERVER_ERR_TYPE);
+}
+
+void test_rect_outside_screen_is_nak()
+{
+  uint8_t data[4] = { 0 };
+  uint16_t len = rectPayload(0, display.width() - 8, 0, 16, 2, data, sizeof(data));
+  sendFrame(EPD_SERVER_RECT, 6, frame, len);
+  pollAll();
+  expectNak(6, EPD_SERVER_ERR_RECT);
+
+  // 图像长度与尺寸不符
+  len = rectPayload(0, 0, 0, 16, 2, data, 3);
+  sendFrame(EPD_SERVER_RECT, 7, frame, len);
+  pollAll();
+  expectNak(7, EPD_SERVER_ERR_LENGTH);
+}
+
+void test_bad_compressed_data_leaves_frame()
+{
+  uint32_t hash = server.frameHash();
+  // 16x2的矩形要4个字节，编码只给出3个
+  const uint8_t short_data[] = { 0x80, 0xFF };
+  uint16_t len = rectPayload(EPD_SERVER_COMPRESSED, 0, 0, 16, 2, short_data, sizeof(short_data));
+  sendFrame(EPD_SERVER_RECT, 8, frame, len);
+  // 多余的字节
+  const uint8_t long_data[] = { 0x81, 0xFF, 0x00, 0x12 };
+  len = rectPayload(EPD_SERVER_COMPRESSED, 0, 0, 16, 2, long_data, sizeof(long_data));
+  sendFrame(EPD_SERVER_RECT, 9, frame, len);
+  pollAll();
+  expectNak(8, EPD_SERVER_ERR_DATA);
+  expectNak(9, EPD_SERVER_ERR_DATA);
+  TEST_ASSERT_EQUAL_HEX32(hash, server.frameHash());
+}
+
+void test_frame_acks_then_done()
+{
+  frame[0] = 0;
+  for (uint16_t i = 0; i < EPD_SERVER_FRAME_SIZE; i++) frame[1 + i] = (i % 16 == 3) ? 0xF0 : 0x00;
+  uint32_t refreshes = server.refreshes();
+  sendFrame(EPD_SERVER_FRAME, 10, frame, 1 + EPD_SERVER_FRAME_SIZE);
+  pollAll();
+  expectReply(EPD_SERVER_ACK, 10);
+  expectReply(EPD_SERVER_DONE, 10);
+  expectNoReply();
+  TEST_ASSERT_EQUAL_UINT32(refreshes + 1, server.refreshes());
+  TEST_ASSERT_EQUAL_HEX32(fnv1a(frame + 1, EPD_SERVER_FRAME_SIZE), server.frameHash());
+}
+
+void test_defer_then_refresh()
+{
+  uint32_t refreshes = server.refreshes();
+  uint32_t hash = server.frameHash();
+  const uint8_t data[] = { 0x80, 0xFF };   // 8x3全黑
+  uint16_t len = rectPayload(EPD_SERVER_DEFER | EPD_SERVER_COMPRESSED, 16, 40, 8, 3, data, sizeof(data));
+  sendFrame(EPD_SERVER_RECT, 11, frame, len);
+  pollAll();
+  expectReply(EPD_SERVER_ACK, 11);
+  expectNoReply();
+  TEST_ASSERT_EQUAL_UINT32(refreshes, server.refreshes());
+  TEST_ASSERT_TRUE(hash != server.frameHash());
+
+  uint8_t flags = 0;
+  sendFrame(EPD_SERVER_REFRESH, 12, &flags, 1);
+  pollAll();
+  expectReply(EPD_SERVER_ACK, 12);
+  expectReply(EPD_SERVER_DONE, 12);
+  TEST_ASSERT_EQUAL_UINT32(refreshes + 1, server.refreshes());
+
+  // 主机没收到ACK，以同一seq重发：只重发应答，不重复刷新
+  uint32_t frames = server.frames();
+  sendFrame(EPD_SERVER_REFRESH, 12, &flags, 1);
+  pollAll();
+  expectReply(EPD_SERVER_ACK, 12);
+  expectReply(EPD_SERVER_DONE, 12);
+  expectNoReply();
+  TEST_ASSERT_EQUAL_UINT32(refreshes + 1, server.refreshes());
+  TEST_ASSERT_EQUAL_UINT32(frames, server.frames());
+}
+
+void test_interrupted_frame_times_out()
+{
+  uint32_t errors = server.errors();
+  const uint8_t partial[] = { EPD_SERVER_SYNC, EPD_SERVER_RECT, 13, 20 };
+  port.feed(partial, sizeof(partial));
+  pollAll();
+  expectNoReply();
+  delay(EPD_SERVER_BYTE_TIMEOUT_MS / 2);
+  server.poll();
+  expectNoReply();
+  delay(EPD_SERVER_BYTE_TIMEOUT_MS);
+  server.poll();
+  expectNak(13, EPD_SERVER_ERR_TIMEOUT);
+  TEST_ASSERT_EQUAL_UINT32(errors + 1, server.errors());
+
+  // 之后的帧正常处理
+  sendFrame(EPD_SERVER_HELLO, 14, 0, 0);
+  pollAll();
+  expectReply(EPD_SERVER_INFO, 14);
+}
+
+void test_text_lines_outside_frames()
+{
+  lines = 0;
+  server.setLineHandler(onLine, 0);
+  const char text[] = "energy\r\ntra\x01" "ce\n";   // 不可打印的字节丢弃当前行
+  port.feed((const uint8_t*)text, sizeof(text) - 1);
+  pollAll();
+  TEST_ASSERT_EQUAL_UINT8(2, lines);
+  TEST_ASSERT_EQUAL_STRING("ce", last_line);
+
+  // 文本行与帧交错
+  sendFrame(EPD_SERVER_HELLO, 15, 0, 0);
+  port.feed((const uint8_t*)"trace\n", 6);
+  pollAll();
+  expectReply(EPD_SERVER_INFO, 15);
+  TEST_ASSERT_EQUAL_UINT8(3, lines);
+  TEST_ASSERT_EQUAL_STRING("trace", last_line);
+  server.setLineHandler(0, 0);
+}
+
+void setup()
+{
+  display.init(0);
+  display.setRotation(0);
+  server.begin(port);
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_unpacker_literal_and_repeat);
+  RUN_TEST(test_unpacker_bounds);
+  RUN_TEST(test_hello_returns_info);
+  RUN_TEST(test_bad_crc_is_nak);
+  RUN_TEST(test_oversized_length_is_nak);
+  RUN_TEST(test_unknown_type_is_nak);
+  RUN_TEST(test_rect_outside_screen_is_nak);
+  RUN_TEST(test_bad_compressed_data_leaves_frame);
+  RUN_TEST(test_frame_acks_then_done);
+  RUN_TEST(test_defer_then_refresh);
+  RUN_TEST(test_interrupted_frame_times_out);
+  RUN_TEST(test_text_lines_outside_frames);
+  UNITY_END();
+}
+
+void loop() {}
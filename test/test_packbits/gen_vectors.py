@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# gen_vectors.py
+# 用tools/img2epd.py的编码器生成test_packbits的测试向量（packbits_vectors.h）：
+# 原始数据与_packbits()/compress()的输出，由用例用CbmStream::read解码后比较
+#
+# 用法（编码器改动后重新生成并提交）：
+#   python test/test_packbits/gen_vectors.py
+import os
+import sys
+
+here = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(here, '..', '..', 'tools'))
+import img2epd  # noqa: E402
+
+ROW_BYTES = 16   # 用例按行读取时的行宽
+
+
+def _lcg(n, seed):
+    """确定性的伪随机字节（不依赖random模块的版本）"""
+    out = bytearray()
+    x = seed
+    for _ in range(n):
+        x = (x * 1103515245 + 12345) & 0x7FFFFFFF
+        out.append((x >> 16) & 0xFF)
+    return bytes(out)
+
+
+def _mixed():
+    """字面量、长短重复交替，重复段跨越行边界"""
+    d = bytearray()
+    d += _lcg(5, 1)
+    d += b'\x00' * 3
+    d += b'\x11\x11'            # 两个相同字节不够成段，归入字面量
+    d += b'\xFF' * 40
+    d += _lcg(130, 2)
+    d += b'\x5A' * 131
+    d += _lcg(1, 3)
+    d += b'\x00' * 17
+    return bytes(d)
+
+
+VECTORS = [
+    # (名称, 原始数据)
+    ('run3', b'\xAA' * 3),
+    ('run130', b'\x00' * 130),
+    ('run131', b'\xFF' * 131),
+    ('pair', b'\x01\x01\x02'),
+    ('literal128', bytes(range(128))),
+    ('literal129', bytes(range(129))),
+    ('mixed', _mixed()),
+]
+
+# compress()的完整资源：40x20，每组8行（最后一组4行），用于检查行组偏移表
+BITMAP_W = 40
+BITMAP_H = 20
+BITMAP_GROUP_ROWS = 8
+
+
+def _bitmap():
+    wb = (BITMAP_W + 7) // 8
+    d = bytearray()
+    for y in range(BITMAP_H):
+        if y % 5 == 0:
+            d += b'\xFF' * wb
+        elif y % 5 == 3:
+            d += _lcg(wb, y)
+        else:
+            d += b'\x80' + b'\x00' * (wb - 2) + b'\x01'
+    return bytes(d)
+
+
+def _array(name, data):
+    lines = ['static const uint8_t %s[%d] PROGMEM = {' % (name, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append(''.join('0X%02X,' % b for b in data[i:i + 16]))
+    lines.append('};')
+    return lines
+
+
+def render():
+    lines = [
+        '// packbits_vectors.h',
+        '// 由test/test_packbits/gen_vectors.py用tools/img2epd.py生成，请勿手工修改',
+        '#ifndef PACKBITS_VECTORS_H',
+        '#define PACKBITS_VECTORS_H',
+        '',
+        '#include <Arduino.h>',
+        '',
+        '#define PACKBITS_ROW_BYTES %d' % ROW_BYTES,
+        '',
+    ]
+    for name, raw in VECTORS:
+        lines += _array('%s_raw' % name, raw)
+        lines += _array('%s_packed' % name, img2epd._packbits(raw))
+        lines.append('')
+    lines += [
+        'struct PackbitsVector',
+        '{',
+        '  const char* name;',
+        '  const uint8_t* raw;',
+        '  uint16_t raw_len;',
+        '  const uint8_t* packed;',
+        '  uint16_t packed_len;',
+        '};',
+        '',
+        'static const PackbitsVector packbits_vectors[] = {',
+    ]
+    for name, raw in VECTORS:
+        lines.append('  { "%s", %s_raw, %d, %s_packed, %d },'
+                     % (name, name, len(raw), name, len(img2epd._packbits(raw))))
+    lines += ['};', '']
+
+    bitmap = _bitmap()
+    lines += [
+        '#define BITMAP_WIDTH %d' % BITMAP_W,
+        '#define BITMAP_HEIGHT %d' % BITMAP_H,
+        '#define BITMAP_GROUP_ROWS %d' % BITMAP_GROUP_ROWS,
+    ]
+    lines += _array('bitmap_raw', bitmap)
+    lines += _array('bitmap_asset', img2epd.compress(bitmap, BITMAP_W, BITMAP_H, BITMAP_GROUP_ROWS))
+    lines += ['', '#endif', '']
+    return '\n'.join(lines)
+
+
+def main():
+    path = os.path.join(here, 'packbits_vectors.h')
+    with open(path, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(render())
+    print('wrote %s' % os.path.relpath(path))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
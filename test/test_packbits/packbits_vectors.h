@@ -0,0 +1,176 @@
+// packbits_vectors.h
+// 由test/test_packbits/gen_vectors.py用tools/img2epd.py生成，请勿手工修改
+#ifndef PACKBITS_VECTORS_H
+#define PACKBITS_VECTORS_H
+
+#include <Arduino.h>
+
+#define PACKBITS_ROW_BYTES 16
+
+static const uint8_t run3_raw[3] PROGMEM = {
+0XAA,0XAA,0XAA,
+};
+static const uint8_t run3_packed[2] PROGMEM = {
+0X80,0XAA,
+};
+
+static const uint8_t run130_raw[130] PROGMEM = {
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,
+};
+static const uint8_t run130_packed[2] PROGMEM = {
+0XFF,0X00,
+};
+
+static const uint8_t run131_raw[131] PROGMEM = {
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,
+};
+static const uint8_t run131_packed[4] PROGMEM = {
+0XFF,0XFF,0X00,0XFF,
+};
+
+static const uint8_t pair_raw[3] PROGMEM = {
+0X01,0X01,0X02,
+};
+static const uint8_t pair_packed[4] PROGMEM = {
+0X02,0X01,0X01,0X02,
+};
+
+static const uint8_t literal128_raw[128] PROGMEM = {
+0X00,0X01,0X02,0X03,0X04,0X05,0X06,0X07,0X08,0X09,0X0A,0X0B,0X0C,0X0D,0X0E,0X0F,
+0X10,0X11,0X12,0X13,0X14,0X15,0X16,0X17,0X18,0X19,0X1A,0X1B,0X1C,0X1D,0X1E,0X1F,
+0X20,0X21,0X22,0X23,0X24,0X25,0X26,0X27,0X28,0X29,0X2A,0X2B,0X2C,0X2D,0X2E,0X2F,
+0X30,0X31,0X32,0X33,0X34,0X35,0X36,0X37,0X38,0X39,0X3A,0X3B,0X3C,0X3D,0X3E,0X3F,
+0X40,0X41,0X42,0X43,0X44,0X45,0X46,0X47,0X48,0X49,0X4A,0X4B,0X4C,0X4D,0X4E,0X4F,
+0X50,0X51,0X52,0X53,0X54,0X55,0X56,0X57,0X58,0X59,0X5A,0X5B,0X5C,0X5D,0X5E,0X5F,
+0X60,0X61,0X62,0X63,0X64,0X65,0X66,0X67,0X68,0X69,0X6A,0X6B,0X6C,0X6D,0X6E,0X6F,
+0X70,0X71,0X72,0X73,0X74,0X75,0X76,0X77,0X78,0X79,0X7A,0X7B,0X7C,0X7D,0X7E,0X7F,
+};
+static const uint8_t literal128_packed[129] PROGMEM = {
+0X7F,0X00,0X01,0X02,0X03,0X04,0X05,0X06,0X07,0X08,0X09,0X0A,0X0B,0X0C,0X0D,0X0E,
+0X0F,0X10,0X11,0X12,0X13,0X14,0X15,0X16,0X17,0X18,0X19,0X1A,0X1B,0X1C,0X1D,0X1E,
+0X1F,0X20,0X21,0X22,0X23,0X24,0X25,0X26,0X27,0X28,0X29,0X2A,0X2B,0X2C,0X2D,0X2E,
+0X2F,0X30,0X31,0X32,0X33,0X34,0X35,0X36,0X37,0X38,0X39,0X3A,0X3B,0X3C,0X3D,0X3E,
+0X3F,0X40,0X41,0X42,0X43,0X44,0X45,0X46,0X47,0X48,0X49,0X4A,0X4B,0X4C,0X4D,0X4E,
+0X4F,0X50,0X51,0X52,0X53,0X54,0X55,0X56,0X57,0X58,0X59,0X5A,0X5B,0X5C,0X5D,0X5E,
+0X5F,0X60,0X61,0X62,0X63,0X64,0X65,0X66,0X67,0X68,0X69,0X6A,0X6B,0X6C,0X6D,0X6E,
+0X6F,0X70,0X71,0X72,0X73,0X74,0X75,0X76,0X77,0X78,0X79,0X7A,0X7B,0X7C,0X7D,0X7E,
+0X7F,
+};
+
+static const uint8_t literal129_raw[129] PROGMEM = {
+0X00,0X01,0X02,0X03,0X04,0X05,0X06,0X07,0X08,0X09,0X0A,0X0B,0X0C,0X0D,0X0E,0X0F,
+0X10,0X11,0X12,0X13,0X14,0X15,0X16,0X17,0X18,0X19,0X1A,0X1B,0X1C,0X1D,0X1E,0X1F,
+0X20,0X21,0X22,0X23,0X24,0X25,0X26,0X27,0X28,0X29,0X2A,0X2B,0X2C,0X2D,0X2E,0X2F,
+0X30,0X31,0X32,0X33,0X34,0X35,0X36,0X37,0X38,0X39,0X3A,0X3B,0X3C,0X3D,0X3E,0X3F,
+0X40,0X41,0X42,0X43,0X44,0X45,0X46,0X47,0X48,0X49,0X4A,0X4B,0X4C,0X4D,0X4E,0X4F,
+0X50,0X51,0X52,0X53,0X54,0X55,0X56,0X57,0X58,0X59,0X5A,0X5B,0X5C,0X5D,0X5E,0X5F,
+0X60,0X61,0X62,0X63,0X64,0X65,0X66,0X67,0X68,0X69,0X6A,0X6B,0X6C,0X6D,0X6E,0X6F,
+0X70,0X71,0X72,0X73,0X74,0X75,0X76,0X77,0X78,0X79,0X7A,0X7B,0X7C,0X7D,0X7E,0X7F,
+0X80,
+};
+static const uint8_t literal129_packed[131] PROGMEM = {
+0X7F,0X00,0X01,0X02,0X03,0X04,0X05,0X06,0X07,0X08,0X09,0X0A,0X0B,0X0C,0X0D,0X0E,
+0X0F,0X10,0X11,0X12,0X13,0X14,0X15,0X16,0X17,0X18,0X19,0X1A,0X1B,0X1C,0X1D,0X1E,
+0X1F,0X20,0X21,0X22,0X23,0X24,0X25,0X26,0X27,0X28,0X29,0X2A,0X2B,0X2C,0X2D,0X2E,
+0X2F,0X30,0X31,0X32,0X33,0X34,0X35,0X36,0X37,0X38,0X39,0X3A,0X3B,0X3C,0X3D,0X3E,
+0X3F,0X40,0X41,0X42,0X43,0X44,0X45,0X46,0X47,0X48,0X49,0X4A,0X4B,0X4C,0X4D,0X4E,
+0X4F,0X50,0X51,0X52,0X53,0X54,0X55,0X56,0X57,0X58,0X59,0X5A,0X5B,0X5C,0X5D,0X5E,
+0X5F,0X60,0X61,0X62,0X63,0X64,0X65,0X66,0X67,0X68,0X69,0X6A,0X6B,0X6C,0X6D,0X6E,
+0X6F,0X70,0X71,0X72,0X73,0X74,0X75,0X76,0X77,0X78,0X79,0X7A,0X7B,0X7C,0X7D,0X7E,
+0X7F,0X00,0X80,
+};
+
+static const uint8_t mixed_raw[329] PROGMEM = {
+0XC6,0X7E,0X81,0X6B,0X4B,0X00,0X00,0X00,0X11,0X11,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,0XFF,
+0XFF,0XFF,0X8C,0X21,0XFF,0X72,0XED,0XD7,0X18,0XD9,0X4E,0X13,0X95,0X13,0XDC,0X1B,
+0X63,0XFC,0X93,0X06,0XF6,0XBF,0X9C,0XE5,0X06,0XE0,0X6D,0XB0,0X0A,0X05,0X9F,0XF2,
+0X75,0X87,0X8E,0X34,0XB3,0XBC,0XB3,0X2B,0XE2,0X02,0XC0,0XA1,0X51,0X8C,0X80,0X23,
+0XB9,0XEC,0X6D,0X6F,0X3D,0X64,0X0E,0X9C,0X23,0XEC,0X17,0X07,0X50,0X03,0X3F,0X01,
+0X85,0X36,0XDF,0X3A,0X5C,0X71,0X4F,0XEC,0X00,0X09,0X00,0XC7,0XAF,0X85,0X59,0XA0,
+0XF1,0X30,0X53,0XD8,0X95,0X5F,0XD3,0X8D,0X70,0X82,0XCA,0X83,0XD5,0XED,0X0F,0XD1,
+0XD3,0X64,0XF7,0X4B,0X31,0X68,0XBA,0XB3,0X2B,0X44,0X85,0X9E,0XE9,0XD6,0X5E,0X28,
+0XC3,0X1E,0XBC,0X57,0X37,0X88,0XE2,0X50,0XA6,0XF9,0XFF,0X3C,0XD1,0X9C,0X07,0XF7,
+0X17,0X69,0X4F,0X7F,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,
+0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X5A,0X53,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,0X00,
+};
+static const uint8_t mixed_packed[152] PROGMEM = {
+0X04,0XC6,0X7E,0X81,0X6B,0X4B,0X80,0X00,0X01,0X11,0X11,0XA5,0XFF,0X7F,0X8C,0X21,
+0XFF,0X72,0XED,0XD7,0X18,0XD9,0X4E,0X13,0X95,0X13,0XDC,0X1B,0X63,0XFC,0X93,0X06,
+0XF6,0XBF,0X9C,0XE5,0X06,0XE0,0X6D,0XB0,0X0A,0X05,0X9F,0XF2,0X75,0X87,0X8E,0X34,
+0XB3,0XBC,0XB3,0X2B,0XE2,0X02,0XC0,0XA1,0X51,0X8C,0X80,0X23,0XB9,0XEC,0X6D,0X6F,
+0X3D,0X64,0X0E,0X9C,0X23,0XEC,0X17,0X07,0X50,0X03,0X3F,0X01,0X85,0X36,0XDF,0X3A,
+0X5C,0X71,0X4F,0XEC,0X00,0X09,0X00,0XC7,0XAF,0X85,0X59,0XA0,0XF1,0X30,0X53,0XD8,
+0X95,0X5F,0XD3,0X8D,0X70,0X82,0XCA,0X83,0XD5,0XED,0X0F,0XD1,0XD3,0X64,0XF7,0X4B,
+0X31,0X68,0XBA,0XB3,0X2B,0X44,0X85,0X9E,0XE9,0XD6,0X5E,0X28,0XC3,0X1E,0XBC,0X57,
+0X37,0X88,0XE2,0X50,0XA6,0XF9,0XFF,0X3C,0XD1,0X9C,0X07,0XF7,0X17,0X69,0X01,0X4F,
+0X7F,0XFF,0X5A,0X01,0X5A,0X53,0X8E,0X00,
+};
+
+struct PackbitsVector
+{
+  const char* name;
+  const uint8_t* raw;
+  uint16_t raw_len;
+  const uint8_t* packed;
+  uint16_t packed_len;
+};
+
+static const PackbitsVector packbits_vectors[] = {
+  { "run3", run3_raw, 3, run3_packed, 2 },
+  { "run130", run130_raw, 130, run130_packed, 2 },
+  { "run131", run131_raw, 131, run131_packed, 4 },
+  { "pair", pair_raw, 3, pair_packed, 4 },
+  { "literal128", literal128_raw, 128, literal128_packed, 129 },
+  { "literal129", literal129_raw, 129, literal129_packed, 131 },
+  { "mixed", mixed_raw, 329, mixed_packed, 152 },
+};
+
+#define BITMAP_WIDTH 40
+#define BITMAP_HEIGHT 20
+#define BITMAP_GROUP_ROWS 8
+static const uint8_t bitmap_raw[100] PROGMEM = {
+0XFF,0XFF,0XFF,0XFF,0XFF,0X80,0X00,0X00,0X00,0X01,0X80,0X00,0X00,0X00,0X01,0X53,
+0XC3,0X7D,0X78,0X8E,0X80,0X00,0X00,0X00,0X01,0XFF,0XFF,0XFF,0XFF,0XFF,0X80,0X00,
+0X00,0X00,0X01,0X80,0X00,0X00,0X00,0X01,0X32,0XF0,0XF2,0X99,0XB4,0X80,0X00,0X00,
+0X00,0X01,0XFF,0XFF,0XFF,0XFF,0XFF,0X80,0X00,0X00,0X00,0X01,0X80,0X00,0X00,0X00,
+0X01,0X12,0X1D,0X66,0XB9,0XDB,0X80,0X00,0X00,0X00,0X01,0XFF,0XFF,0XFF,0XFF,0XFF,
+0X80,0X00,0X00,0X00,0X01,0X80,0X00,0X00,0X00,0X01,0XF1,0X4A,0XDB,0XDA,0X01,0X80,
+0X00,0X00,0X00,0X01,
+};
+static const uint8_t bitmap_asset[107] PROGMEM = {
+0X43,0X42,0X28,0X00,0X14,0X00,0X08,0X00,0X00,0X00,0X24,0X00,0X48,0X00,0X82,0XFF,
+0X00,0X80,0X80,0X00,0X01,0X01,0X80,0X80,0X00,0X06,0X01,0X53,0XC3,0X7D,0X78,0X8E,
+0X80,0X80,0X00,0X00,0X01,0X82,0XFF,0X00,0X80,0X80,0X00,0X01,0X01,0X80,0X80,0X00,
+0X00,0X01,0X05,0X32,0XF0,0XF2,0X99,0XB4,0X80,0X80,0X00,0X00,0X01,0X82,0XFF,0X00,
+0X80,0X80,0X00,0X01,0X01,0X80,0X80,0X00,0X06,0X01,0X12,0X1D,0X66,0XB9,0XDB,0X80,
+0X80,0X00,0X00,0X01,0X82,0XFF,0X00,0X80,0X80,0X00,0X01,0X01,0X80,0X80,0X00,0X06,
+0X01,0XF1,0X4A,0XDB,0XDA,0X01,0X80,0X80,0X00,0X00,0X01,
+};
+
+#endif
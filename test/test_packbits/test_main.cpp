@@ -0,0 +1,132 @@
+// test_main.cpp
+// 压缩位图的编解码往返：tools/img2epd.py的_packbits()/compress()编码（packbits_vectors.h），
+// CbmStream::read按不同块大小解码，控制字节跨块、跨行时状态要保持
+// pio test -e native -f test_packbits（编码器改动后先运行gen_vectors.py重新生成向量）
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include "compressed_bitmap.h"
+#include "packbits_vectors.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+static uint8_t decoded[512];
+
+// 每次读chunk字节解码整个向量，结果与原始数据一致且恰好读完编码流
+static void assertRoundTrip(uint16_t chunk)
+{
+  for (size_t i = 0; i < sizeof(packbits_vectors) / sizeof(packbits_vectors[0]); i++)
+  {
+    const PackbitsVector& v = packbits_vectors[i];
+    TEST_ASSERT_TRUE_MESSAGE(v.raw_len <= sizeof(decoded), v.name);
+    memset(decoded, 0xA5, sizeof(decoded));
+    CbmStream s = { v.packed, 0, 0, 0 };
+    for (uint16_t n = 0; n < v.raw_len; n += chunk)
+    {
+      s.read(decoded + n, v.raw_len - n < chunk ? v.raw_len - n : chunk);
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(v.raw, decoded, v.raw_len, v.name);
+    TEST_ASSERT_TRUE_MESSAGE(s.p == v.packed + v.packed_len, v.name);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, s.literal, v.name);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, s.repeat, v.name);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_encoder_limits()
+{
+  // 重复段3~130字节，字面量段最多128字节
+  TEST_ASSERT_EQUAL_UINT8(128, pgm_read_byte(run3_packed));
+  TEST_ASSERT_EQUAL_UINT8(255, pgm_read_byte(run130_packed));
+  TEST_ASSERT_EQUAL_UINT8(255, pgm_read_byte(run131_packed));
+  TEST_ASSERT_EQUAL_UINT8(0, pgm_read_byte(run131_packed + 2));
+  TEST_ASSERT_EQUAL_UINT8(2, pgm_read_byte(pair_packed));
+  TEST_ASSERT_EQUAL_UINT8(127, pgm_read_byte(literal128_packed));
+  TEST_ASSERT_EQUAL_UINT8(0, pgm_read_byte(literal129_packed + 129));
+}
+
+void test_round_trip_whole()
+{
+  assertRoundTrip(sizeof(decoded));
+}
+
+void test_round_trip_bytewise()
+{
+  assertRoundTrip(1);
+}
+
+void test_round_trip_chunks_of_3()
+{
+  assertRoundTrip(3);
+}
+
+void test_round_trip_rows()
+{
+  assertRoundTrip(PACKBITS_ROW_BYTES);
+}
+
+void test_bitmap_size()
+{
+  uint16_t w, h;
+  TEST_ASSERT_TRUE(compressedBitmapSize(bitmap_asset, &w, &h));
+  TEST_ASSERT_EQUAL_UINT16(BITMAP_WIDTH, w);
+  TEST_ASSERT_EQUAL_UINT16(BITMAP_HEIGHT, h);
+  TEST_ASSERT_EQUAL_UINT8(BITMAP_GROUP_ROWS, pgm_read_byte(bitmap_asset + 6));
+  static const uint8_t not_cbm[CBM_HEADER_SIZE] = { 'B', 'M', 40, 0, 20, 0, 8, 0 };
+  TEST_ASSERT_FALSE(compressedBitmapSize(not_cbm, &w, &h));
+}
+
+// 从每个行组的偏移开始逐行解码（drawCompressedBitmap只解码当前页所在的组）
+void test_bitmap_groups_decode_independently()
+{
+  const uint16_t wb = (BITMAP_WIDTH + 7) / 8;
+  const uint16_t groups = (BITMAP_HEIGHT + BITMAP_GROUP_ROWS - 1) / BITMAP_GROUP_ROWS;
+  const uint8_t* data = bitmap_asset + CBM_HEADER_SIZE + 2 * groups;
+  uint8_t row[CBM_MAX_ROW_BYTES];
+  for (uint16_t g = 0; g < groups; g++)
+  {
+    const uint8_t* off = bitmap_asset + CBM_HEADER_SIZE + 2 * g;
+    CbmStream s = { data + (pgm_read_byte(off) | (pgm_read_byte(off + 1) << 8)), 0, 0, 0 };
+    for (uint16_t r = g * BITMAP_GROUP_ROWS; (r < (g + 1) * BITMAP_GROUP_ROWS) && (r < BITMAP_HEIGHT); r++)
+    {
+      s.read(row, wb);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(bitmap_raw + r * wb, row, wb);
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, s.literal);
+    TEST_ASSERT_EQUAL_UINT8(0, s.repeat);
+  }
+}
+
+// 流式绘制的行源从第一组起连续解码整个位图
+void test_bitmap_row_source()
+{
+  const uint16_t wb = (BITMAP_WIDTH + 7) / 8;
+  CompressedBitmapSource src = { bitmap_asset, { 0, 0, 0, 0 } };
+  uint8_t row[CBM_MAX_ROW_BYTES];
+  for (int16_t y = 0; y < BITMAP_HEIGHT + 2; y++)
+  {
+    TEST_ASSERT_TRUE(compressedBitmapRowSource(row, y, &src));
+    if (y < BITMAP_HEIGHT) TEST_ASSERT_EQUAL_UINT8_ARRAY(bitmap_raw + y * wb, row, wb);
+    else TEST_ASSERT_EACH_EQUAL_UINT8(0, row, wb);
+  }
+  TEST_ASSERT_TRUE(src.stream.p == bitmap_asset + sizeof(bitmap_asset));
+}
+
+void setup()
+{
+  display.init(0);
+  UNITY_BEGIN();
+  RUN_TEST(test_encoder_limits);
+  RUN_TEST(test_round_trip_whole);
+  RUN_TEST(test_round_trip_bytewise);
+  RUN_TEST(test_round_trip_chunks_of_3);
+  RUN_TEST(test_round_trip_rows);
+  RUN_TEST(test_bitmap_size);
+  RUN_TEST(test_bitmap_groups_decode_independently);
+  RUN_TEST(test_bitmap_row_source);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,99 @@
+// test_main.cpp
+// 模拟器中的端到端用例：经GxEPD2_290_Ext写入SSD1608模型并刷新，检查局部刷新后屏幕上的画面
+// pio test -e native -f test_sim_frame
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include "ssd1608_model.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+struct Box
+{
+  int16_t x, y, w, h;
+};
+
+static void drawBox(const void* pv)
+{
+  const Box* b = (const Box*)pv;
+  display.fillScreen(GxEPD_WHITE);
+  display.fillRect(b->x, b->y, b->w, b->h, GxEPD_BLACK);
+}
+
+static SimPanel* panel()
+{
+  return SimPanel::at(0);
+}
+
+// 矩形内全黑、外框一圈全白
+static void assertBoxOnScreen(const Box& b)
+{
+  for (int16_t y = b.y - 1; y <= b.y + b.h; y++)
+  {
+    for (int16_t x = b.x - 1; x <= b.x + b.w; x++)
+    {
+      bool inside = (x >= b.x) && (x < b.x + b.w) && (y >= b.y) && (y < b.y + b.h);
+      if (panel()->screenWhite(x, y) == inside)
+      {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "pixel (%d, %d)", x, y);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_update_is_full_refresh()
+{
+  display.setFullWindow();
+  display.firstPage();
+  do
+  {
+    display.fillScreen(GxEPD_WHITE);
+  }
+  while (display.nextPage());
+  TEST_ASSERT_EQUAL_UINT32(1, panel()->fullRefreshes());
+  TEST_ASSERT_EQUAL_UINT32(0, panel()->partialRefreshes());
+  TEST_ASSERT_TRUE(panel()->screenWhite(0, 0));
+  TEST_ASSERT_TRUE(panel()->screenWhite(SimPanel::WIDTH - 1, SimPanel::HEIGHT - 1));
+}
+
+void test_partial_update_draws_box()
+{
+  Box b = { 20, 60, 40, 30 };
+  TEST_ASSERT_TRUE(display.updateDirty(drawBox, &b));
+  TEST_ASSERT_EQUAL_UINT32(1, panel()->fullRefreshes());
+  TEST_ASSERT_EQUAL_UINT32(1, panel()->partialRefreshes());
+  // 刷新窗口按字节对齐扩展后覆盖整个矩形
+  DirtyRect w = display.lastRefreshWindow();
+  TEST_ASSERT_TRUE(w.x <= b.x && w.right() >= b.x + b.w && w.y <= b.y && w.bottom() >= b.y + b.h);
+  assertBoxOnScreen(b);
+}
+
+void test_delta_update_moves_box()
+{
+  // 差分传输只发送变化的行：旧位置擦白、新位置画黑，其余行不重发
+  display.epd2.setDeltaTransfer(true);
+  Box b = { 50, 150, 24, 24 };
+  TEST_ASSERT_TRUE(display.updateDirty(drawBox, &b));
+  TEST_ASSERT_EQUAL_UINT32(2, panel()->partialRefreshes());
+  assertBoxOnScreen(b);
+  TEST_ASSERT_TRUE(panel()->screenWhite(30, 70));   // 上一个矩形的位置
+  TEST_ASSERT_TRUE(panel()->screenWhite(59, 89));
+}
+
+void setup()
+{
+  display.init(0);
+  display.setRotation(0);   // 逻辑坐标即面板物理坐标
+  UNITY_BEGIN();
+  RUN_TEST(test_first_update_is_full_refresh);
+  RUN_TEST(test_partial_update_draws_box);
+  RUN_TEST(test_delta_update_moves_box);
+  UNITY_END();
+}
+
+void loop() {}
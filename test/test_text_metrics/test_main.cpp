@@ -0,0 +1,110 @@
+// test_main.cpp
+// 文本测量缓存（text_metrics.h）：结果与getTextBounds()相同，哈希相同的不同字符串不会互相命中
+// pio test -e native -f test_text_metrics
+#include <Arduino.h>
+#include <unity.h>
+#include "epd_display.h"
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include "text_metrics.h"
+
+DisplayType display(GxEPD2_DRIVER_CLASS(/*CS=*/ 15, /*DC=*/ 27, /*RST=*/ 26, /*BUSY=*/ 25));
+
+static TextMetricsCache cache;
+
+static void assertBounds(const char* text, int16_t x, int16_t y, bool constant = false)
+{
+  int16_t x1, y1, ex1, ey1;
+  uint16_t w, h, ew, eh;
+  display.getTextBounds(text, x, y, &ex1, &ey1, &ew, &eh);
+  cache.textBounds(display, text, x, y, &x1, &y1, &w, &h, constant);
+  TEST_ASSERT_EQUAL_INT16_MESSAGE(ex1, x1, text);
+  TEST_ASSERT_EQUAL_INT16_MESSAGE(ey1, y1, text);
+  TEST_ASSERT_EQUAL_UINT16_MESSAGE(ew, w, text);
+  TEST_ASSERT_EQUAL_UINT16_MESSAGE(eh, h, text);
+}
+
+void setUp()
+{
+  cache.clear();
+  display.setFont(&FreeMonoBold9pt7b);
+  display.setTextSize(1);
+  display.setTextWrap(false);
+}
+
+void tearDown() {}
+
+void test_repeat_hits()
+{
+  uint32_t hits = cache.hits();
+  assertBounds("12:34", 10, 40);
+  assertBounds("12:34", 60, 80);   // 同一字符串换个位置：平移缓存的边界
+  TEST_ASSERT_EQUAL_UINT32(hits + 1, cache.hits());
+}
+
+void test_hash_collision_does_not_hit()
+{
+  // 两个字符串的FNV-1a哈希都是0xD7580E0E，长度相同，落在同一槽
+  char a[] = "xeCCn";
+  char b[] = "xy2aa";
+  int16_t x1, y1;
+  uint16_t w, h;
+  uint32_t hits = cache.hits();
+  cache.textBounds(display, a, 0, 20, &x1, &y1, &w, &h);
+  assertBounds(b, 0, 20);
+  TEST_ASSERT_EQUAL_UINT32(hits, cache.hits());
+}
+
+void test_buffer_reuse_is_not_stale()
+{
+  // 同一个缓冲区内容变化（按内容缓存，不按指针）
+  char buf[8];
+  strcpy(buf, "gg");
+  assertBounds(buf, 5, 30);
+  strcpy(buf, "AA");
+  assertBounds(buf, 5, 30);
+}
+
+void test_long_text_measured_directly()
+{
+  char text[TEXT_METRICS_MAX_LEN + 8];
+  memset(text, 'W', sizeof(text) - 1);
+  text[sizeof(text) - 1] = 0;
+  uint32_t misses = cache.misses();
+  assertBounds(text, 0, 20);
+  assertBounds(text, 0, 20);
+  TEST_ASSERT_EQUAL_UINT32(misses, cache.misses());   // 不缓存，也不占槽
+}
+
+void test_constant_keyed_by_pointer()
+{
+  static const char label[] = "Temp";
+  uint32_t hits = cache.hits();
+  assertBounds(label, 3, 50, true);
+  assertBounds(label, 3, 50, true);
+  TEST_ASSERT_EQUAL_UINT32(hits + 1, cache.hits());
+}
+
+void test_font_and_size_are_part_of_key()
+{
+  assertBounds("Hello", 0, 20);
+  display.setTextSize(2);
+  assertBounds("Hello", 0, 40);
+  display.setFont(0);
+  assertBounds("Hello", 0, 40);
+}
+
+void setup()
+{
+  display.init(0);
+  display.setRotation(1);
+  UNITY_BEGIN();
+  RUN_TEST(test_repeat_hits);
+  RUN_TEST(test_hash_collision_does_not_hit);
+  RUN_TEST(test_buffer_reuse_is_not_stale);
+  RUN_TEST(test_long_text_measured_directly);
+  RUN_TEST(test_constant_keyed_by_pointer);
+  RUN_TEST(test_font_and_size_are_part_of_key);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+# epd_send.py
+# 显示服务的主机端（设备以-DEPD_DISPLAY_SERVER构建，协议见src/epd_server.h）：
+# PNG经img2epd.py的缩放与抖动转换为1bpp帧，与上一次发送的帧比较，只发送变化的矩形（行程编码更短时压缩），
+# 设备把每次的变化区域作为一次局部刷新
+#
+# 用法：
+#   python tools/epd_send.py --port /dev/ttyUSB0 frame.png                    # 发送一帧
+#   python tools/epd_send.py --port /dev/ttyUSB0 --baud 921600 --interval 2 frames/   # 目录中的PNG依次显示
+#   python tools/epd_send.py --port /dev/ttyUSB0 --full frame.png             # 全刷（清除残影）
+#   EPD_SIM_SERIAL=/dev/pts/N EPD_SIM_LOOPS=2000000000 ./sim & python tools/epd_send.py --port /dev/pts/N frame.png  # 主机模拟器
+#
+# 上一次发送的帧缓存在--cache-dir中（按串口名），与设备INFO中的帧哈希一致时才作为差分的基准，否则先发送整帧。
+# 只依赖Python标准库
+import argparse
+import os
+import re
+import select
+import struct
+import sys
+import termios
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from img2epd import ConvertError, decode_png, dither, fit_to_panel, pack, _packbits  # noqa: E402
+
+SYNC = 0xE5
+HELLO, FRAME, RECT, REFRESH = 0x01, 0x02, 0x03, 0x04
+ACK, NAK, INFO, DONE = 0x06, 0x15, 0x81, 0x82
+COMPRESSED, DEFER, FULL = 0x01, 0x02, 0x04
+# 设备的应答都很短：用类型和长度排除调试输出中恰好等于同步字节的字节（UTF-8汉字的首字节常为0xE5）
+REPLY_TYPES = (ACK, NAK, INFO, DONE)
+REPLY_MAX_LEN = 64
+ERRORS = {1: 'CRC', 2: 'TOO_BIG', 3: 'TYPE', 4: 'LENGTH', 5: 'RECT', 6: 'DATA', 7: 'TIMEOUT'}
+SPEEDS = {9600: termios.B9600, 115200: termios.B115200, 230400: termios.B230400,
+          460800: termios.B460800, 921600: termios.B921600}
+
+
+class SendError(Exception):
+    pass
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE"""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def encode(ptype, seq, payload=b''):
+    body = struct.pack('<BBH', ptype, seq, len(payload)) + payload
+    return bytes([SYNC]) + body + struct.pack('<H', crc16(body))
+
+
+def image_payload(data):
+    """返回(flags, 图像数据)：行程编码更短时压缩"""
+    packed = _packbits(data)
+    return (COMPRESSED, bytes(packed)) if len(packed) < len(data) else (0, bytes(data))
+
+
+def diff_rects(old, new, w, h, gap=8):
+    """变化的行按间隔不超过gap行合并成带，每条带取变化字节的列范围，返回[(x, y, w, h)]（x与宽度按8对齐）"""
+    wb = (w + 7) // 8
+    rows = [y for y in range(h) if old[y * wb:(y + 1) * wb] != new[y * wb:(y + 1) * wb]]
+    bands = []
+    for y in rows:
+        if bands and y - bands[-1][1] <= gap:
+            bands[-1][1] = y
+        else:
+            bands.append([y, y])
+    rects = []
+    for y0, y1 in bands:
+        c0, c1 = wb, -1
+        for y in range(y0, y1 + 1):
+            for c in range(wb):
+                if old[y * wb + c] != new[y * wb + c]:
+                    c0, c1 = min(c0, c), max(c1, c)
+        x = c0 * 8
+        rects.append((x, y0, min(w, (c1 + 1) * 8) - x, y1 - y0 + 1))
+    return rects
+
+
+def crop(frame, w, rect):
+    x, y, rw, rh = rect
+    wb, rb = (w + 7) // 8, (rw + 7) // 8
+    return b''.join(frame[(y + r) * wb + x // 8:(y + r) * wb + x // 8 + rb] for r in range(rh))
+
+
+class Link:
+    """串口（或伪终端）上的一问一答：同一时间最多一帧未应答"""
+
+    def __init__(self, port, baud, timeout, retries, verbose):
+        if baud not in SPEEDS:
+            raise SendError('不支持的波特率：%d' % baud)
+        self.fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = attrs[1] = attrs[3] = 0                      # iflag, oflag, lflag：原始模式
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+        attrs[4] = attrs[5] = SPEEDS[baud]
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+        self.baud, self.timeout, self.retries, self.verbose = baud, timeout, retries, verbose
+        self.buf = bytearray()
+        self.replies = []
+        self.seq = 0
+        self.sent = 0
+
+    def close(self):
+        os.close(self.fd)
+
+    def _parse(self):
+        """从接收缓冲区中取出应答，其余字节作为设备的文本输出"""
+        while True:
+            i = self.buf.find(bytes([SYNC]))
+            if i < 0:
+                self._text(len(self.buf))
+                return
+            self._text(i)
+            if len(self.buf) < 5:
+                return
+            ptype, seq, n = struct.unpack('<BBH', self.buf[1:5])
+            if ptype not in REPLY_TYPES or n > REPLY_MAX_LEN:
+                self._text(1)
+                continue
+            if len(self.buf) < 7 + n:
+                return
+            body = bytes(self.buf[1:5 + n])
+            if crc16(body) != struct.unpack('<H', self.buf[5 + n:7 + n])[0]:
+                self._text(1)
+                continue
+            self.replies.append((ptype, seq, body[4:]))
+            del self.buf[:7 + n]
+
+    def _text(self, n):
+        if n and self.verbose:
+            sys.stderr.write(self.buf[:n].decode('utf-8', 'replace'))
+        del self.buf[:n]
+
+    def wait(self, types, seq, timeout):
+        """等待seq的某类应答，返回(类型, 负载)；超时返回None"""
+        deadline = time.time() + timeout
+        while True:
+            for r in self.replies:
+                if r[0] in types and r[1] == seq:
+                    self.replies.remove(r)
+                    return r[0], r[2]
+            left = deadline - time.time()
+            if left <= 0:
+                return None
+            if select.select([self.fd], [], [], left)[0]:
+                self.buf += os.read(self.fd, 4096)
+                self._parse()
+
+    def request(self, ptype, payload, reply=ACK):
+        """发送一帧并等待应答，NAK或超时时以同一seq重发；返回(seq, 应答负载)"""
+        seq = self.seq
+        self.seq = (self.seq + 1) & 0xFF
+        packet = encode(ptype, seq, payload)
+        # 发送时间 + 设备可能正在刷新上一帧
+        timeout = self.timeout + len(packet) * 10.0 / self.baud
+        for _ in range(self.retries + 1):
+            os.write(self.fd, packet)
+            self.sent += len(packet)
+            r = self.wait((reply, NAK), seq, timeout)
+            if r is None:
+                print('seq %d：%g秒内没有应答，重发' % (seq, timeout), file=sys.stderr)
+                continue
+            if r[0] == reply:
+                return seq, r[1]
+            # 校验和错误与传输中断可以重发，其余错误重发也不会通过
+            code = r[1][0] if r[1] else 0
+            if code in (2, 3, 4, 5, 6):
+                raise SendError('seq %d被拒绝：%s' % (seq, ERRORS[code]))
+            print('seq %d：NAK %s，重发' % (seq, ERRORS.get(code, code)), file=sys.stderr)
+        raise SendError('seq %d重发%d次仍失败' % (seq, self.retries))
+
+    def hello(self):
+        _, p = self.request(HELLO, b'', INFO)
+        if len(p) < 14:
+            raise SendError('INFO长度不对：%d' % len(p))
+        version, w, h, rotation, max_payload, rx_buffer, frame_hash = struct.unpack('<BHHBHHI', p[:14])
+        return {'version': version, 'width': w, 'height': h, 'rotation': rotation,
+                'max_payload': max_payload, 'rx_buffer': rx_buffer, 'hash': frame_hash}
+
+
+def load_frame(path, w, h, args):
+    """PNG按img2epd.py的方式转换；.bin为已打包的帧（每行(w + 7) / 8字节）"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if path.lower().endswith('.bin'):
+        if len(data) != (w + 7) // 8 * h:
+            raise ConvertError('%s：%d字节，应为%d' % (path, len(data), (w + 7) // 8 * h))
+        return data
+    iw, ih, gray = decode_png(data)
+    lum = fit_to_panel(iw, ih, gray, w, h, args.fit)
+    return pack(dither(lum, w, h, args.dither, args.threshold), w, h, args.invert)
+
+
+def send_frame(link, info, old, new, full, batch):
+    """发送一帧：没有可信的上一帧或差分更长时发送整帧，否则发送矩形差分；返回(发送方式, 负载字节数)"""
+    w, h = info['width'], info['height']
+    refresh = FULL if full else 0
+    whole = image_payload(new)
+    rects = [] if old is None else diff_rects(old, new, w, h)
+    if old is not None and not rects:
+        if not full:
+            return '无变化', 0
+        seq, _ = link.request(REFRESH, bytes([FULL]))
+        if link.wait((DONE,), seq, link.timeout + 10.0) is None:
+            raise SendError('seq %d：没有等到刷新完成' % seq)
+        return '全刷', 1
+    parts = [(RECT, r, image_payload(crop(new, w, r))) for r in rects]
+    if old is None or sum(9 + len(p[2][1]) for p in parts) >= 1 + len(whole[1]):
+        parts = [(FRAME, None, whole)]
+    last = None
+    total = 0
+    for i, (ptype, rect, (flags, data)) in enumerate(parts):
+        # 默认所有矩形写入帧缓冲后一起刷新（并集窗口），--no-batch时每个矩形各刷新一次
+        defer = batch and i < len(parts) - 1
+        flags |= (DEFER if defer else refresh)
+        payload = bytes([flags]) + (struct.pack('<4H', *rect) if rect else b'') + data
+        seq, _ = link.request(ptype, payload)
+        total += len(payload)
+        if not defer:
+            last = seq
+    if last is not None and link.wait((DONE,), last, link.timeout + 10.0) is None:
+        raise SendError('seq %d：没有等到刷新完成' % last)
+    kind = '整帧' if parts[0][0] == FRAME else '%d个矩形' % len(parts)
+    return kind, total
+
+
+def cache_path(cache_dir, port):
+    return os.path.join(cache_dir, re.sub(r'[^A-Za-z0-9_.-]', '_', port.strip('/')) + '.bin')
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='经串口向显示服务发送帧（整帧、压缩帧或矩形差分）')
+    parser.add_argument('inputs', nargs='+', help='PNG文件、.bin帧或目录')
+    parser.add_argument('--port', required=True, help='串口或伪终端')
+    parser.add_argument('--baud', type=int, default=115200, help='与设备的EPD_SERIAL_BAUD一致')
+    parser.add_argument('--fit', choices=('contain', 'cover', 'stretch'), default='contain')
+    parser.add_argument('--dither', choices=('threshold', 'ordered', 'floyd'), default='floyd')
+    parser.add_argument('--threshold', type=int, default=128)
+    parser.add_argument('--invert', action='store_true', help='反色（1表示白）')
+    parser.add_argument('--full', action='store_true', help='全刷（清除残影）')
+    parser.add_argument('--no-delta', action='store_true', help='总是发送整帧')
+    parser.add_argument('--no-batch', action='store_true', help='每个矩形单独刷新')
+    parser.add_argument('--interval', type=float, default=0.0, help='多个输入之间的间隔（秒）')
+    parser.add_argument('--timeout', type=float, default=5.0, help='等待应答的超时（秒）')
+    parser.add_argument('--retries', type=int, default=3)
+    parser.add_argument('--cache-dir', default=os.path.join(os.path.expanduser('~'), '.cache', 'epd_send'))
+    parser.add_argument('-v', '--verbose', action='store_true', help='显示设备的串口输出')
+    args = parser.parse_args(argv)
+
+    files = []
+    for p in args.inputs:
+        if os.path.isdir(p):
+            files += sorted(os.path.join(p, n) for n in os.listdir(p) if n.lower().endswith(('.png', '.bin')))
+        else:
+            files.append(p)
+
+    link = None
+    try:
+        link = Link(args.port, args.baud, args.timeout, args.retries, args.verbose)
+        info = link.hello()
+        w, h = info['width'], info['height']
+        print('设备：%d x %d，旋转%d，协议版本%d' % (w, h, info['rotation'], info['version']), file=sys.stderr)
+        cache = cache_path(args.cache_dir, args.port)
+        old = None
+        if not args.no_delta:
+            try:
+                with open(cache, 'rb') as f:
+                    old = f.read()
+            except OSError:
+                pass
+            if old is not None and (len(old) != (w + 7) // 8 * h or fnv1a(old) != info['hash']):
+                old = None
+        for i, path in enumerate(files):
+            if i and args.interval:
+                time.sleep(args.interval)
+            new = load_frame(path, w, h, args)
+            start = time.time()
+            kind, size = send_frame(link, info, None if args.no_delta else old, new, args.full, not args.no_batch)
+            print('%s：%s，%d字节，%.2f秒' % (path, kind, size, time.time() - start), file=sys.stderr)
+            old = new
+            os.makedirs(args.cache_dir, exist_ok=True)
+            with open(cache, 'wb') as f:
+                f.write(new)
+        print('共发送%d字节' % link.sent, file=sys.stderr)
+    except (SendError, ConvertError, OSError, termios.error, ValueError) as e:
+        print('epd_send: %s' % e, file=sys.stderr)
+        return 1
+    finally:
+        if link:
+            link.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,283 @@
+# font_subset.py
+# 构建时生成U8g2子集字体：扫描源码中的字符串常量（串口日志除外，以及可选的允许列表文件），
+# 从完整字体（默认u8g2_font_wqy16_t_gb2312b）中只取出用到的字形，生成与U8g2格式兼容的小字体
+#
+# PlatformIO中作为pre脚本运行（见platformio.ini的extra_scripts），生成的font_subset.h
+# 放在构建目录下并加入头文件搜索路径，main.cpp检测到它存在时改用子集字体。
+# 也可以单独运行：
+#   python tools/font_subset.py --font-source <u8g2_fonts.c> --out font_subset.h [--allow font_subset.txt] src
+import argparse
+import glob
+import os
+import re
+import sys
+
+FONT_HEADER_SIZE = 23
+UNICODE_BLOCK_GLYPHS = 32   # 查找表每块的字形数（块越小查找越快，表越大）
+
+# C源码的词法切分：字符串字面量（含转义）、字符字面量与注释一起匹配，先出现的先匹配，
+# 所以注释里的引号和字符串里的//、/*都不会被误认。
+# 另外匹配串口输出的调用（Serial.printf(、out.println(等，out是各模块report/dump的Print&参数）与括号，
+# 这些调用参数里的字符串只输出到串口，不需要字形
+C_TOKEN = re.compile(r'''(?:u8|L|u|U)?"(?P<str>(?:[^"\\\n]|\\.)*)"|'(?:[^'\\\n]|\\.)*'|//[^\n]*|/\*.*?\*/'''
+                     r'''|(?P<log>\b(?:Serial\d?|out)\s*(?:\.|->)\s*print(?:f|ln)?\s*\()|(?P<open>\()|(?P<close>\))''', re.S)
+
+
+def decode_c_string(body):
+    """把C字符串字面量的内容（不含引号）解码为bytes"""
+    out = bytearray()
+    i = 0
+    simple = {'n': 10, 't': 9, 'r': 13, '0': 0, 'a': 7, 'b': 8, 'f': 12, 'v': 11,
+              '\\': 92, '"': 34, "'": 39, '?': 63}
+    raw = body.encode('latin-1') if isinstance(body, str) else body
+    while i < len(raw):
+        c = raw[i]
+        if c != 0x5C:
+            out.append(c)
+            i += 1
+            continue
+        i += 1
+        e = chr(raw[i])
+        if e in '01234567':
+            j = i
+            while j < len(raw) and j < i + 3 and chr(raw[j]) in '01234567':
+                j += 1
+            out.append(int(raw[i:j], 8) & 0xFF)
+            i = j
+        elif e == 'x':
+            j = i + 1
+            while j < len(raw) and chr(raw[j]) in '0123456789abcdefABCDEF':
+                j += 1
+            out.append(int(raw[i + 1:j], 16) & 0xFF)
+            i = j
+        else:
+            out.append(simple.get(e, raw[i]))
+            i += 1
+    return bytes(out)
+
+
+def load_font(source_path, name):
+    """从u8g2_fonts.c中取出名为name的字体数组"""
+    with open(source_path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    m = re.search(r'\b' + re.escape(name) + r'\s*\[[^\]]*\][^=]*=', text)
+    if not m:
+        return None
+    end = text.index(';', m.end())
+    literals = re.findall(r'"((?:[^"\\]|\\.)*)"', text[m.end():end], re.S)
+    return decode_c_string(''.join(literals))
+
+
+def find_font_source(search_dirs, name):
+    for d in search_dirs:
+        for path in glob.glob(os.path.join(d, '**', 'u8g2_fonts.c'), recursive=True):
+            with open(path, 'rb') as f:
+                if name.encode() in f.read():
+                    return path
+    return None
+
+
+def parse_glyphs(font):
+    """返回{encoding: 字形数据（不含编码/长度前缀）}"""
+    glyphs = {}
+    pos = FONT_HEADER_SIZE
+    while font[pos + 1] != 0:           # 8位编码段：编码(1) 长度(1) 数据
+        size = font[pos + 1]
+        glyphs[font[pos]] = font[pos + 2:pos + size]
+        pos += size
+    start_unicode = (font[21] << 8) | font[22]
+    pos = FONT_HEADER_SIZE + start_unicode
+    if pos >= len(font):
+        return glyphs
+    while True:                         # 跳过查找表（最后一项编码为0xFFFF）
+        e = (font[pos + 2] << 8) | font[pos + 3]
+        pos += 4
+        if e == 0xFFFF:
+            break
+    while pos + 1 < len(font):          # 16位编码段：编码(2) 长度(1) 数据
+        e = (font[pos] << 8) | font[pos + 1]
+        if e == 0:
+            break
+        size = font[pos + 2]
+        glyphs[e] = font[pos + 3:pos + size]
+        pos += size
+    return glyphs
+
+
+def build_subset(font, codepoints):
+    """按U8g2字体格式重新打包选中的字形，字体头中的度量信息保持不变"""
+    glyphs = parse_glyphs(font)
+    keep = sorted(cp for cp in set(codepoints) if cp in glyphs)
+
+    ascii_part = bytearray()
+    start_A = start_a = None
+    for cp in (c for c in keep if c < 256):
+        if start_A is None and cp >= ord('A'):
+            start_A = len(ascii_part)
+        if start_a is None and cp >= ord('a'):
+            start_a = len(ascii_part)
+        data = glyphs[cp]
+        ascii_part += bytes([cp, len(data) + 2]) + data
+    end = len(ascii_part)
+    ascii_part += b'\x00\x00'
+    start_A = end if start_A is None else start_A
+    start_a = end if start_a is None else start_a
+
+    wide = [c for c in keep if c >= 256]
+    blocks = [wide[i:i + UNICODE_BLOCK_GLYPHS] for i in range(0, len(wide), UNICODE_BLOCK_GLYPHS)] or [[]]
+    table_size = 4 * len(blocks)
+    glyph_part = bytearray()
+    block_starts = []
+    for block in blocks:
+        block_starts.append(len(glyph_part))
+        for cp in block:
+            data = glyphs[cp]
+            glyph_part += bytes([cp >> 8, cp & 0xFF, len(data) + 3]) + data
+    glyph_part += b'\x00\x00'
+    # 查找表：每项为(相对上一位置的偏移, 块内最大编码)，最后一项编码必须是0xFFFF
+    table = bytearray()
+    pos = 0
+    for i, block in enumerate(blocks):
+        target = table_size + block_starts[i]
+        last = 0xFFFF if i == len(blocks) - 1 else block[-1]
+        table += bytes([(target - pos) >> 8, (target - pos) & 0xFF, last >> 8, last & 0xFF])
+        pos = target
+
+    header = bytearray(font[:FONT_HEADER_SIZE])
+    header[0] = min(len(keep), 255)     # 字形数只有一个字节，U8g2查找字形时不读它（完整字体也远超255个）
+    header[17:19] = bytes([start_A >> 8, start_A & 0xFF])
+    header[19:21] = bytes([start_a >> 8, start_a & 0xFF])
+    header[21:23] = bytes([len(ascii_part) >> 8, len(ascii_part) & 0xFF])
+    missing = sorted(set(codepoints) - set(glyphs))
+    return bytes(header + ascii_part + table + glyph_part), keep, missing
+
+
+def scan_codepoints(paths):
+    """收集源码字符串常量中的全部字符（转义序列解码后按UTF-8计，非UTF-8文件跳过），串口输出调用的参数除外"""
+    cps = set()
+    for path in paths:
+        with open(path, 'rb') as f:
+            raw = f.read()
+        try:
+            text = raw.decode('utf-8')
+        except UnicodeDecodeError:
+            continue
+        calls = []                      # 未闭合的括号，True表示串口输出调用
+        for m in C_TOKEN.finditer(text):
+            if m.group('log') or m.group('open'):
+                calls.append(bool(m.group('log')))
+                continue
+            if m.group('close'):
+                if calls:
+                    calls.pop()
+                continue
+            body = m.group('str')
+            if body is None or any(calls):  # 注释、字符字面量或串口日志
+                continue
+            value = decode_c_string(body.encode('utf-8')).decode('utf-8', 'replace')
+            cps.update(ord(c) for c in value if 0x20 <= ord(c) <= 0xFFFF and c != '\ufffd')
+    return cps
+
+
+def read_allow_list(path):
+    """允许列表：UTF-8文本，#开头的行为注释，其余每个字符都保留（用于运行时数据）"""
+    cps = set()
+    if path and os.path.isfile(path):
+        with open(path, encoding='utf-8') as f:
+            for line in f:
+                if not line.lstrip().startswith('#'):
+                    cps.update(ord(c) for c in line.rstrip('\r\n') if ord(c) >= 0x20)
+    return cps
+
+
+def source_files(dirs):
+    files = []
+    for d in dirs:
+        for ext in ('*.cpp', '*.c', '*.h', '*.hpp', '*.ino'):
+            files += glob.glob(os.path.join(d, '**', ext), recursive=True)
+    return sorted(files)
+
+
+def render_header(name, font_name, data, keep):
+    lines = [
+        '// font_subset.h',
+        '// 由tools/font_subset.py自动生成，请勿手工修改',
+        '// %s的子集：%d个字形，%d字节' % (font_name, len(keep), len(data)),
+        '#ifndef FONT_SUBSET_H',
+        '#define FONT_SUBSET_H',
+        '',
+        '#include <Arduino.h>',
+        '',
+        '#define FONT_SUBSET %s' % name,
+        '#define FONT_SUBSET_GLYPHS %d' % len(keep),
+        '',
+        'static const uint8_t %s[%d] PROGMEM =' % (name, len(data)),
+        '{',
+    ]
+    for i in range(0, len(data), 16):
+        lines.append('  ' + ''.join('0x%02X,' % b for b in data[i:i + 16]))
+    lines += ['};', '', '#endif', '']
+    return '\n'.join(lines)
+
+
+def generate(font_source, font_name, subset_name, scan_dirs, allow_path, out_path, log=print):
+    font = load_font(font_source, font_name)
+    if font is None:
+        log('font_subset: %s中没有找到%s' % (font_source, font_name))
+        return False
+    cps = set(range(0x20, 0x7F))        # 可打印ASCII全部保留（sprintf输出的数字等）
+    cps |= scan_codepoints(source_files(scan_dirs))
+    cps |= read_allow_list(allow_path)
+    data, keep, missing = build_subset(font, cps)
+    header = render_header(subset_name, font_name, data, keep)
+    # 内容不变时不重写文件，避免触发重新编译
+    if os.path.isfile(out_path):
+        with open(out_path, encoding='utf-8') as f:
+            if f.read() == header:
+                return True
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+    with open(out_path, 'w', encoding='utf-8') as f:
+        f.write(header)
+    log('font_subset: %s -> %s，%d个字形，%d字节（原字体%d字节）'
+        % (font_name, subset_name, len(keep), len(data), len(font)))
+    if missing:
+        log('font_subset: 字体中没有以下字符：' + ''.join(chr(c) for c in missing if c >= 0x80))
+    return True
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='生成U8g2子集字体')
+    parser.add_argument('--font-source', required=True, help='包含字体数组的u8g2_fonts.c')
+    parser.add_argument('--font', default='u8g2_font_wqy16_t_gb2312b')
+    parser.add_argument('--name', default='u8g2_font_wqy16_t_subset')
+    parser.add_argument('--allow', help='允许列表文件')
+    parser.add_argument('--out', required=True)
+    parser.add_argument('dirs', nargs='+', help='扫描的源码目录')
+    args = parser.parse_args(argv)
+    ok = generate(args.font_source, args.font, args.name, args.dirs, args.allow, args.out)
+    return 0 if ok else 1
+
+
+try:
+    Import('env')   # noqa: F821  PlatformIO/SCons环境
+except NameError:
+    env = None
+
+if env is not None:
+    project_dir = env.subst('$PROJECT_DIR')
+    font_name = env.GetProjectOption('custom_font_subset_source', 'u8g2_font_wqy16_t_gb2312b')
+    subset_name = env.GetProjectOption('custom_font_subset_name', 'u8g2_font_wqy16_t_subset')
+    allow = os.path.join(project_dir, env.GetProjectOption('custom_font_subset_allow', 'font_subset.txt'))
+    out_dir = os.path.join(env.subst('$BUILD_DIR'), 'generated')
+    out_path = os.path.join(out_dir, 'font_subset.h')
+    source = find_font_source([env.subst('$PROJECT_LIBDEPS_DIR'), os.path.join(project_dir, 'lib')], font_name)
+    ok = source and generate(source, font_name, subset_name, [env.subst('$PROJECT_SRC_DIR')], allow, out_path)
+    if ok:
+        env.Append(CPPPATH=[out_dir])
+    else:
+        # 找不到字体源码时继续使用完整字体
+        if os.path.isfile(out_path):
+            os.remove(out_path)
+        print('font_subset: 未生成子集字体，使用完整的' + font_name)
+elif __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,480 @@
+#!/usr/bin/env python3
+# img2epd.py
+# PNG转电子纸1bpp位图：缩放到屏幕尺寸，阈值/有序抖动/Floyd-Steinberg抖动，
+# 输出头文件（数组长度和宽高都写明，可直接用display.drawBitmap绘制）或裸二进制
+#
+# 用法：
+#   python tools/img2epd.py right_cam_1758802144.png -o src/bitmaps --dither floyd
+#   python tools/img2epd.py input_imgs/ -o build/blobs --format bin --size 296x128 --fit cover -j 8
+#   python tools/img2epd.py input_imgs/ -o src/bitmaps --compress   # 压缩格式，见src/compressed_bitmap.h
+#
+# 只依赖Python标准库。多个文件用进程池并行转换；输入内容和参数都没变的文件直接跳过
+# （记录在输出目录的.img2epd-cache.json中）
+import argparse
+import concurrent.futures
+import hashlib
+import json
+import os
+import re
+import struct
+import sys
+import zlib
+
+CACHE_FILE = '.img2epd-cache.json'
+
+# 8x8 Bayer矩阵（有序抖动）
+BAYER8 = [
+    [0, 32, 8, 40, 2, 34, 10, 42],
+    [48, 16, 56, 24, 50, 18, 58, 26],
+    [12, 44, 4, 36, 14, 46, 6, 38],
+    [60, 28, 52, 20, 62, 30, 54, 22],
+    [3, 35, 11, 43, 1, 33, 9, 41],
+    [51, 19, 59, 27, 49, 17, 57, 25],
+    [15, 47, 7, 39, 13, 45, 5, 37],
+    [63, 31, 55, 23, 61, 29, 53, 21],
+]
+
+
+class ConvertError(Exception):
+    pass
+
+
+# ---------------------------------------------------------------------------
+# PNG解码（灰度/RGB/调色板，带或不带alpha，1~16位，不支持隔行扫描）
+# ---------------------------------------------------------------------------
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def _unfilter(raw, height, stride, bpp):
+    out = bytearray(stride * height)
+    prev = bytearray(stride)
+    pos = 0
+    for y in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        if ftype == 1:
+            for i in range(bpp, stride):
+                line[i] = (line[i] + line[i - bpp]) & 0xFF
+        elif ftype == 2:
+            line = bytearray((a + b) & 0xFF for a, b in zip(line, prev))
+        elif ftype == 3:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + ((left + prev[i]) >> 1)) & 0xFF
+        elif ftype == 4:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                upleft = prev[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + _paeth(left, prev[i], upleft)) & 0xFF
+        elif ftype != 0:
+            raise ConvertError('PNG过滤类型错误：%d' % ftype)
+        out[y * stride:(y + 1) * stride] = line
+        prev = line
+    return out
+
+
+def decode_png(data):
+    """返回(width, height, gray)，gray为按行排列的0~255亮度（透明部分合成到白色背景上）"""
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ConvertError('不是PNG文件')
+    pos = 8
+    idat = bytearray()
+    palette = trns = None
+    while pos < len(data):
+        length, ctype = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if ctype == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif ctype == b'PLTE':
+            palette = body
+        elif ctype == b'tRNS':
+            trns = body
+        elif ctype == b'IDAT':
+            idat += body
+        elif ctype == b'IEND':
+            break
+    if interlace:
+        raise ConvertError('不支持隔行扫描的PNG')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    bits = depth * channels
+    stride = (width * bits + 7) // 8
+    px = _unfilter(zlib.decompress(bytes(idat)), height, stride, max(1, bits // 8))
+
+    gray = bytearray(width * height)
+    for y in range(height):
+        row = px[y * stride:(y + 1) * stride]
+        if depth < 8:
+            per_byte = 8 // depth
+            mask = (1 << depth) - 1
+            samples = [(row[x // per_byte] >> (8 - depth * (x % per_byte + 1))) & mask for x in range(width)]
+            if color == 0:
+                samples = [s * 255 // mask for s in samples]
+        elif depth == 16:
+            samples = row[0::2]   # 取高字节
+        else:
+            samples = row
+        out = y * width
+        if color == 0:
+            gray[out:out + width] = bytes(samples[:width])
+        elif color == 3:
+            for x in range(width):
+                i = samples[x]
+                r, g, b = palette[i * 3:i * 3 + 3]
+                a = trns[i] if trns and i < len(trns) else 255
+                gray[out + x] = _blend((r * 299 + g * 587 + b * 114) // 1000, a)
+        elif color == 4:
+            for x in range(width):
+                gray[out + x] = _blend(samples[x * 2], samples[x * 2 + 1])
+        else:
+            n = channels
+            for x in range(width):
+                r, g, b = samples[x * n], samples[x * n + 1], samples[x * n + 2]
+                a = samples[x * n + 3] if n == 4 else 255
+                gray[out + x] = _blend((r * 299 + g * 587 + b * 114) // 1000, a)
+    return width, height, gray
+
+
+def _blend(lum, alpha):
+    return (lum * alpha + 255 * (255 - alpha)) // 255
+
+
+# ---------------------------------------------------------------------------
+# 缩放（按面积加权平均，可分离的两遍）
+# ---------------------------------------------------------------------------
+
+def _weights(src, dst):
+    """每个目标像素覆盖的源像素区间及权重"""
+    scale = src / dst
+    table = []
+    for i in range(dst):
+        a, b = i * scale, (i + 1) * scale
+        taps = []
+        j = int(a)
+        while j < b and j < src:
+            w = min(b, j + 1) - max(a, j)
+            if w > 0:
+                taps.append((j, w / scale))
+            j += 1
+        table.append(taps)
+    return table
+
+
+def resize(width, height, gray, dst_w, dst_h):
+    wx = _weights(width, dst_w)
+    tmp = [0.0] * (dst_w * height)
+    for y in range(height):
+        row = gray[y * width:(y + 1) * width]
+        base = y * dst_w
+        for x, taps in enumerate(wx):
+            tmp[base + x] = sum(row[j] * w for j, w in taps)
+    wy = _weights(height, dst_h)
+    out = [0.0] * (dst_w * dst_h)
+    for y, taps in enumerate(wy):
+        base = y * dst_w
+        for j, w in taps:
+            src = j * dst_w
+            for x in range(dst_w):
+                out[base + x] += tmp[src + x] * w
+    return out
+
+
+def fit_to_panel(width, height, gray, panel_w, panel_h, fit):
+    """返回panel_w x panel_h的浮点亮度图。contain：等比缩放后居中留白；cover：等比缩放后裁剪；stretch：拉伸"""
+    if fit == 'stretch':
+        return resize(width, height, gray, panel_w, panel_h)
+    if fit == 'cover':
+        scale = max(panel_w / width, panel_h / height)
+        cw, ch = round(panel_w / scale), round(panel_h / scale)
+        x0, y0 = (width - cw) // 2, (height - ch) // 2
+        crop = bytearray()
+        for y in range(y0, y0 + ch):
+            crop += gray[y * width + x0:y * width + x0 + cw]
+        return resize(cw, ch, crop, panel_w, panel_h)
+    scale = min(panel_w / width, panel_h / height)
+    sw, sh = max(1, round(width * scale)), max(1, round(height * scale))
+    small = resize(width, height, gray, sw, sh)
+    out = [255.0] * (panel_w * panel_h)
+    x0, y0 = (panel_w - sw) // 2, (panel_h - sh) // 2
+    for y in range(sh):
+        out[(y0 + y) * panel_w + x0:(y0 + y) * panel_w + x0 + sw] = small[y * sw:(y + 1) * sw]
+    return out
+
+
+# ---------------------------------------------------------------------------
+# 二值化：返回每像素0/1（1=黑）
+# ---------------------------------------------------------------------------
+
+def dither(lum, w, h, method, threshold):
+    black = bytearray(w * h)
+    if method == 'threshold':
+        for i, v in enumerate(lum):
+            black[i] = v < threshold
+    elif method == 'ordered':
+        for y in range(h):
+            brow = BAYER8[y & 7]
+            for x in range(w):
+                t = (brow[x & 7] + 0.5) * 4.0   # 0~255内均匀分布的阈值
+                black[y * w + x] = lum[y * w + x] < t
+    else:
+        # Floyd-Steinberg，蛇形扫描减少方向性纹理
+        err = list(lum)
+        for y in range(h):
+            reverse = y & 1
+            xs = range(w - 1, -1, -1) if reverse else range(w)
+            d = -1 if reverse else 1
+            for x in xs:
+                i = y * w + x
+                old = err[i]
+                new = 0.0 if old < threshold else 255.0
+                black[i] = new == 0.0
+                e = old - new
+                if 0 <= x + d < w:
+                    err[i + d] += e * 7 / 16
+                if y + 1 < h:
+                    j = i + w
+                    if 0 <= x - d < w:
+                        err[j - d] += e * 3 / 16
+                    err[j] += e * 5 / 16
+                    if 0 <= x + d < w:
+                        err[j + d] += e * 1 / 16
+    return black
+
+
+def pack(black, w, h, invert):
+    """按行打包，每行(w+7)/8字节，MSB在左，与Adafruit_GFX::drawBitmap()一致"""
+    wb = (w + 7) // 8
+    out = bytearray(wb * h)
+    for y in range(h):
+        for x in range(w):
+            if bool(black[y * w + x]) != invert:
+                out[y * wb + x // 8] |= 0x80 >> (x & 7)
+    return bytes(out)
+
+
+def _packbits(data):
+    """控制字节c < 128：其后c + 1个字节原样复制；c >= 128：下一个字节重复c - 125次"""
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    while i < len(data):
+        j = i
+        while j < len(data) and j - i < 130 and data[j] == data[i]:
+            j += 1
+        if j - i >= 3:
+            if literal:
+                out += bytes([len(literal) - 1]) + literal
+                literal = bytearray()
+            out += bytes([j - i + 125, data[i]])
+            i = j
+        else:
+            literal.append(data[i])
+            i += 1
+            if len(literal) == 128:
+                out += bytes([127]) + literal
+                literal = bytearray()
+    if literal:
+        out += bytes([len(literal) - 1]) + literal
+    return out
+
+
+def compress(data, w, h, group_rows=8):
+    """压缩位图格式（见src/compressed_bitmap.h）：头 + 行组偏移表 + 按组独立编码的数据"""
+    wb = (w + 7) // 8
+    groups = (h + group_rows - 1) // group_rows
+    body = bytearray()
+    offsets = []
+    for g in range(groups):
+        offsets.append(len(body))
+        body += _packbits(data[g * group_rows * wb:min(h, (g + 1) * group_rows) * wb])
+    if len(body) > 0xFFFF:
+        raise ConvertError('压缩后超过64KB，组偏移放不下')
+    out = bytearray(b'CB') + struct.pack('<HHBB', w, h, group_rows, 0)
+    for off in offsets:
+        out += struct.pack('<H', off)
+    return bytes(out + body)
+
+
+# ---------------------------------------------------------------------------
+# 输出
+# ---------------------------------------------------------------------------
+
+def symbol_name(path):
+    base = os.path.basename(path)
+    name = re.sub(r'[^0-9A-Za-z_]', '_', base)
+    return ('_' + name) if name[0].isdigit() else name
+
+
+def render_compressed_header(name, source, w, h, method, data, raw_size):
+    guard = name.upper() + '_H'
+    lines = [
+        '// %s.h' % name,
+        '// 由tools/img2epd.py从%s生成（%dx%d，%s，压缩%d -> %d字节），请勿手工修改'
+        % (source.replace(os.sep, '/'), w, h, method, raw_size, len(data)),
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+        '#include "compressed_bitmap.h"',
+        '',
+        '#define %s_WIDTH %d' % (name.upper(), w),
+        '#define %s_HEIGHT %d' % (name.upper(), h),
+        'const unsigned char %s[%d] PROGMEM = {' % (name, len(data)),
+    ]
+    for i in range(0, len(data), 16):
+        lines.append(''.join('0X%02X,' % b for b in data[i:i + 16]))
+    lines += [
+        '};',
+        '// 以(x, y)为左上角绘制，只解码当前页覆盖的行',
+        'inline void draw_%s(int16_t x = 0, int16_t y = 0) {' % name,
+        '  drawCompressedBitmap(display, x, y, %s, GxEPD_BLACK);' % name,
+        '}',
+        '',
+        '#endif',
+        '',
+    ]
+    return '\n'.join(lines)
+
+
+def render_header(name, source, w, h, method, data):
+    guard = name.upper() + '_H'
+    lines = [
+        '// %s.h' % name,
+        '// 由tools/img2epd.py从%s生成（%dx%d，%s），请勿手工修改' % (source.replace(os.sep, '/'), w, h, method),
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+        '#include "epd_display.h"',
+        '',
+        '#define %s_WIDTH %d' % (name.upper(), w),
+        '#define %s_HEIGHT %d' % (name.upper(), h),
+        'const unsigned char %s[(%s_WIDTH + 7) / 8 * %s_HEIGHT] PROGMEM = {' % (name, name.upper(), name.upper()),
+    ]
+    for i in range(0, len(data), 16):
+        lines.append(''.join('0X%02X,' % b for b in data[i:i + 16]))
+    lines += [
+        '};',
+        '// 以(x, y)为左上角绘制',
+        'inline void draw_%s(int16_t x = 0, int16_t y = 0) {' % name,
+        '  display.drawBitmap(x, y, %s, %s_WIDTH, %s_HEIGHT, GxEPD_BLACK);' % (name, name.upper(), name.upper()),
+        '}',
+        '',
+        '#endif',
+        '',
+    ]
+    return '\n'.join(lines)
+
+
+def convert(job):
+    """进程池中执行：转换一个文件，返回(输入, 输出, 字节数)"""
+    src, dst, opts = job
+    with open(src, 'rb') as f:
+        w, h, gray = decode_png(f.read())
+    pw, ph = opts['size']
+    lum = fit_to_panel(w, h, gray, pw, ph, opts['fit'])
+    data = pack(dither(lum, pw, ph, opts['dither'], opts['threshold']), pw, ph, opts['invert'])
+    raw_size = len(data)
+    if opts['compress']:
+        data = compress(data, pw, ph)
+    tmp = dst + '.tmp'
+    if opts['format'] == 'bin':
+        with open(tmp, 'wb') as f:
+            f.write(data)
+    elif opts['compress']:
+        with open(tmp, 'w', encoding='utf-8') as f:
+            f.write(render_compressed_header(symbol_name(src), src, pw, ph, opts['dither'], data, raw_size))
+    else:
+        with open(tmp, 'w', encoding='utf-8') as f:
+            f.write(render_header(symbol_name(src), src, pw, ph, opts['dither'], data))
+    os.replace(tmp, dst)
+    return src, dst, len(data)
+
+
+def collect_inputs(paths):
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            files += sorted(os.path.join(p, n) for n in os.listdir(p) if n.lower().endswith('.png'))
+        else:
+            files.append(p)
+    return files
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='PNG转电子纸1bpp位图')
+    parser.add_argument('inputs', nargs='+', help='PNG文件或目录')
+    parser.add_argument('-o', '--out-dir', default='.', help='输出目录')
+    parser.add_argument('--format', choices=('header', 'bin'), default='header')
+    parser.add_argument('--size', default='296x128', help='屏幕尺寸（旋转后），默认296x128')
+    parser.add_argument('--fit', choices=('contain', 'cover', 'stretch'), default='contain')
+    parser.add_argument('--dither', choices=('threshold', 'ordered', 'floyd'), default='floyd')
+    parser.add_argument('--threshold', type=int, default=128)
+    parser.add_argument('--invert', action='store_true', help='反色（1表示白）')
+    parser.add_argument('--compress', action='store_true', help='输出压缩位图（drawCompressedBitmap绘制）')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1)
+    parser.add_argument('-f', '--force', action='store_true', help='忽略缓存，全部重新转换')
+    args = parser.parse_args(argv)
+
+    m = re.match(r'^(\d+)x(\d+)$', args.size)
+    if not m:
+        parser.error('--size格式应为WxH')
+    opts = {
+        'size': (int(m.group(1)), int(m.group(2))),
+        'fit': args.fit,
+        'dither': args.dither,
+        'threshold': args.threshold,
+        'invert': args.invert,
+        'format': args.format,
+        'compress': args.compress,
+    }
+    os.makedirs(args.out_dir, exist_ok=True)
+    cache_path = os.path.join(args.out_dir, CACHE_FILE)
+    try:
+        with open(cache_path, encoding='utf-8') as f:
+            cache = json.load(f)
+    except (OSError, ValueError):
+        cache = {}
+
+    # 输入内容和转换参数的哈希作为缓存键，只转换有变化的文件
+    opts_key = json.dumps(opts, sort_keys=True)
+    jobs, keys = [], {}
+    for src in collect_inputs(args.inputs):
+        ext = ('.cbm' if args.compress else '.bin') if args.format == 'bin' else '.h'
+        dst = os.path.join(args.out_dir, symbol_name(src) + ext)
+        with open(src, 'rb') as f:
+            key = hashlib.sha1(f.read() + opts_key.encode()).hexdigest()
+        if not args.force and cache.get(dst) == key and os.path.isfile(dst):
+            print('跳过（未变化）：%s' % src)
+            continue
+        jobs.append((src, dst, opts))
+        keys[dst] = key
+
+    failed = 0
+    if jobs:
+        workers = max(1, min(args.jobs, len(jobs)))
+        with concurrent.futures.ProcessPoolExecutor(max_workers=workers) as pool:
+            futures = {pool.submit(convert, job): job for job in jobs}
+            for fut in concurrent.futures.as_completed(futures):
+                src, dst, _ = futures[fut]
+                try:
+                    _, _, size = fut.result()
+                except (ConvertError, OSError, zlib.error, KeyError, ValueError) as e:
+                    print('转换失败：%s：%s' % (src, e), file=sys.stderr)
+                    cache.pop(dst, None)
+                    failed += 1
+                    continue
+                cache[dst] = keys[dst]
+                print('%s -> %s（%d字节）' % (src, dst, size))
+        with open(cache_path, 'w', encoding='utf-8') as f:
+            json.dump(cache, f, indent=1, sort_keys=True)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+# trace2chrome.py
+# 事件跟踪导出（串口输入trace，格式见src/epd_trace.h）转换为Chrome/Perfetto的trace JSON，
+# 在chrome://tracing或https://ui.perfetto.dev中打开，按核分线程显示更新、页、SPI写入、BUSY等待等
+#
+# 用法：
+#   python tools/trace2chrome.py monitor.log -o trace.json        # 从串口日志中取最后一次导出
+#   pio device monitor | tee monitor.log                            # （日志的一种来源）
+#   python tools/trace2chrome.py --port /dev/ttyUSB0 -o trace.json  # 直接发送trace命令并读取
+#   EPD_SIM_SERIAL=/dev/pts/N ./sim & python tools/trace2chrome.py --port /dev/pts/N -o trace.json  # 主机模拟器
+#
+# 只依赖Python标准库
+import argparse
+import json
+import os
+import select
+import sys
+import termios
+import time
+
+# 各类型的参数名（a, b, c, d），与EpdTraceKind的注释一致
+ARG_NAMES = {
+    'update': (),
+    'page': ('page',),
+    'spi': ('row', 'rows', 'bytes'),
+    'busy': ('mode',),
+    'glyph': ('encoding',),
+    'blit': ('x', 'y', 'w', 'h'),
+    'window': ('x', 'y', 'w', 'h'),
+    'text': ('x', 'y', 'w', 'h'),
+}
+BUSY_MODES = ('partial', 'full', 'power_off', 'hibernate')
+
+
+class TraceError(Exception):
+    pass
+
+
+def parse_dumps(lines):
+    """取出所有完整的导出，每个为(CPU MHz, 被覆盖的事件数, 事件列表)"""
+    dumps, current = [], None
+    for line in lines:
+        line = line.strip()
+        if not line.startswith('trace,'):
+            continue
+        f = line.split(',')
+        if f[1] == 'begin' and len(f) >= 5:
+            current = (int(f[2]), int(f[4]), [])
+        elif f[1] == 'end':
+            if current is not None:
+                dumps.append(current)
+            current = None
+        elif current is not None and len(f) == 9 and f[1].isdigit():
+            current[2].append((int(f[1]), int(f[2]), f[3], f[4], [int(v) for v in f[5:]]))
+    return dumps
+
+
+def event_args(kind, values):
+    names = ARG_NAMES.get(kind, ('a', 'b', 'c', 'd'))
+    args = dict(zip(names, values))
+    if kind == 'busy' and 0 <= args.get('mode', -1) < len(BUSY_MODES):
+        args['mode'] = BUSY_MODES[args['mode']]
+    if kind == 'glyph':
+        args['encoding'] = 'U+%04X' % (args['encoding'] & 0xFFFF)
+    return args
+
+
+def convert(dump):
+    mhz, overwritten, events = dump
+    if mhz <= 0:
+        raise TraceError('CPU频率无效：%d' % mhz)
+    # 32位周期计数按核展开：相邻两个事件的间隔小于一个回绕周期
+    last, ext = {}, []
+    for cycles, core, kind, ph, values in events:
+        if core in last:
+            prev_raw, prev_ext = last[core]
+            t = prev_ext + ((cycles - prev_raw) & 0xFFFFFFFF)
+        else:
+            t = cycles
+        last[core] = (cycles, t)
+        ext.append(t)
+    base = min(ext) if ext else 0
+
+    out = [{'name': 'process_name', 'ph': 'M', 'pid': 1, 'args': {'name': 'epaper'}}]
+    for core in sorted(last):
+        out.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': core, 'args': {'name': 'core %d' % core}})
+    # 缓冲区覆盖掉了开头的begin时，对应的end不输出
+    depth = {}
+    for (cycles, core, kind, ph, values), t in zip(events, ext):
+        if ph == 'E':
+            if not depth.get(core):
+                continue
+            depth[core] -= 1
+        elif ph == 'B':
+            depth[core] = depth.get(core, 0) + 1
+        e = {'name': kind, 'cat': 'epd', 'ph': ph, 'ts': (t - base) / mhz, 'pid': 1, 'tid': core}
+        if ph == 'i':
+            e['s'] = 't'
+        if ph != 'E' or kind in ('page', 'glyph'):
+            e['args'] = event_args(kind, values)
+        out.append(e)
+    return {'traceEvents': out, 'displayTimeUnit': 'ms',
+            'otherData': {'cpu_mhz': mhz, 'overwritten_events': overwritten}}
+
+
+def read_port(port, baud, timeout):
+    """向串口（或模拟器的伪终端）发送trace命令，读到trace,end为止"""
+    speeds = {9600: termios.B9600, 115200: termios.B115200, 230400: termios.B230400,
+              460800: termios.B460800, 921600: termios.B921600}
+    if baud not in speeds:
+        raise TraceError('不支持的波特率：%d' % baud)
+    fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+    try:
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = attrs[1] = attrs[3] = 0                      # iflag, oflag, lflag：原始模式
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+        attrs[4] = attrs[5] = speeds[baud]
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        termios.tcflush(fd, termios.TCIFLUSH)
+        os.write(fd, b'trace\n')
+        data, deadline = b'', time.time() + timeout
+        while b'trace,end' not in data:
+            left = deadline - time.time()
+            if left <= 0:
+                raise TraceError('%s：%g秒内没有读到完整的导出' % (port, timeout))
+            if select.select([fd], [], [], left)[0]:
+                data += os.read(fd, 4096)
+        return data.decode('utf-8', 'replace').splitlines()
+    finally:
+        os.close(fd)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='事件跟踪导出转换为Chrome/Perfetto trace JSON')
+    parser.add_argument('log', nargs='?', help='包含trace导出的串口日志（默认标准输入）')
+    parser.add_argument('-o', '--out', help='输出文件（默认标准输出）')
+    parser.add_argument('--port', help='直接从串口读取（发送trace命令）')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--timeout', type=float, default=10.0, help='串口读取超时（秒）')
+    parser.add_argument('--index', type=int, default=-1, help='日志中有多次导出时取第几次（默认最后一次）')
+    args = parser.parse_args(argv)
+
+    try:
+        if args.port:
+            lines = read_port(args.port, args.baud, args.timeout)
+        elif args.log:
+            with open(args.log, encoding='utf-8', errors='replace') as f:
+                lines = f.readlines()
+        else:
+            lines = sys.stdin.readlines()
+        dumps = parse_dumps(lines)
+        if not dumps:
+            raise TraceError('输入中没有完整的trace导出（trace,begin ... trace,end）')
+        trace = convert(dumps[args.index])
+    except (TraceError, OSError, IndexError, termios.error) as e:
+        print('trace2chrome: %s' % e, file=sys.stderr)
+        return 1
+
+    text = json.dumps(trace, ensure_ascii=False)
+    if args.out:
+        with open(args.out, 'w', encoding='utf-8') as f:
+            f.write(text)
+        print('%d个事件 -> %s' % (len(trace['traceEvents']), args.out), file=sys.stderr)
+    else:
+        print(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))